@@ -0,0 +1,358 @@
+//
+//  yosemite_wallet_jni.c
+//  YosWalletTest
+//
+//  JNI binding of the native core for com.yosemitex.yosemitewallet.YosEcNative.
+//
+//  All byte arguments are direct ByteBuffers.  The native side reads and
+//  writes them in place starting at index 0 (the buffer position is ignored),
+//  so no Java array is copied on the way in or out.
+//
+
+#include <jni.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "base58.h"
+#include "ecdsa.h"
+#include "memzero.h"
+#include "secmem.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "sha2.h"
+#include "trx_digest.h"
+
+#define MAX_ADDR_SIZE 130
+
+// Longest data encodeBase58Check accepts.  With its 4 checksum bytes it
+// encodes to at most 93 * 138 / 100 + 1 = 129 characters, which leaves
+// room for the terminator in MAX_ADDR_SIZE.  The bound also keeps the
+// stack buffers of b58encWithChecksum and b58enc small.
+#define MAX_BASE58_CHECK_DATA 89
+// longest checksum suffix, key types are two characters
+#define MAX_BASE58_CHECK_SUFFIX 8
+
+// curve ids, see YosEcNative.CURVE_*
+#define CURVE_R1 0
+#define CURVE_K1 1
+
+// header of a compact signature is 27 + 4 (compressed key) + recovery id
+#define COMPACT_HEADER 31
+
+// longest private key string decodePrivateKey accepts, PVT_XX_ and the
+// base58 of 36 bytes are 7 + 50 characters
+#define MAX_PRIVATE_KEY_STRING 64
+// version byte of a WIF private key
+#define WIF_VERSION 0x80
+
+// locked slots handed out by allocateSecret, one page of them
+#define SECRET_SIZE  64
+#define SECRET_SLOTS 64
+
+static secmem_arena *secret_arena;
+static pthread_once_t secret_arena_once = PTHREAD_ONCE_INIT;
+
+static uint8_t *direct_buffer(JNIEnv *env, jobject buffer, jlong min_capacity)
+{
+  uint8_t *address;
+  
+  if (buffer == NULL) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/NullPointerException"), "buffer is null");
+    return NULL;
+  }
+  address = (*env)->GetDirectBufferAddress(env, buffer);
+  if (address == NULL) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), "buffer is not direct");
+    return NULL;
+  }
+  if ((*env)->GetDirectBufferCapacity(env, buffer) < min_capacity) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), "buffer is too small");
+    return NULL;
+  }
+  return address;
+}
+
+static const ecdsa_curve *curve_by_id(JNIEnv *env, jint curve)
+{
+  switch (curve) {
+    case CURVE_R1:
+      return &secp256r1;
+    case CURVE_K1:
+      return &secp256k1;
+  }
+  (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), "unknown curve");
+  return NULL;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_recoverPublicKey(JNIEnv *env, jclass clazz, jint curve, jobject sig, jobject digest, jint recId, jobject pubKey)
+{
+  const ecdsa_curve *ec;
+  const uint8_t *sig_bytes, *digest_bytes;
+  uint8_t *pub_key_bytes;
+  
+  if (!(ec = curve_by_id(env, curve)) ||
+      !(sig_bytes = direct_buffer(env, sig, 64)) ||
+      !(digest_bytes = direct_buffer(env, digest, 32)) ||
+      !(pub_key_bytes = direct_buffer(env, pubKey, 65))) {
+    return -1;
+  }
+  return ecdsa_recover_pub_from_sig(ec, pub_key_bytes, sig_bytes, digest_bytes, recId);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_compressPublicKey(JNIEnv *env, jclass clazz, jobject pubKey, jobject compressed)
+{
+  const uint8_t *pub_key_bytes;
+  uint8_t *compressed_bytes;
+  
+  if (!(pub_key_bytes = direct_buffer(env, pubKey, 65)) ||
+      !(compressed_bytes = direct_buffer(env, compressed, 33))) {
+    return -1;
+  }
+  return ecdsa_compress_pubkey(pub_key_bytes, compressed_bytes);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_uncompressPublicKey(JNIEnv *env, jclass clazz, jint curve, jobject pubKey, jobject uncompressed)
+{
+  const ecdsa_curve *ec;
+  const uint8_t *pub_key_bytes;
+  uint8_t *uncompressed_bytes;
+  
+  if (!(ec = curve_by_id(env, curve)) ||
+      !(pub_key_bytes = direct_buffer(env, pubKey, 33)) ||
+      !(uncompressed_bytes = direct_buffer(env, uncompressed, 65))) {
+    return -1;
+  }
+  return ecdsa_uncompress_pubkey(ec, pub_key_bytes, uncompressed_bytes);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_derToSignature(JNIEnv *env, jclass clazz, jobject der, jobject sig)
+{
+  const uint8_t *der_bytes;
+  uint8_t *sig_bytes;
+  
+  // shortest DER encoding the parser accepts is 30 len 02 01 r 02 01 s
+  if (!(der_bytes = direct_buffer(env, der, 8)) ||
+      !(sig_bytes = direct_buffer(env, sig, 64))) {
+    return -1;
+  }
+  if ((*env)->GetDirectBufferCapacity(env, der) < 2 + der_bytes[1]) {
+    return -1;
+  }
+  return ecdsa_der_to_sig(der_bytes, sig_bytes);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_signatureToCompact(JNIEnv *env, jclass clazz, jint curve, jobject sig, jobject digest, jobject pubKey, jobject compactSig)
+{
+  const ecdsa_curve *ec;
+  const uint8_t *sig_bytes, *digest_bytes, *pub_key_bytes;
+  uint8_t *compact_sig_bytes;
+  
+  if (!(ec = curve_by_id(env, curve)) ||
+      !(sig_bytes = direct_buffer(env, sig, 64)) ||
+      !(digest_bytes = direct_buffer(env, digest, 32)) ||
+      !(pub_key_bytes = direct_buffer(env, pubKey, 65)) ||
+      !(compact_sig_bytes = direct_buffer(env, compactSig, 65))) {
+    return -1;
+  }
+  return ecdsa_sig_to_compact(ec, sig_bytes, digest_bytes, pub_key_bytes, compact_sig_bytes);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_verifySignature(JNIEnv *env, jclass clazz, jint curve, jobject pubKey, jobject sig, jobject digest)
+{
+  const ecdsa_curve *ec;
+  const uint8_t *pub_key_bytes, *sig_bytes, *digest_bytes;
+  
+  if (!(ec = curve_by_id(env, curve)) ||
+      !(pub_key_bytes = direct_buffer(env, pubKey, 33)) ||
+      !(sig_bytes = direct_buffer(env, sig, 64)) ||
+      !(digest_bytes = direct_buffer(env, digest, 32))) {
+    return -1;
+  }
+  if (pub_key_bytes[0] == 0x04 && (*env)->GetDirectBufferCapacity(env, pubKey) < 65) {
+    return -1;
+  }
+  return ecdsa_verify_digest(ec, pub_key_bytes, sig_bytes, digest_bytes);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_transactionDigest(JNIEnv *env, jclass clazz, jobject chainId, jobject packedTrx, jint trxLength, jobject packedCfd, jint cfdLength, jobject digest)
+{
+  const uint8_t *chain_id_bytes, *trx_bytes, *cfd_bytes = NULL;
+  uint8_t *digest_bytes;
+  
+  if (trxLength < 0 || cfdLength < 0 ||
+      !(chain_id_bytes = direct_buffer(env, chainId, 32)) ||
+      !(trx_bytes = direct_buffer(env, packedTrx, trxLength)) ||
+      (cfdLength > 0 && !(cfd_bytes = direct_buffer(env, packedCfd, cfdLength))) ||
+      !(digest_bytes = direct_buffer(env, digest, SHA256_DIGEST_LENGTH))) {
+    return -1;
+  }
+  trx_digest(chain_id_bytes, trx_bytes, (size_t)trxLength, cfd_bytes, (size_t)cfdLength, digest_bytes);
+  return 0;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_encodeBase58Check(JNIEnv *env, jclass clazz, jobject data, jint length, jstring suffix)
+{
+  const uint8_t *data_bytes;
+  const char *suffix_chars = NULL;
+  char addr[MAX_ADDR_SIZE];
+  size_t res = sizeof(addr);
+  bool encoded;
+  
+  if (length < 0 || length > MAX_BASE58_CHECK_DATA) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), "data is too long");
+    return NULL;
+  }
+  if (suffix != NULL && (*env)->GetStringUTFLength(env, suffix) > MAX_BASE58_CHECK_SUFFIX) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), "suffix is too long");
+    return NULL;
+  }
+  if (!(data_bytes = direct_buffer(env, data, length))) {
+    return NULL;
+  }
+  if (suffix != NULL) {
+    suffix_chars = (*env)->GetStringUTFChars(env, suffix, NULL);
+    if (suffix_chars == NULL) {
+      return NULL;
+    }
+  }
+  
+  encoded = b58encWithChecksum(addr, &res, data_bytes, (size_t)length, suffix_chars);
+  
+  if (suffix_chars != NULL) {
+    (*env)->ReleaseStringUTFChars(env, suffix, suffix_chars);
+  }
+  return encoded ? (*env)->NewStringUTF(env, addr) : NULL;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_sha256(JNIEnv *env, jclass clazz, jobject data, jint length, jobject digest)
+{
+  const uint8_t *data_bytes;
+  uint8_t *digest_bytes;
+  
+  if (length < 0 ||
+      !(data_bytes = direct_buffer(env, data, length)) ||
+      !(digest_bytes = direct_buffer(env, digest, SHA256_DIGEST_LENGTH))) {
+    return -1;
+  }
+  sha256_Raw(data_bytes, (size_t)length, digest_bytes);
+  return 0;
+}
+
+static void secret_arena_init(void)
+{
+  secret_arena = secmem_arena_new(SECRET_SIZE, SECRET_SLOTS);
+}
+
+// Slots are never returned: they back the keys of signers that live as
+// long as the plugin.
+JNIEXPORT jobject JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_allocateSecret(JNIEnv *env, jclass clazz, jint capacity)
+{
+  void *slot;
+  
+  if (capacity <= 0 || capacity > SECRET_SIZE) {
+    return NULL;
+  }
+  pthread_once(&secret_arena_once, secret_arena_init);
+  if (secret_arena == NULL || !(slot = secmem_alloc(secret_arena))) {
+    return NULL;
+  }
+  return (*env)->NewDirectByteBuffer(env, slot, capacity);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_decodePrivateKey(JNIEnv *env, jclass clazz, jstring key, jobject privateKey)
+{
+  uint8_t *private_key_bytes;
+  char chars[MAX_PRIVATE_KEY_STRING + 1];
+  uint8_t wif[1 + 32 + 4], hash[SHA256_DIGEST_LENGTH];
+  size_t size = sizeof(wif);
+  jsize length;
+  jint curve = -1;
+  
+  if (key == NULL) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/NullPointerException"), "key is null");
+    return -1;
+  }
+  if (!(private_key_bytes = direct_buffer(env, privateKey, 32))) {
+    return -1;
+  }
+  length = (*env)->GetStringUTFLength(env, key);
+  if (length > MAX_PRIVATE_KEY_STRING) {
+    return -1;
+  }
+  (*env)->GetStringUTFRegion(env, key, 0, (*env)->GetStringLength(env, key), chars);
+  chars[length] = '\0';
+  
+  if (strncmp(chars, "PVT_R1_", 7) == 0) {
+    if (b58decWithChecksum(private_key_bytes, 32, chars + 7, 0, "R1")) {
+      curve = CURVE_R1;
+    }
+  } else if (strncmp(chars, "PVT_K1_", 7) == 0) {
+    if (b58decWithChecksum(private_key_bytes, 32, chars + 7, 0, "K1")) {
+      curve = CURVE_K1;
+    }
+  } else if (b58tobin(wif, &size, chars, 0) && size == sizeof(wif) && wif[0] == WIF_VERSION) {
+    // legacy WIF keys are K1 with a double sha256 checksum
+    sha256_Raw(wif, 1 + 32, hash);
+    sha256_Raw(hash, sizeof(hash), hash);
+    if (memcmp(hash, wif + 1 + 32, 4) == 0) {
+      memcpy(private_key_bytes, wif + 1, 32);
+      curve = CURVE_K1;
+    }
+  }
+  
+  memzero(chars, sizeof(chars));
+  memzero(wif, sizeof(wif));
+  memzero(hash, sizeof(hash));
+  return curve;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_yosemitex_yosemitewallet_YosEcNative_signDigests(JNIEnv *env, jclass clazz, jint curve, jobject privateKey, jobject digests, jint count, jobject compactSigs, jboolean canonical)
+{
+  const ecdsa_curve *ec;
+  const uint8_t *private_key_bytes, *digest_bytes;
+  uint8_t *sig_bytes;
+  int *recids;
+  jint i, failed;
+  
+  if (count < 0 ||
+      !(ec = curve_by_id(env, curve)) ||
+      !(private_key_bytes = direct_buffer(env, privateKey, 32)) ||
+      !(digest_bytes = direct_buffer(env, digests, 32 * (jlong)count)) ||
+      !(sig_bytes = direct_buffer(env, compactSigs, 65 * (jlong)count))) {
+    return -1;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  if (!(recids = malloc(sizeof(int) * (size_t)count))) {
+    (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/OutOfMemoryError"), "recovery ids");
+    return -1;
+  }
+  
+  // sign r | s into the last 64 * count bytes, then spread them forward
+  // into 65 byte slots behind their headers.  Slot i ends at 65 * (i + 1),
+  // which is not past the start of r | s number i + 1, so every move
+  // only overwrites signatures that were already moved.
+  failed = ecdsa_sign_batch_key(ec, private_key_bytes, digest_bytes, (size_t)count,
+                                sig_bytes + count, recids,
+                                canonical && curve == CURVE_K1 ? ecdsa_sig_is_canonical : NULL);
+  for (i = 0; i < count; i++) {
+    memmove(sig_bytes + 65 * i + 1, sig_bytes + count + 64 * i, 64);
+    sig_bytes[65 * i] = recids[i] < 0 ? 0 : (uint8_t)(COMPACT_HEADER + recids[i]);
+  }
+  
+  free(recids);
+  return failed;
+}
@@ -0,0 +1,129 @@
+package com.yosemitex.yosemitewallet;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Thin binding of the native secp256r1/secp256k1 core shared with the iOS plugin.
+ *
+ * Every buffer must be a direct {@link ByteBuffer} (see {@link #allocate(int)}).
+ * The native side reads and writes the buffers in place from index 0 and ignores
+ * their position and limit, so callers can keep and reuse buffers across calls
+ * without any array copies.
+ *
+ * Methods taking a curve expect one of {@link #CURVE_R1} or {@link #CURVE_K1}.
+ *
+ * Methods returning int follow the native convention: 0 on success, non-zero on failure,
+ * unless documented otherwise.
+ */
+public final class YosEcNative {
+
+    public static final int SIGNATURE_SIZE = 64;
+    public static final int COMPACT_SIGNATURE_SIZE = 65;
+    public static final int DIGEST_SIZE = 32;
+    public static final int PUBLIC_KEY_SIZE = 65;
+    public static final int COMPRESSED_PUBLIC_KEY_SIZE = 33;
+    public static final int PRIVATE_KEY_SIZE = 32;
+
+    public static final int CURVE_R1 = 0;
+    public static final int CURVE_K1 = 1;
+
+    /**
+     * Longest data {@link #encodeBase58Check} accepts, enough for a 65 byte compact
+     * signature or a 33 byte public key.
+     */
+    public static final int BASE58_CHECK_MAX_DATA = 89;
+
+    public static final String KEY_TYPE_R1 = "R1";
+    public static final String KEY_TYPE_K1 = "K1";
+
+    static {
+        System.loadLibrary("yosemite_wallet_jni");
+    }
+
+    private YosEcNative() {
+    }
+
+    public static ByteBuffer allocate(int capacity) {
+        return ByteBuffer.allocateDirect(capacity);
+    }
+
+    /**
+     * Returns a direct buffer of up to 64 bytes in memory that is locked, kept out of
+     * core dumps and guarded (see secmem.h), or null if capacity is larger or no such
+     * memory is left.  The memory is never released, so it suits secrets that live as
+     * long as the process, such as the key of the wallet signer; zero it when the
+     * secret is no longer needed.
+     */
+    public static native ByteBuffer allocateSecret(int capacity);
+
+    /**
+     * Recovers the 65 byte uncompressed public key from a 64 byte r|s signature
+     * over a 32 byte digest and a recovery id in [0, 3].
+     */
+    public static native int recoverPublicKey(int curve, ByteBuffer sig, ByteBuffer digest, int recId, ByteBuffer pubKey);
+
+    /**
+     * Compresses a 65 byte uncompressed public key into 33 bytes.
+     */
+    public static native int compressPublicKey(ByteBuffer pubKey, ByteBuffer compressed);
+
+    /**
+     * Expands and validates a 33 byte compressed public key into 65 bytes.
+     */
+    public static native int uncompressPublicKey(int curve, ByteBuffer pubKey, ByteBuffer uncompressed);
+
+    /**
+     * Converts a DER encoded signature (as returned by the Android keystore) into 64 byte r|s.
+     */
+    public static native int derToSignature(ByteBuffer der, ByteBuffer sig);
+
+    /**
+     * Normalizes s of a 64 byte r|s signature to low-S and prepends the recovery header byte
+     * matching the 65 byte uncompressed public key.
+     */
+    public static native int signatureToCompact(int curve, ByteBuffer sig, ByteBuffer digest, ByteBuffer pubKey, ByteBuffer compactSig);
+
+    /**
+     * Verifies a 64 byte r|s signature over a 32 byte digest against a 33 byte compressed
+     * or 65 byte uncompressed public key.
+     */
+    public static native int verifySignature(int curve, ByteBuffer pubKey, ByteBuffer sig, ByteBuffer digest);
+
+    /**
+     * Computes the 32 byte signing digest sha256(chainId | packedTrx | cfd digest) of a packed
+     * transaction, where the cfd digest is sha256 of the packed context free data or zeros if
+     * cfdLength is 0.
+     */
+    public static native int transactionDigest(ByteBuffer chainId, ByteBuffer packedTrx, int trxLength,
+                                               ByteBuffer packedCfd, int cfdLength, ByteBuffer digest);
+
+    /**
+     * Base58 encodes the first length bytes of data with a ripemd160(data | suffix) checksum.
+     * Throws IllegalArgumentException if length is negative or above
+     * {@link #BASE58_CHECK_MAX_DATA}, or the suffix is longer than 8 bytes.
+     * Returns null if the data cannot be encoded.
+     */
+    public static native String encodeBase58Check(ByteBuffer data, int length, String suffix);
+
+    /**
+     * Computes the 32 byte sha256 of the first length bytes of data.
+     */
+    public static native int sha256(ByteBuffer data, int length, ByteBuffer digest);
+
+    /**
+     * Decodes a PVT_R1_/PVT_K1_ private key string, or a legacy WIF key (K1), into
+     * 32 bytes and checks its checksum.
+     * Returns the curve of the key, or -1 if the key is not valid.
+     */
+    public static native int decodePrivateKey(String key, ByteBuffer privateKey);
+
+    /**
+     * Signs count 32 byte digests with a 32 byte private key (RFC 6979 nonces, low-S)
+     * into count 65 byte compact signatures, each a recovery header byte followed by r|s.
+     * With canonical set, K1 signatures are restricted to the canonical form EOSIO accepts.
+     * The header of a signature that could not be made is 0.
+     * Returns the number of digests that could not be signed, or -1 on bad arguments.
+     */
+    public static native int signDigests(int curve, ByteBuffer privateKey, ByteBuffer digests, int count,
+                                         ByteBuffer compactSigs, boolean canonical);
+}
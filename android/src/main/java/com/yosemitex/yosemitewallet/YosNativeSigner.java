@@ -0,0 +1,84 @@
+package com.yosemitex.yosemitewallet;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Holds the decoded private key of the unlocked wallet in a direct buffer and signs
+ * digests with it through {@link YosEcNative}.
+ *
+ * The key never lives in a Java array: it is decoded from its string form straight
+ * into locked native memory (see {@link YosEcNative#allocateSecret(int)}) and zeroed
+ * again by {@link #clear()} when the wallet is locked or deleted.  All methods are synchronized so a lock cannot zero the key while a
+ * batch is being signed with it.
+ */
+final class YosNativeSigner {
+
+    private final ByteBuffer privateKey = allocateKey();
+    private int curve = -1;
+
+    // plain native memory once no locked memory is left
+    private static ByteBuffer allocateKey() {
+        ByteBuffer key = YosEcNative.allocateSecret(YosEcNative.PRIVATE_KEY_SIZE);
+        return key != null ? key : YosEcNative.allocate(YosEcNative.PRIVATE_KEY_SIZE);
+    }
+
+    /**
+     * Decodes key (PVT_R1_/PVT_K1_ or WIF) into the signer.
+     * Returns false and leaves the signer cleared if the key is not valid.
+     */
+    synchronized boolean load(String key) {
+        curve = YosEcNative.decodePrivateKey(key, privateKey);
+        if (curve < 0) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    synchronized boolean isLoaded() {
+        return curve >= 0;
+    }
+
+    synchronized void clear() {
+        for (int i = 0; i < YosEcNative.PRIVATE_KEY_SIZE; i++) {
+            privateKey.put(i, (byte) 0);
+        }
+        curve = -1;
+    }
+
+    /**
+     * Signs count 32 byte digests and returns their SIG_ strings.
+     * Throws IllegalStateException if no key is loaded or a digest could not be signed.
+     */
+    synchronized String[] sign(ByteBuffer digests, int count) {
+        if (curve < 0) {
+            throw new IllegalStateException("No private key loaded");
+        }
+
+        ByteBuffer compactSigs = YosEcNative.allocate(YosEcNative.COMPACT_SIGNATURE_SIZE * count);
+
+        if (YosEcNative.signDigests(curve, privateKey, digests, count, compactSigs, true) != 0) {
+            throw new IllegalStateException("Signing failed");
+        }
+
+        String keyType = curve == YosEcNative.CURVE_K1 ? YosEcNative.KEY_TYPE_K1 : YosEcNative.KEY_TYPE_R1;
+        String[] signatures = new String[count];
+
+        for (int i = 0; i < count; i++) {
+            signatures[i] = "SIG_" + keyType + "_" +
+                    YosEcNative.encodeBase58Check(slice(compactSigs, YosEcNative.COMPACT_SIGNATURE_SIZE * i),
+                            YosEcNative.COMPACT_SIGNATURE_SIZE, keyType);
+        }
+        return signatures;
+    }
+
+    /**
+     * Returns a direct buffer starting at offset of buffer, sharing its memory, for the
+     * native calls that read and write from index 0.
+     */
+    static ByteBuffer slice(ByteBuffer buffer, int offset) {
+        ByteBuffer view = buffer.duplicate();
+        view.position(offset);
+        return view.slice();
+    }
+}
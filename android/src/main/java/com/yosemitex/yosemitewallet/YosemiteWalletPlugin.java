@@ -1,16 +1,22 @@
 package com.yosemitex.yosemitewallet;
 
 import android.content.Context;
+import android.os.Handler;
+import android.os.Looper;
 import android.util.Log;
 
 import com.google.gson.Gson;
-import com.yosemitex.yosemitewalletlibrary.crypto.ec.YosPublicKey;
 import com.yosemitex.yosemitewalletlibrary.data.wallet.WalletManager;
 import com.yosemitex.yosemitewalletlibrary.util.Utils;
 
 import java.io.File;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import io.flutter.plugin.common.MethodCall;
 import io.flutter.plugin.common.MethodChannel;
@@ -33,6 +39,12 @@ public class YosemiteWalletPlugin implements MethodCallHandler {
 
     final private WalletManager walletManager;
     final private Gson gson;
+    final private YosNativeSigner nativeSigner = new YosNativeSigner();
+
+    // batches are signed off the platform thread, one batch at a time; the
+    // native core spreads each batch over one thread per processor
+    final private ExecutorService signer = Executors.newSingleThreadExecutor();
+    final private Handler mainHandler = new Handler(Looper.getMainLooper());
 
     /**
      * Plugin registration.
@@ -81,6 +93,14 @@ public class YosemiteWalletPlugin implements MethodCallHandler {
         } else if (call.method.equals("signMessageData")) {
             byte[] data = call.argument("data");
             signMessageData(data, result);
+        } else if (call.method.equals("signTransaction")) {
+            byte[] chainId = call.argument("chainId");
+            byte[] packedTrx = call.argument("packedTrx");
+            byte[] packedContextFreeData = call.argument("packedContextFreeData");
+            signTransaction(chainId, packedTrx, packedContextFreeData, result);
+        } else if (call.method.equals("signDigests")) {
+            List<byte[]> digests = call.argument("digests");
+            signDigests(digests, result);
         } else if (call.method.equals("getPublicKey")) {
             if (this.walletManager.isLocked(DEFAULT_WALLET_NAME)) {
                 result.error(ERROR_TYPE_OPERATION_NOT_PERMITTED, "Wallet should be unlocked before calling this API", null);
@@ -124,6 +144,8 @@ public class YosemiteWalletPlugin implements MethodCallHandler {
     }
 
     private void delete(Result result) {
+        nativeSigner.clear();
+
         try {
             result.success(this.walletManager.deleteFile(DEFAULT_WALLET_NAME));
         } catch (Exception e) {
@@ -140,6 +162,7 @@ public class YosemiteWalletPlugin implements MethodCallHandler {
     }
 
     private void lock() {
+        nativeSigner.clear();
         this.walletManager.lock(DEFAULT_WALLET_NAME);
     }
 
@@ -157,21 +180,151 @@ public class YosemiteWalletPlugin implements MethodCallHandler {
     }
 
     private void signMessageData(byte[] data, Result result) {
+        if (!loadPrivateKey(result)) {
+            return;
+        }
+
+        ByteBuffer digest = YosEcNative.allocate(YosEcNative.DIGEST_SIZE);
+        YosEcNative.sha256(direct(data), data.length, digest);
+
+        signDigest(digest, result);
+    }
+
+    /**
+     * Signs the digest sha256(chainId | packedTrx | sha256(packedContextFreeData))
+     * computed by the native core, without joining the preimage.
+     */
+    private void signTransaction(byte[] chainId, byte[] packedTrx, byte[] packedContextFreeData, Result result) {
+        if (!loadPrivateKey(result)) {
+            return;
+        }
+
+        ByteBuffer digest = YosEcNative.allocate(YosEcNative.DIGEST_SIZE);
+        transactionDigest(direct(chainId), packedTrx, packedContextFreeData, digest);
+
+        signDigest(digest, result);
+    }
+
+    private void signDigest(ByteBuffer digest, Result result) {
+        try {
+            result.success(nativeSigner.sign(digest, 1)[0]);
+        } catch (IllegalStateException e) {
+            result.error(ERROR_TYPE_OPERATION_NOT_FAILED, e.getMessage(), null);
+        }
+    }
+
+    private static void transactionDigest(ByteBuffer chainId, byte[] packedTrx, byte[] packedContextFreeData, ByteBuffer digest) {
+        // an empty context free data vector packs as a single zero byte and
+        // signs with a zero digest
+        int cfdLength = packedContextFreeData != null && packedContextFreeData.length > 0 && packedContextFreeData[0] != 0
+                ? packedContextFreeData.length : 0;
+
+        YosEcNative.transactionDigest(chainId, direct(packedTrx), packedTrx.length,
+                cfdLength > 0 ? direct(packedContextFreeData) : null, cfdLength, digest);
+    }
+
+    private static ByteBuffer direct(byte[] bytes) {
+        ByteBuffer buffer = YosEcNative.allocate(bytes.length);
+        buffer.put(bytes);
+        return buffer;
+    }
+
+    /**
+     * Signs a batch of 32 byte digests, as prepared on the Dart side, on the
+     * signer thread and answers once with all signatures, so the platform
+     * thread and the Dart side are not blocked per transaction.  The digests
+     * are signed with a single native call.
+     */
+    private void signDigests(final List<byte[]> digestList, final Result result) {
+        for (byte[] digest : digestList) {
+            if (digest.length != YosEcNative.DIGEST_SIZE) {
+                result.error(ERROR_TYPE_OPERATION_NOT_FAILED, "Digests must be 32 bytes", null);
+                return;
+            }
+        }
+        if (!loadPrivateKey(result)) {
+            return;
+        }
+
+        signer.execute(new Runnable() {
+            @Override
+            public void run() {
+                final int count = digestList.size();
+                final ByteBuffer digests = YosEcNative.allocate(YosEcNative.DIGEST_SIZE * count);
+                final List<String> signatures;
+
+                for (byte[] digest : digestList) {
+                    digests.put(digest);
+                }
+
+                try {
+                    signatures = Arrays.asList(nativeSigner.sign(digests, count));
+                } catch (final Exception e) {
+                    mainHandler.post(new Runnable() {
+                        @Override
+                        public void run() {
+                            result.error(ERROR_TYPE_OPERATION_NOT_FAILED, e.getMessage(), null);
+                        }
+                    });
+                    return;
+                }
+
+                mainHandler.post(new Runnable() {
+                    @Override
+                    public void run() {
+                        result.success(signatures);
+                    }
+                });
+            }
+        });
+    }
+
+    /**
+     * Decodes the private key of the wallet into the native signer the first
+     * time it is needed after an unlock.  Answers result with an error and
+     * returns false if the wallet is locked or its key cannot be read.
+     */
+    private boolean loadPrivateKey(Result result) {
         if (this.walletManager.isLocked(DEFAULT_WALLET_NAME)) {
+            nativeSigner.clear();
             result.error(ERROR_TYPE_OPERATION_NOT_PERMITTED, "Wallet is locked", null);
-            return;
+            return false;
+        }
+        if (nativeSigner.isLoaded()) {
+            return true;
         }
 
-        String pubKey = getPubKey();
+        String privateKey = getPrivateKey(getPubKey());
+
+        if (privateKey == null || !nativeSigner.load(privateKey)) {
+            result.error(ERROR_TYPE_OPERATION_NOT_FAILED, "No private key found", null);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * listKeysAsPairString returns the keys of the unlocked wallet as a JSON
+     * array of [public key, private key] pairs.
+     */
+    private String getPrivateKey(String pubKey) {
+        if (pubKey == null) {
+            return null;
+        }
 
-        String signature = this.walletManager.signData(data, new YosPublicKey(pubKey));
+        String[][] pairs = gson.fromJson(this.walletManager.listKeysAsPairString(), String[][].class);
 
-        result.success(signature);
+        if (pairs != null) {
+            for (String[] pair : pairs) {
+                if (pair.length == 2 && pubKey.equals(pair[0])) {
+                    return pair[1];
+                }
+            }
+        }
+        return null;
     }
 
     private String getPubKey() {
-        this.walletManager.listKeysAsPairString();
-
         ArrayList<String> pubKeys = this.walletManager.listPubKeys();
 
         if (pubKeys.size() == 1) {
@@ -164,10 +164,14 @@ class _MyAppState extends State<MyApp> {
       'tag': 'This is the tx from Secure Enclave'
     };
 
-    Future.wait([chainService.getChainInfo(), chainService.getAbi('yx.tokenabi', action, txData)])
-        .then((List responses) {
+    Future.wait([
+      chainService.getCachedChainInfo(),
+      chainService.getTapos(),
+      chainService.getAbi('yx.tokenabi', action, txData)
+    ]).then((List responses) {
       final chainInfoRes = responses[0];
-      final abiRes = responses[1];
+      final tapos = responses[1];
+      final abiRes = responses[2];
 
       Action actionReq =
           Action(account: contract, name: action, authorization: authorizations, data: abiRes);
@@ -178,17 +182,9 @@ class _MyAppState extends State<MyApp> {
           TransactionExtension.TransactionVoteAccount, 'producer.a');
       txnBeforeSign.addStringTransactionExtension(
           TransactionExtension.DelegatedTransactionFeePayer, myAccountName);
-      txnBeforeSign.referenceBlock = chainInfoRes.headBlockId;
-      txnBeforeSign.expiration = chainInfoRes.addTimeAfterHeadBlockTimeByMin(10);
+      txnBeforeSign.tapos = tapos;
 
-      Uint8List packedBytesToSign = txnBeforeSign.getDigestForSignature(chainInfoRes.chainId);
-
-      final dataInHexStr = packedBytesToSign.fold(
-          '', (prev, elem) => '$prev${elem.toRadixString(16).padLeft(2, '0')}');
-
-      print('Packed tx to sign: ' + dataInHexStr);
-
-      return YosemiteWallet.signMessageData(packedBytesToSign).then((signature) {
+      return YosemiteWallet.signTransaction(txnBeforeSign, chainInfoRes.chainId).then((signature) {
         txnBeforeSign.addSignature(signature);
         return txnBeforeSign;
       });
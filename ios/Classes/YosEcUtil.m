@@ -72,25 +72,16 @@ const uint8_t *fromhex(const char *str)
 + (NSString *)encodeBase58CheckStringWithData:(NSData *)data {
   if (!data) return NULL;
   
-  uint8_t typeBytes[2] = {0x52, 0x31};
-  
-  uint8_t toHashBytes[data.length + 2];
-  memcpy(toHashBytes, data.bytes, data.length);
-  memcpy(toHashBytes + data.length, typeBytes, 2);
-  
-  uint8_t buf[data.length + RIPEMD160_DIGEST_LENGTH];
-  
-  ripemd160(toHashBytes, (int)data.length + 2, buf);
-  
-  NSMutableData *dataWithChecksum = [NSMutableData dataWithData:data];
-  [dataWithChecksum appendBytes:buf length:4]; // adding first 4 bytes as checksum
+  char addr[MAX_ADDR_SIZE];
+  size_t res = sizeof(addr);
   
-  NSLog(@"Compressed key with checksum:%@", dataWithChecksum);
+  if (!b58encWithChecksum(addr, &res, data.bytes, (size_t)data.length, "R1")) {
+    return nil;
+  }
   
-  NSString *result = [self encodeBase58StringWithData:dataWithChecksum];
+  NSString *result = [NSString stringWithCString:addr encoding:NSASCIIStringEncoding];
   
-  YOSSecureMemset(buf, 0, sizeof(buf));
-  YOSDataClear(dataWithChecksum);
+  YOSSecureMemset(addr, 0, sizeof(addr));
   return result;
 }
 
@@ -21,5 +21,11 @@
 - (void)unlock:(NSString *)password;
 - (NSString *)getPublicKey;
 - (void)sign:(NSData *)digest withCompletion:(void(^)(NSString *, NSError *)) completion;
+- (void)signTransaction:(NSData *)packedTrx contextFreeData:(NSData *)packedContextFreeData chainId:(NSData *)chainId withCompletion:(void(^)(NSString *, NSError *)) completion;
+
+// Signs a batch of transactions on background threads, several at a time.
+// completion is called once, on a background queue, with a signature or
+// NSNull for every transaction.
+- (void)signDigests:(NSArray<NSData *> *)digests withCompletion:(void(^)(NSArray *, NSError *)) completion;
 
 @end
@@ -12,6 +12,7 @@
 #include "bignum.h"
 #include "ecdsa.h"
 #include "secp256r1.h"
+#include "trx_digest.h"
 #include "YosEcUtil.h"
 
 #import <CommonCrypto/CommonDigest.h>
@@ -324,6 +325,27 @@ NSString *const Salt = @"1-I/P~XnXboGQ!jY(,{@a4uc)A!-sZz}2;[4|Fj*G.(?G4%;L?sEy&U
 
 - (void)sign:(NSData *)digest withCompletion:(void(^)(NSString *, NSError *)) completion {
   
+  uint8_t digestDataByte[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(digest.bytes, (uint32_t)digest.length, digestDataByte);
+  
+  [self _signDigest:digestDataByte withCompletion:completion];
+}
+
+- (void)signTransaction:(NSData *)packedTrx contextFreeData:(NSData *)packedContextFreeData chainId:(NSData *)chainId withCompletion:(void(^)(NSString *, NSError *)) completion {
+  
+  if (chainId.length != 32) {
+    completion(nil, nil);
+    return;
+  }
+  
+  uint8_t digestDataByte[SHA256_DIGEST_LENGTH];
+  trx_digest(chainId.bytes, packedTrx.bytes, packedTrx.length, packedContextFreeData.bytes, packedContextFreeData.length, digestDataByte);
+  
+  [self _signDigest:digestDataByte withCompletion:completion];
+}
+
+- (void)_signDigest:(uint8_t *)digestDataByte withCompletion:(void(^)(NSString *, NSError *)) completion {
+  
   [self _assertWalletUnlocked];
   
   SecKeyRef privateKeyRef = self.privateKeyRef;
@@ -334,9 +356,6 @@ NSString *const Salt = @"1-I/P~XnXboGQ!jY(,{@a4uc)A!-sZz}2;[4|Fj*G.(?G4%;L?sEy&U
     return;
   }
   
-  uint8_t digestDataByte[CC_SHA256_DIGEST_LENGTH];
-  CC_SHA256(digest.bytes, (uint32_t)digest.length, digestDataByte);
-  
   CFErrorRef error = NULL;
   
   NSData *publicKeyData = (__bridge NSData *)SecKeyCopyExternalRepresentation(publicKeyRef, &error);
@@ -354,57 +373,93 @@ NSString *const Salt = @"1-I/P~XnXboGQ!jY(,{@a4uc)A!-sZz}2;[4|Fj*G.(?G4%;L?sEy&U
     return;
   }
   
-  NSData *digestData2 = [NSData dataWithData:(__bridge NSData *)CFDataCreate(NULL, (UInt8*)digestDataByte, CC_SHA256_DIGEST_LENGTH)];
-  NSLog(@"digestData:%@", digestData2);
+  NSError *signError = nil;
+  NSString *signature = [self _signatureForDigest:digestDataByte privateKey:privateKeyRef publicKeyData:publicKeyData error:&signError];
+  
+  completion(signature, signError);
+}
+
+// Signs one digest and converts the signature to the SIG_R1_ string form.
+// Returns nil if the key cannot sign or no recovery id matches publicKeyData.
+// Safe to call from several threads at once.
+- (NSString *)_signatureForDigest:(const uint8_t *)digestDataByte privateKey:(SecKeyRef)privateKeyRef publicKeyData:(NSData *)publicKeyData error:(NSError **)error {
   
-  NSData *signature = (__bridge NSData *)SecKeyCreateSignature(privateKeyRef, kSecKeyAlgorithmECDSASignatureDigestX962SHA256, CFDataCreate(NULL, (UInt8*)digestDataByte, CC_SHA256_DIGEST_LENGTH), &error);
+  CFErrorRef cfError = NULL;
+  NSData *digestData = [NSData dataWithBytes:digestDataByte length:CC_SHA256_DIGEST_LENGTH];
+  NSData *signature = CFBridgingRelease(SecKeyCreateSignature(privateKeyRef, kSecKeyAlgorithmECDSASignatureDigestX962SHA256, (__bridge CFDataRef)digestData, &cfError));
+  
+  if (signature == nil) {
+    NSError *signError = CFBridgingRelease(cfError);
+    if (error) {
+      *error = signError;
+    }
+    return nil;
+  }
   
   uint8_t sig_asn1[64];
   
   ecdsa_der_to_sig((uint8_t *)signature.bytes, sig_asn1);
   
-  NSLog(@"sig_asn1:%@", [NSData dataWithBytes:sig_asn1 length:64]);
+  uint8_t compact_sig[65];
+  
+  if (ecdsa_sig_to_compact(&secp256r1, sig_asn1, digestDataByte, publicKeyData.bytes, compact_sig) != 0) {
+    return nil;
+  }
+  return [NSString stringWithFormat:@"SIG_R1_%@", [YosEcUtil encodeBase58CheckStringWithData:[NSData dataWithBytes:compact_sig length:65]]];
+}
+
+- (void)signDigests:(NSArray<NSData *> *)digests withCompletion:(void(^)(NSArray *, NSError *)) completion {
   
-  const ecdsa_curve *curve = &secp256r1;
+  [self _assertWalletUnlocked];
   
-  uint8_t sig_asn1_s[32];
-  memcpy(sig_asn1_s, sig_asn1 + 32, 32);
+  for (NSData *digest in digests) {
+    if (digest.length != SHA256_DIGEST_LENGTH) {
+      completion(nil, nil);
+      return;
+    }
+  }
   
-  NSLog(@"sig_asn1_s:%@", [NSData dataWithBytes:sig_asn1_s length:32]);
+  SecKeyRef privateKeyRef = self.privateKeyRef;
+  SecKeyRef publicKeyRef = self.publicKeyRef;
   
-  bignum256 s_big;
+  if (privateKeyRef == nil || publicKeyRef == nil) {
+    completion(nil, [NSError errorWithDomain:WalletErrorDomain code:WalletErrorNoKeyPairFound userInfo:nil]);
+    return;
+  }
   
-  bn_read_be(sig_asn1_s, &s_big);
+  CFErrorRef error = NULL;
+  NSData *publicKeyData = CFBridgingRelease(SecKeyCopyExternalRepresentation(publicKeyRef, &error));
   
-  if (bn_is_less(&secp256r1.order_half, &s_big)) {
-    bignum256 result;
-    bn_subtract(&secp256r1.order, &s_big, &result);
-    bn_write_be(&result, sig_asn1 + 32);
+  if (publicKeyData == nil) {
+    completion(nil, CFBridgingRelease(error));
+    return;
   }
   
-  int i;
-  int recId = -1;
-  const uint8_t *pub_key_bytes = publicKeyData.bytes;
-  uint8_t rec_pubkey[65];
-  for (i = 0; i < 4; i++) {
-    ecdsa_recover_pub_from_sig(curve, rec_pubkey, sig_asn1, digestDataByte, i);
-    
-    NSLog(@"rec_pubkey:%@ with recId:%d", [NSData dataWithBytes:rec_pubkey length:65], i);
+  // the key must outlive a lock of the wallet while the batch is signed
+  CFRetain(privateKeyRef);
+  
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    NSUInteger count = digests.count;
+    NSMutableArray *signatures = [NSMutableArray arrayWithCapacity:count];
     
-    if (memcmp(rec_pubkey, pub_key_bytes, 65) == 0) {
-      recId = i;
-      break;
+    for (NSUInteger i = 0; i < count; i++) {
+      [signatures addObject:[NSNull null]];
     }
-  }
-  
-  if (recId == -1) {
-    completion(nil, nil);
-  } else {
-    uint8_t compact_sig[65];
-    memset(compact_sig, (recId + 27 + 4), 1);
-    memcpy(compact_sig + 1, sig_asn1, 64);
-    completion([NSString stringWithFormat:@"SIG_R1_%@", [YosEcUtil encodeBase58CheckStringWithData:[NSData dataWithBytes:compact_sig length:65]]], nil);
-  }
+    
+    // signatures of the batch in parallel
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+      NSString *signature = [self _signatureForDigest:digests[i].bytes privateKey:privateKeyRef publicKeyData:publicKeyData error:NULL];
+      
+      if (signature != nil) {
+        @synchronized (signatures) {
+          signatures[i] = signature;
+        }
+      }
+    });
+    
+    CFRelease(privateKeyRef);
+    completion(signatures, nil);
+  });
 }
 
 - (void)dealloc {
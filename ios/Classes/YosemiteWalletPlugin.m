@@ -61,6 +61,33 @@
     [[YosWallet sharedManager] sign:bytes.data withCompletion:^(NSString *signature, NSError *err) {
       result(signature);
     }];
+  } else if ([@"signTransaction" isEqualToString:call.method]) {
+    FlutterStandardTypedData *chainId = call.arguments[@"chainId"];
+    FlutterStandardTypedData *packedTrx = call.arguments[@"packedTrx"];
+    FlutterStandardTypedData *packedContextFreeData = call.arguments[@"packedContextFreeData"];
+    
+    [[YosWallet sharedManager] signTransaction:packedTrx.data contextFreeData:packedContextFreeData.data chainId:chainId.data withCompletion:^(NSString *signature, NSError *err) {
+      result(signature);
+    }];
+  } else if ([@"signDigests" isEqualToString:call.method]) {
+    NSArray<FlutterStandardTypedData *> *digestArgs = call.arguments[@"digests"];
+    NSMutableArray<NSData *> *digests = [NSMutableArray arrayWithCapacity:digestArgs.count];
+    
+    for (FlutterStandardTypedData *digest in digestArgs) {
+      [digests addObject:digest.data];
+    }
+    
+    @try {
+      [[YosWallet sharedManager] signDigests:digests withCompletion:^(NSArray *signatures, NSError *err) {
+        // results go back on the platform thread
+        dispatch_async(dispatch_get_main_queue(), ^{
+          result(signatures);
+        });
+      }];
+    } @catch (NSException *exception) {
+      NSLog(@"%@", [exception reason]);
+      result(nil);
+    }
   } else {
     result(FlutterMethodNotImplemented);
   }
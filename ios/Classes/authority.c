@@ -0,0 +1,553 @@
+//
+//  authority.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "authority.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EMPTY 0
+
+// memoized result of a permission within one check
+#define STATE_VISITING  1
+#define STATE_SATISFIED 2
+#define STATE_FAILED    3
+
+typedef struct {
+  uint32_t key_id;
+  uint16_t weight;
+} key_entry;
+
+typedef struct {
+  authority_level level;
+  uint64_t parent;
+  uint32_t threshold;
+  uint32_t key_count;
+  uint32_t account_count;
+  key_entry *keys;
+  authority_level_weight *accounts;
+  uint8_t in_use;
+  uint32_t next_free;
+} permission;
+
+// Per-check state: marks of the provided keys and memoized permission
+// results, valid for the current epoch only.
+struct authority_scratch {
+  uint32_t epoch;
+  uint32_t *key_marks;
+  uint32_t key_alloc;
+  uint32_t *perm_epochs;
+  uint8_t *perm_states;
+  uint32_t perm_alloc;
+};
+
+// Open addressing tables store id + 1 per slot (EMPTY = 0) and use linear
+// probing over a power of two capacity kept at most half full.
+struct authority_index {
+  authority_key *keys;
+  uint32_t key_count;
+  uint32_t key_alloc;
+  uint32_t *key_slots;
+  uint32_t key_mask;
+
+  permission *perms;
+  uint32_t perm_count;      // live permissions
+  uint32_t perm_alloc;      // used entries of perms, live or free
+  uint32_t perm_capacity;
+  uint32_t free_perm;       // id + 1 of the first free entry, EMPTY if none
+  uint32_t *perm_slots;
+  uint32_t perm_mask;
+
+  authority_scratch *scratch;  // used by authority_check
+};
+
+static inline uint64_t mix64(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint32_t key_hash(const authority_key *key)
+{
+  uint64_t x;
+  // the x coordinate is already uniformly distributed
+  memcpy(&x, key->data + 1, sizeof(x));
+  return (uint32_t)mix64(x ^ key->data[0] ^ ((uint64_t)key->type << 8));
+}
+
+static inline uint32_t level_hash(const authority_level *level)
+{
+  return (uint32_t)mix64(level->actor ^ mix64(level->permission));
+}
+
+static inline int key_equal(const authority_key *a, const authority_key *b)
+{
+  return a->type == b->type && memcmp(a->data, b->data, sizeof(a->data)) == 0;
+}
+
+static inline int level_equal(const authority_level *a, const authority_level *b)
+{
+  return a->actor == b->actor && a->permission == b->permission;
+}
+
+static uint32_t *alloc_slots(uint32_t capacity)
+{
+  return calloc(capacity, sizeof(uint32_t));
+}
+
+authority_index *authority_index_new(void)
+{
+  authority_index *index = calloc(1, sizeof(authority_index));
+
+  if (index == NULL) {
+    return NULL;
+  }
+  index->key_slots = alloc_slots(16);
+  index->perm_slots = alloc_slots(16);
+  if (index->key_slots == NULL || index->perm_slots == NULL) {
+    authority_index_free(index);
+    return NULL;
+  }
+  index->key_mask = 15;
+  index->perm_mask = 15;
+  index->scratch = authority_scratch_new();
+  if (index->scratch == NULL) {
+    authority_index_free(index);
+    return NULL;
+  }
+  return index;
+}
+
+void authority_index_free(authority_index *index)
+{
+  uint32_t i;
+
+  if (index == NULL) {
+    return;
+  }
+  for (i = 0; i < index->perm_alloc; i++) {
+    free(index->perms[i].keys);
+    free(index->perms[i].accounts);
+  }
+  free(index->perms);
+  free(index->perm_slots);
+  free(index->keys);
+  free(index->key_slots);
+  authority_scratch_free(index->scratch);
+  free(index);
+}
+
+authority_scratch *authority_scratch_new(void)
+{
+  authority_scratch *scratch = calloc(1, sizeof(authority_scratch));
+
+  if (scratch != NULL) {
+    scratch->epoch = 1;
+  }
+  return scratch;
+}
+
+void authority_scratch_free(authority_scratch *scratch)
+{
+  if (scratch == NULL) {
+    return;
+  }
+  free(scratch->key_marks);
+  free(scratch->perm_epochs);
+  free(scratch->perm_states);
+  free(scratch);
+}
+
+// grow the scratch arrays to the current size of the index
+static int reserve_scratch(const authority_index *index, authority_scratch *scratch)
+{
+  uint32_t *marks, *epochs;
+  uint8_t *states;
+
+  if (scratch->key_alloc < index->key_count) {
+    marks = realloc(scratch->key_marks, index->key_alloc * sizeof(uint32_t));
+    if (marks == NULL) {
+      return 1;
+    }
+    memset(marks + scratch->key_alloc, 0, (index->key_alloc - scratch->key_alloc) * sizeof(uint32_t));
+    scratch->key_marks = marks;
+    scratch->key_alloc = index->key_alloc;
+  }
+  if (scratch->perm_alloc < index->perm_alloc) {
+    epochs = realloc(scratch->perm_epochs, index->perm_capacity * sizeof(uint32_t));
+    if (epochs == NULL) {
+      return 1;
+    }
+    scratch->perm_epochs = epochs;
+    states = realloc(scratch->perm_states, index->perm_capacity);
+    if (states == NULL) {
+      return 1;
+    }
+    scratch->perm_states = states;
+    memset(epochs + scratch->perm_alloc, 0, (index->perm_capacity - scratch->perm_alloc) * sizeof(uint32_t));
+    scratch->perm_alloc = index->perm_capacity;
+  }
+  return 0;
+}
+
+// keys
+
+static int find_key(const authority_index *index, const authority_key *key, uint32_t *id)
+{
+  uint32_t i = key_hash(key) & index->key_mask;
+
+  while (index->key_slots[i] != EMPTY) {
+    if (key_equal(&index->keys[index->key_slots[i] - 1], key)) {
+      *id = index->key_slots[i] - 1;
+      return 1;
+    }
+    i = (i + 1) & index->key_mask;
+  }
+  return 0;
+}
+
+static int grow_keys(authority_index *index)
+{
+  uint32_t capacity = (index->key_mask + 1) * 2, i, j;
+  uint32_t *slots = alloc_slots(capacity);
+
+  if (slots == NULL) {
+    return 1;
+  }
+  for (j = 0; j < index->key_count; j++) {
+    i = key_hash(&index->keys[j]) & (capacity - 1);
+    while (slots[i] != EMPTY) {
+      i = (i + 1) & (capacity - 1);
+    }
+    slots[i] = j + 1;
+  }
+  free(index->key_slots);
+  index->key_slots = slots;
+  index->key_mask = capacity - 1;
+  return 0;
+}
+
+// Keys are never removed, so key ids stay valid for the lifetime of the
+// index.
+static int intern_key(authority_index *index, const authority_key *key, uint32_t *id)
+{
+  uint32_t i, alloc;
+  authority_key *keys;
+
+  if (find_key(index, key, id)) {
+    return 0;
+  }
+  if ((index->key_count + 1) * 2 > index->key_mask + 1 && grow_keys(index) != 0) {
+    return 1;
+  }
+  if (index->key_count == index->key_alloc) {
+    alloc = index->key_alloc ? index->key_alloc * 2 : 16;
+    keys = realloc(index->keys, alloc * sizeof(authority_key));
+    if (keys == NULL) {
+      return 1;
+    }
+    index->keys = keys;
+    index->key_alloc = alloc;
+  }
+  *id = index->key_count++;
+  index->keys[*id] = *key;
+  i = key_hash(key) & index->key_mask;
+  while (index->key_slots[i] != EMPTY) {
+    i = (i + 1) & index->key_mask;
+  }
+  index->key_slots[i] = *id + 1;
+  return 0;
+}
+
+// permissions
+
+static uint32_t *find_perm_slot(const authority_index *index, const authority_level *level)
+{
+  uint32_t i = level_hash(level) & index->perm_mask;
+
+  while (index->perm_slots[i] != EMPTY) {
+    if (level_equal(&index->perms[index->perm_slots[i] - 1].level, level)) {
+      return &index->perm_slots[i];
+    }
+    i = (i + 1) & index->perm_mask;
+  }
+  return NULL;
+}
+
+static permission *find_perm(const authority_index *index, const authority_level *level)
+{
+  uint32_t *slot = find_perm_slot(index, level);
+  return slot ? &index->perms[*slot - 1] : NULL;
+}
+
+static void insert_perm_slot(uint32_t *slots, uint32_t mask, const authority_level *level, uint32_t id)
+{
+  uint32_t i = level_hash(level) & mask;
+
+  while (slots[i] != EMPTY) {
+    i = (i + 1) & mask;
+  }
+  slots[i] = id + 1;
+}
+
+static int grow_perms(authority_index *index)
+{
+  uint32_t capacity = (index->perm_mask + 1) * 2, j;
+  uint32_t *slots = alloc_slots(capacity);
+
+  if (slots == NULL) {
+    return 1;
+  }
+  for (j = 0; j < index->perm_alloc; j++) {
+    if (index->perms[j].in_use) {
+      insert_perm_slot(slots, capacity - 1, &index->perms[j].level, j);
+    }
+  }
+  free(index->perm_slots);
+  index->perm_slots = slots;
+  index->perm_mask = capacity - 1;
+  return 0;
+}
+
+static permission *new_perm(authority_index *index, const authority_level *level)
+{
+  permission *perms;
+  uint32_t id, capacity;
+
+  if ((index->perm_count + 1) * 2 > index->perm_mask + 1 && grow_perms(index) != 0) {
+    return NULL;
+  }
+  if (index->free_perm != EMPTY) {
+    id = index->free_perm - 1;
+    index->free_perm = index->perms[id].next_free;
+  } else {
+    if (index->perm_alloc == index->perm_capacity) {
+      capacity = index->perm_capacity ? index->perm_capacity * 2 : 16;
+      perms = realloc(index->perms, capacity * sizeof(permission));
+      if (perms == NULL) {
+        return NULL;
+      }
+      index->perms = perms;
+      index->perm_capacity = capacity;
+    }
+    id = index->perm_alloc++;
+  }
+  memset(&index->perms[id], 0, sizeof(permission));
+  index->perms[id].level = *level;
+  index->perms[id].in_use = 1;
+  index->perm_count++;
+  insert_perm_slot(index->perm_slots, index->perm_mask, level, id);
+  return &index->perms[id];
+}
+
+int authority_set_permission(authority_index *index, const authority_level *level, uint64_t parent, uint32_t threshold,
+                             const authority_key_weight *keys, size_t key_count,
+                             const authority_level_weight *accounts, size_t account_count)
+{
+  key_entry *key_entries = NULL;
+  authority_level_weight *account_entries = NULL;
+  permission *perm;
+  size_t i;
+
+  if (key_count > 0) {
+    key_entries = malloc(key_count * sizeof(key_entry));
+    if (key_entries == NULL) {
+      return 1;
+    }
+    for (i = 0; i < key_count; i++) {
+      if (intern_key(index, &keys[i].key, &key_entries[i].key_id) != 0) {
+        free(key_entries);
+        return 1;
+      }
+      key_entries[i].weight = keys[i].weight;
+    }
+  }
+  if (account_count > 0) {
+    account_entries = malloc(account_count * sizeof(authority_level_weight));
+    if (account_entries == NULL) {
+      free(key_entries);
+      return 1;
+    }
+    memcpy(account_entries, accounts, account_count * sizeof(authority_level_weight));
+  }
+
+  perm = find_perm(index, level);
+  if (perm == NULL) {
+    perm = new_perm(index, level);
+    if (perm == NULL) {
+      free(key_entries);
+      free(account_entries);
+      return 1;
+    }
+  } else {
+    free(perm->keys);
+    free(perm->accounts);
+  }
+  perm->parent = parent;
+  perm->threshold = threshold;
+  perm->keys = key_entries;
+  perm->key_count = (uint32_t)key_count;
+  perm->accounts = account_entries;
+  perm->account_count = (uint32_t)account_count;
+  return 0;
+}
+
+int authority_remove_permission(authority_index *index, const authority_level *level)
+{
+  uint32_t *slot = find_perm_slot(index, level);
+  uint32_t i, j, home, id;
+
+  if (slot == NULL) {
+    return 1;
+  }
+  id = *slot - 1;
+  free(index->perms[id].keys);
+  free(index->perms[id].accounts);
+  memset(&index->perms[id], 0, sizeof(permission));
+  index->perms[id].next_free = index->free_perm;
+  index->free_perm = id + 1;
+  index->perm_count--;
+
+  // backward shift deletion: move later entries of the probe sequence
+  // into the hole unless that would put them before their home slot.
+  i = (uint32_t)(slot - index->perm_slots);
+  index->perm_slots[i] = EMPTY;
+  j = i;
+  for (;;) {
+    j = (j + 1) & index->perm_mask;
+    if (index->perm_slots[j] == EMPTY) {
+      break;
+    }
+    home = level_hash(&index->perms[index->perm_slots[j] - 1].level) & index->perm_mask;
+    if (((j - home) & index->perm_mask) >= ((j - i) & index->perm_mask)) {
+      index->perm_slots[i] = index->perm_slots[j];
+      index->perm_slots[j] = EMPTY;
+      i = j;
+    }
+  }
+  return 0;
+}
+
+// checks
+
+// Satisfied results are final.  A permission that fails only because the
+// depth limit cut its evaluation short, or because it reached a permission
+// still being evaluated further up, could be satisfied when reached on
+// another path, so such failures are not memoized and *cut is set.
+static int perm_satisfied(const authority_index *index, authority_scratch *scratch, const permission *perm, int depth, int *cut)
+{
+  uint32_t id = (uint32_t)(perm - index->perms);
+  uint32_t weight = 0, i;
+  const permission *account;
+  int account_cut = 0;
+
+  if (scratch->perm_epochs[id] == scratch->epoch) {
+    // a permission that is still being evaluated is part of a cycle
+    if (scratch->perm_states[id] == STATE_VISITING) {
+      *cut = 1;
+    }
+    return scratch->perm_states[id] == STATE_SATISFIED;
+  }
+  if (depth > AUTHORITY_MAX_DEPTH) {
+    *cut = 1;
+    return 0;
+  }
+  scratch->perm_epochs[id] = scratch->epoch;
+  scratch->perm_states[id] = STATE_VISITING;
+
+  for (i = 0; i < perm->key_count && weight < perm->threshold; i++) {
+    if (scratch->key_marks[perm->keys[i].key_id] == scratch->epoch) {
+      weight += perm->keys[i].weight;
+    }
+  }
+  for (i = 0; i < perm->account_count && weight < perm->threshold; i++) {
+    account = find_perm(index, &perm->accounts[i].level);
+    if (account != NULL && perm_satisfied(index, scratch, account, depth + 1, &account_cut)) {
+      weight += perm->accounts[i].weight;
+    }
+  }
+  if (weight >= perm->threshold) {
+    scratch->perm_states[id] = STATE_SATISFIED;
+    return 1;
+  }
+  if (account_cut) {
+    // forget the permission again, epochs start at 1
+    scratch->perm_epochs[id] = 0;
+    *cut = 1;
+  } else {
+    scratch->perm_states[id] = STATE_FAILED;
+  }
+  return 0;
+}
+
+// a level is satisfied by its own permission or any of its parents
+static int level_satisfied(const authority_index *index, authority_scratch *scratch, const authority_level *level)
+{
+  authority_level parent = *level;
+  const permission *perm = find_perm(index, level);
+  uint32_t walked = 0;
+  int cut = 0;
+
+  while (perm != NULL && walked++ <= index->perm_count) {
+    if (perm_satisfied(index, scratch, perm, 0, &cut)) {
+      return 1;
+    }
+    if (perm->parent == 0) {
+      break;
+    }
+    parent.permission = perm->parent;
+    perm = find_perm(index, &parent);
+  }
+  return 0;
+}
+
+static void next_epoch(authority_scratch *scratch)
+{
+  if (++scratch->epoch == 0) {
+    memset(scratch->key_marks, 0, scratch->key_alloc * sizeof(uint32_t));
+    memset(scratch->perm_epochs, 0, scratch->perm_alloc * sizeof(uint32_t));
+    scratch->epoch = 1;
+  }
+}
+
+int authority_check_scratch(const authority_index *index, authority_scratch *scratch, const authority_key *keys, size_t key_count,
+                            const authority_level *levels, size_t level_count, uint8_t *satisfied)
+{
+  uint32_t id;
+  size_t i;
+  int res = 0, ok;
+
+  if (reserve_scratch(index, scratch) != 0) {
+    return -1;
+  }
+  next_epoch(scratch);
+  for (i = 0; i < key_count; i++) {
+    if (find_key(index, &keys[i], &id)) {
+      scratch->key_marks[id] = scratch->epoch;
+    }
+  }
+  for (i = 0; i < level_count; i++) {
+    ok = level_satisfied(index, scratch, &levels[i]);
+    if (satisfied != NULL) {
+      satisfied[i] = (uint8_t)ok;
+    }
+    if (!ok) {
+      res = 1;
+    }
+  }
+  return res;
+}
+
+int authority_check(authority_index *index, const authority_key *keys, size_t key_count,
+                    const authority_level *levels, size_t level_count, uint8_t *satisfied)
+{
+  return authority_check_scratch(index, index->scratch, keys, key_count, levels, level_count, satisfied);
+}
@@ -0,0 +1,82 @@
+//
+//  authority.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Index of account permissions for checking whether a set of recovered
+//  signing keys satisfies the authorizations (actor@permission) of a
+//  transaction.
+//
+//  Keys and permissions live in open addressing tables.  A check marks the
+//  provided keys once and then evaluates every authorization against the
+//  marks, memoizing each permission it visits, so a transaction with many
+//  actions is evaluated in one pass over its keys.  The marks live in an
+//  authority_scratch, so several threads can check against one index with
+//  a scratch each, as long as no thread modifies the index meanwhile.
+//
+
+#ifndef authority_h
+#define authority_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// nested account permissions are followed up to this depth
+#define AUTHORITY_MAX_DEPTH 6
+
+#define AUTHORITY_KEY_R1 0
+#define AUTHORITY_KEY_K1 1
+
+typedef struct {
+  uint8_t type;          // AUTHORITY_KEY_*
+  uint8_t data[33];      // compressed public key
+} authority_key;
+
+typedef struct {
+  uint64_t actor;
+  uint64_t permission;
+} authority_level;
+
+typedef struct {
+  authority_key key;
+  uint16_t weight;
+} authority_key_weight;
+
+typedef struct {
+  authority_level level;
+  uint16_t weight;
+} authority_level_weight;
+
+typedef struct authority_index authority_index;
+typedef struct authority_scratch authority_scratch;
+
+authority_index *authority_index_new(void);
+void authority_index_free(authority_index *index);
+
+// Inserts or replaces the permission level->permission of level->actor.
+// parent is the name of the parent permission of the same actor (0 for
+// owner), which also satisfies this permission.
+// returns 0 on success
+int authority_set_permission(authority_index *index, const authority_level *level, uint64_t parent, uint32_t threshold,
+                             const authority_key_weight *keys, size_t key_count,
+                             const authority_level_weight *accounts, size_t account_count);
+
+// returns 0 if the permission was removed, 1 if it did not exist
+int authority_remove_permission(authority_index *index, const authority_level *level);
+
+authority_scratch *authority_scratch_new(void);
+void authority_scratch_free(authority_scratch *scratch);
+
+// Checks every level in levels against the keys that signed the
+// transaction.  satisfied, if not NULL, receives 1 or 0 per level.
+// authority_check uses a scratch owned by the index and is therefore not
+// thread-safe.
+// returns 0 if all levels are satisfied, -1 if out of memory
+int authority_check(authority_index *index, const authority_key *keys, size_t key_count,
+                    const authority_level *levels, size_t level_count, uint8_t *satisfied);
+int authority_check_scratch(const authority_index *index, authority_scratch *scratch, const authority_key *keys, size_t key_count,
+                            const authority_level *levels, size_t level_count, uint8_t *satisfied);
+
+#endif /* authority_h */
@@ -8,8 +8,21 @@
 
 #include "base58.h"
 #include <string.h>
+#include <sys/types.h>
+#include "ripemd160.h"
+#include "memzero.h"
 
 static const char b58digits_ordered[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+static const int8_t b58digits_map[] = {
+  -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+  -1, 0, 1, 2, 3, 4, 5, 6,  7, 8,-1,-1,-1,-1,-1,-1,
+  -1, 9,10,11,12,13,14,15, 16,-1,17,18,19,20,21,-1,
+  22,23,24,25,26,27,28,29, 30,31,32,-1,-1,-1,-1,-1,
+  -1,33,34,35,36,37,38,39, 40,41,42,43,-1,44,45,46,
+  47,48,49,50,51,52,53,54, 55,56,57,-1,-1,-1,-1,-1,
+};
 
 bool b58enc(char *b58, size_t *b58sz, const void *data, size_t binsz)
 {
@@ -52,3 +65,140 @@ bool b58enc(char *b58, size_t *b58sz, const void *data, size_t binsz)
   
   return true;
 }
+
+bool b58encWithChecksum(char *b58, size_t *b58sz, const void *data, size_t binsz, const char *suffix)
+{
+  size_t suffixsz = suffix ? strlen(suffix) : 0;
+  uint8_t buf[binsz + suffixsz > binsz + 4 ? binsz + suffixsz : binsz + 4];
+  uint8_t hash[RIPEMD160_DIGEST_LENGTH];
+  bool result;
+  
+  memcpy(buf, data, binsz);
+  if (suffixsz) {
+    memcpy(buf + binsz, suffix, suffixsz);
+  }
+  ripemd160(buf, (uint32_t)(binsz + suffixsz), hash);
+  
+  // replace the suffix with the first 4 bytes of the hash as checksum
+  memcpy(buf + binsz, hash, 4);
+  result = b58enc(b58, b58sz, buf, binsz + 4);
+  
+  memzero(buf, sizeof(buf));
+  memzero(hash, sizeof(hash));
+  return result;
+}
+
+bool b58tobin(void *bin, size_t *binszp, const char *b58, size_t b58sz)
+{
+  size_t binsz = *binszp;
+  const unsigned char *b58u = (const unsigned char *)b58;
+  unsigned char *binu = bin;
+  size_t outisz = (binsz + 3) / 4;
+  uint32_t outi[outisz];
+  uint64_t t;
+  uint32_t c;
+  size_t i, j;
+  uint8_t bytesleft = binsz % 4;
+  uint32_t zeromask = bytesleft ? (0xffffffff << (bytesleft * 8)) : 0;
+  unsigned zerocount = 0;
+  
+  if (!b58sz)
+    b58sz = strlen(b58);
+  
+  memset(outi, 0, outisz * sizeof(*outi));
+  
+  // leading zeros, just count
+  for (i = 0; i < b58sz && b58u[i] == '1'; ++i)
+    ++zerocount;
+  
+  for ( ; i < b58sz; ++i)
+  {
+    if (b58u[i] & 0x80)
+      // high-bit set on invalid digit
+      return false;
+    if (b58digits_map[b58u[i]] == -1)
+      // invalid base58 digit
+      return false;
+    c = (unsigned)b58digits_map[b58u[i]];
+    for (j = outisz; j--; )
+    {
+      t = ((uint64_t)outi[j]) * 58 + c;
+      c = (t & 0x3f00000000) >> 32;
+      outi[j] = t & 0xffffffff;
+    }
+    if (c)
+      // output number too big (carry to the next int32)
+      return false;
+    if (outi[0] & zeromask)
+      // output number too big (last int32 filled too far)
+      return false;
+  }
+  
+  j = 0;
+  switch (bytesleft) {
+    case 3:
+      *(binu++) = (outi[0] & 0xff0000) >> 16;
+      //-fallthrough
+    case 2:
+      *(binu++) = (outi[0] & 0xff00) >> 8;
+      //-fallthrough
+    case 1:
+      *(binu++) = (outi[0] & 0xff);
+      ++j;
+      //-fallthrough
+    default:
+      break;
+  }
+  
+  for (; j < outisz; ++j)
+  {
+    *(binu++) = (outi[j] >> 0x18) & 0xff;
+    *(binu++) = (outi[j] >> 0x10) & 0xff;
+    *(binu++) = (outi[j] >> 8) & 0xff;
+    *(binu++) = (outi[j] >> 0) & 0xff;
+  }
+  
+  // count canonical base58 byte count
+  binu = bin;
+  for (i = 0; i < binsz; ++i)
+  {
+    if (binu[i]) {
+      if (zerocount > i) {
+        /* result too large */
+        return false;
+      }
+      break;
+    }
+    --*binszp;
+  }
+  *binszp += zerocount;
+  
+  return true;
+}
+
+bool b58decWithChecksum(void *data, size_t binsz, const char *b58, size_t b58sz, const char *suffix)
+{
+  size_t suffixsz = suffix ? strlen(suffix) : 0;
+  size_t size = binsz + 4;
+  uint8_t buf[binsz + (suffixsz > 4 ? suffixsz : 4)];
+  uint8_t hash[RIPEMD160_DIGEST_LENGTH], checksum[4];
+  bool result = false;
+  
+  // the encoding must decode to exactly binsz bytes plus the checksum
+  if (b58tobin(buf, &size, b58, b58sz) && size == binsz + 4) {
+    // the checksum covers data | suffix, see b58encWithChecksum
+    memcpy(checksum, buf + binsz, 4);
+    if (suffixsz) {
+      memcpy(buf + binsz, suffix, suffixsz);
+    }
+    ripemd160(buf, (uint32_t)(binsz + suffixsz), hash);
+    if (memcmp(checksum, hash, 4) == 0) {
+      memcpy(data, buf, binsz);
+      result = true;
+    }
+  }
+  
+  memzero(buf, sizeof(buf));
+  memzero(hash, sizeof(hash));
+  return result;
+}
@@ -11,8 +11,23 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 bool b58enc(char *b58, size_t *b58sz, const void *data, size_t binsz);
-bool b58encWithChecksum(char *b58, size_t *b58sz, const void *data, size_t binsz);
+// base58 encode data followed by the first 4 bytes of ripemd160(data | suffix).
+// suffix is the key type ("R1", "K1") and may be NULL for a plain checksum.
+bool b58encWithChecksum(char *b58, size_t *b58sz, const void *data, size_t binsz, const char *suffix);
+
+// decode b58sz characters of b58 (all of the string if b58sz is 0) into
+// the last bytes of bin, which holds *binszp bytes.  *binszp receives the
+// length of the decoded number including its leading zero bytes.
+bool b58tobin(void *bin, size_t *binszp, const char *b58, size_t b58sz);
+
+// decode b58sz characters of b58 (all of the string if b58sz is 0) into
+// binsz bytes of data followed by a 4 byte checksum, which is checked as
+// b58encWithChecksum computes it.
+// returns false if the encoding is not exactly binsz + 4 bytes or the
+// checksum does not match
+bool b58decWithChecksum(void *data, size_t binsz, const char *b58, size_t b58sz, const char *suffix);
 
 #endif /* base58_h */
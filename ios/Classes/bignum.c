@@ -69,73 +69,115 @@ inline void write_le(uint8_t *data, uint32_t x)
   data[0] = x;
 }
 
+// Conversions between 256 bit byte strings and bignums.  The bytes are
+// loaded as four 64 bit words, w[0] the least significant, so that every
+// limb is a shift and mask of at most two words instead of a byte by byte
+// assembly.  memcpy keeps the loads safe for unaligned input and compiles
+// to a plain load, plus a byte swap where the byte order differs.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BN_HOST_BIG_ENDIAN 1
+#else
+#define BN_HOST_BIG_ENDIAN 0
+#endif
+
+static inline uint64_t load64(const uint8_t *data, int big_endian)
+{
+  uint64_t x;
+  memcpy(&x, data, 8);
+  return big_endian == BN_HOST_BIG_ENDIAN ? x : __builtin_bswap64(x);
+}
+
+static inline void store64(uint8_t *data, uint64_t x, int big_endian)
+{
+  x = big_endian == BN_HOST_BIG_ENDIAN ? x : __builtin_bswap64(x);
+  memcpy(data, &x, 8);
+}
+
+static inline void words_to_bn(const uint64_t w[4], bignum256 *out_number)
+{
+  out_number->val[0] = w[0] & 0x3FFFFFFF;
+  out_number->val[1] = (w[0] >> 30) & 0x3FFFFFFF;
+  out_number->val[2] = ((w[0] >> 60) | (w[1] << 4)) & 0x3FFFFFFF;
+  out_number->val[3] = (w[1] >> 26) & 0x3FFFFFFF;
+  out_number->val[4] = ((w[1] >> 56) | (w[2] << 8)) & 0x3FFFFFFF;
+  out_number->val[5] = (w[2] >> 22) & 0x3FFFFFFF;
+  out_number->val[6] = ((w[2] >> 52) | (w[3] << 12)) & 0x3FFFFFFF;
+  out_number->val[7] = (w[3] >> 18) & 0x3FFFFFFF;
+  out_number->val[8] = w[3] >> 48;
+}
+
+// bits above 256 are dropped, the number must be fully reduced
+static inline void bn_to_words(const bignum256 *in_number, uint64_t w[4])
+{
+  const uint32_t *v = in_number->val;
+  w[0] = v[0] | ((uint64_t)v[1] << 30) | ((uint64_t)v[2] << 60);
+  w[1] = (v[2] >> 4) | ((uint64_t)v[3] << 26) | ((uint64_t)v[4] << 56);
+  w[2] = (v[4] >> 8) | ((uint64_t)v[5] << 22) | ((uint64_t)v[6] << 52);
+  w[3] = (v[6] >> 12) | ((uint64_t)v[7] << 18) | ((uint64_t)v[8] << 48);
+}
+
 // convert a raw bigendian 256 bit value into a normalized bignum.
 // out_number is partly reduced (since it fits in 256 bit).
 void bn_read_be(const uint8_t *in_number, bignum256 *out_number)
 {
-  int i;
-  uint32_t temp = 0;
-  for (i = 0; i < 8; i++) {
-    // invariant: temp = (in_number % 2^(32i)) >> 30i
-    // get next limb = (in_number % 2^(32(i+1))) >> 32i
-    uint32_t limb = read_be(in_number + (7 - i) * 4);
-    // temp = (in_number % 2^(32(i+1))) << 30i
-    temp |= limb << (2*i);
-    // store 30 bits into val[i]
-    out_number->val[i]= temp & 0x3FFFFFFF;
-    // prepare temp for next round
-    temp = limb >> (30 - 2*i);
-  }
-  out_number->val[8] = temp;
+  uint64_t w[4];
+  w[0] = load64(in_number + 24, 1);
+  w[1] = load64(in_number + 16, 1);
+  w[2] = load64(in_number + 8, 1);
+  w[3] = load64(in_number, 1);
+  words_to_bn(w, out_number);
 }
 
 // convert a normalized bignum to a raw bigendian 256 bit number.
 // in_number must be fully reduced.
 void bn_write_be(const bignum256 *in_number, uint8_t *out_number)
 {
-  int i;
-  uint32_t temp = in_number->val[8];
-  for (i = 0; i < 8; i++) {
-    // invariant: temp = (in_number >> 30*(8-i))
-    uint32_t limb = in_number->val[7 - i];
-    temp = (temp << (16 + 2*i)) | (limb >> (14 - 2*i));
-    write_be(out_number + i * 4, temp);
-    temp = limb;
-  }
+  uint64_t w[4];
+  bn_to_words(in_number, w);
+  store64(out_number, w[3], 1);
+  store64(out_number + 8, w[2], 1);
+  store64(out_number + 16, w[1], 1);
+  store64(out_number + 24, w[0], 1);
 }
 
 // convert a raw little endian 256 bit value into a normalized bignum.
 // out_number is partly reduced (since it fits in 256 bit).
 void bn_read_le(const uint8_t *in_number, bignum256 *out_number)
 {
-  int i;
-  uint32_t temp = 0;
-  for (i = 0; i < 8; i++) {
-    // invariant: temp = (in_number % 2^(32i)) >> 30i
-    // get next limb = (in_number % 2^(32(i+1))) >> 32i
-    uint32_t limb = read_le(in_number + i * 4);
-    // temp = (in_number % 2^(32(i+1))) << 30i
-    temp |= limb << (2*i);
-    // store 30 bits into val[i]
-    out_number->val[i]= temp & 0x3FFFFFFF;
-    // prepare temp for next round
-    temp = limb >> (30 - 2*i);
-  }
-  out_number->val[8] = temp;
+  uint64_t w[4];
+  w[0] = load64(in_number, 0);
+  w[1] = load64(in_number + 8, 0);
+  w[2] = load64(in_number + 16, 0);
+  w[3] = load64(in_number + 24, 0);
+  words_to_bn(w, out_number);
 }
 
 // convert a normalized bignum to a raw little endian 256 bit number.
 // in_number must be fully reduced.
 void bn_write_le(const bignum256 *in_number, uint8_t *out_number)
 {
-  int i;
-  uint32_t temp = in_number->val[8];
-  for (i = 0; i < 8; i++) {
-    // invariant: temp = (in_number >> 30*(8-i))
-    uint32_t limb = in_number->val[7 - i];
-    temp = (temp << (16 + 2*i)) | (limb >> (14 - 2*i));
-    write_le(out_number + (7 - i) * 4, temp);
-    temp = limb;
+  uint64_t w[4];
+  bn_to_words(in_number, w);
+  store64(out_number, w[0], 0);
+  store64(out_number + 8, w[1], 0);
+  store64(out_number + 16, w[2], 0);
+  store64(out_number + 24, w[3], 0);
+}
+
+void bn_read_be_batch(const uint8_t *in_numbers, size_t stride, bignum256 *out_numbers, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; i++) {
+    bn_read_be(in_numbers + stride * i, &out_numbers[i]);
+  }
+}
+
+void bn_write_be_batch(const bignum256 *in_numbers, uint8_t *out_numbers, size_t stride, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; i++) {
+    bn_write_be(&in_numbers[i], out_numbers + stride * i);
   }
 }
 
@@ -464,18 +506,106 @@ void bn_multiply_reduce(bignum256 *x, uint32_t res[18], const bignum256 *prime)
   }
 }
 
+// auxiliary function for multiplication modulo the secp256k1 prime.
+// folds the bits above 2^256 back into the lower 256 bits using
+//   2^256 = 2^32 + 977  (mod prime)
+// i.e. res = (res mod 2^256) + (res >> 256) * (2^32 + 977).
+// assumes    res normalized, res < 2^(30*len), 9 <= len <= 18
+// guarantees res normalized, res < 2^256 + 2^(30*len - 223)
+static void bn_multiply_fold_k1(uint32_t res[18], int len)
+{
+  uint32_t hi[10];
+  uint64_t temp = 0;
+  int j;
+  
+  // hi = res >> 256, i.e. bit 16 of limb 8 and up.
+  for (j = 0; j + 8 < len; j++) {
+    hi[j] = res[j + 8] >> 16;
+    if (j + 9 < len) {
+      hi[j] |= (res[j + 9] << 14) & 0x3FFFFFFF;
+    }
+  }
+  res[8] &= 0xFFFF;
+  for (j = 9; j < len; j++) {
+    res[j] = 0;
+  }
+  // res += hi * 977 + hi * 2^32,  where 2^32 = 4 * 2^30 is one limb up.
+  for (j = 0; j < len; j++) {
+    temp += res[j];
+    if (j + 8 < len) {
+      temp += 977 * (uint64_t)hi[j];
+    }
+    if (j > 0 && j + 7 < len) {
+      temp += (uint64_t)hi[j - 1] << 2;
+    }
+    res[j] = temp & 0x3FFFFFFF;
+    temp >>= 30;
+  }
+  assert(temp == 0);
+}
+
+// auxiliary function for multiplication.
+// reduces x = res modulo the secp256k1 prime with three folding steps,
+// which is much cheaper than the generic bn_multiply_reduce.
+// assumes    res normalized, res < 2^540
+// guarantees x partly reduced, in fact x < 2^256
+void bn_multiply_reduce_k1(bignum256 *x, uint32_t res[18], const bignum256 *prime)
+{
+  int i;
+  (void)prime;
+  bn_multiply_fold_k1(res, 18);
+  // res < 2^256 + 2^317, which fits in 11 limbs
+  bn_multiply_fold_k1(res, 11);
+  // res < 2^256 + 2^107, so either res < 2^256 already or
+  // res >> 256 is 1 and res mod 2^256 < 2^107.
+  bn_multiply_fold_k1(res, 9);
+  // res < 2^256
+  for (i = 0; i < 9; i++) {
+    x->val[i] = res[i];
+  }
+}
+
 // Compute x := k * x  (mod prime)
 // both inputs must be smaller than 180 * prime.
 // result is partly reduced (0 <= x < 2 * prime)
 // This only works for primes between 2^256-2^224 and 2^256.
 void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime)
+{
+  bn_multiply_with(k, x, prime, bn_multiply_reduce);
+}
+
+// bn_multiply with reduce, which must suit prime (see bn_reducer)
+void bn_multiply_with(const bignum256 *k, bignum256 *x, const bignum256 *prime, bn_reducer reduce)
 {
   uint32_t res[18] = {0};
   bn_multiply_long(k, x, res);
-  bn_multiply_reduce(x, res, prime);
+  reduce(x, res, prime);
   memzero(res, sizeof(res));
 }
 
+// Compute res := round(k * x / 2^shift)
+// k and x must be fully reduced, 256 <= shift < 510.
+// Used to split scalars for the curve endomorphism.
+void bn_multiply_shift(const bignum256 *k, const bignum256 *x, bignum256 *res, unsigned int shift)
+{
+  uint32_t prod[18] = {0};
+  unsigned int limb = shift / 30, bit = shift % 30, i;
+  uint32_t round;
+  
+  assert(shift >= 256 && shift < 510);
+  bn_multiply_long(k, x, prod);
+  // round to nearest by adding bit (shift - 1)
+  round = (prod[(shift - 1) / 30] >> ((shift - 1) % 30)) & 1;
+  for (i = 0; i < 9; i++) {
+    res->val[i] = limb + i < 18 ? prod[limb + i] >> bit : 0;
+    if (bit != 0 && limb + i + 1 < 18) {
+      res->val[i] |= (prod[limb + i + 1] << (30 - bit)) & 0x3FFFFFFF;
+    }
+  }
+  bn_addi(res, round);
+  memzero(prod, sizeof(prod));
+}
+
 // partly reduce x modulo prime
 // input x does not have to be normalized.
 // x can be any number that fits.
@@ -504,6 +634,12 @@ void bn_fast_mod(bignum256 *x, const bignum256 *prime)
 // assumes    x is normalized but not necessarily reduced.
 // guarantees x is reduced
 void bn_sqrt(bignum256 *x, const bignum256 *prime)
+{
+  bn_sqrt_with(x, prime, bn_multiply_reduce);
+}
+
+// bn_sqrt with the multiplications reduced by reduce
+void bn_sqrt_with(bignum256 *x, const bignum256 *prime, bn_reducer reduce)
 {
   // this method compute x^1/2 = x^(prime+1)/4
   uint32_t i, j, limb;
@@ -527,10 +663,10 @@ void bn_sqrt(bignum256 *x, const bignum256 *prime)
       //    limb = (p % 2^(i*30+30)) / 2^(i*30+j)
       if (i == 8 && limb == 0) break;
       if (limb & 1) {
-        bn_multiply(x, &res, prime);
+        bn_multiply_with(x, &res, prime, reduce);
       }
       limb >>= 1;
-      bn_multiply(x, x, prime);
+      bn_multiply_with(x, x, prime, reduce);
     }
   }
   bn_mod(&res, prime);
@@ -539,10 +675,76 @@ void bn_sqrt(bignum256 *x, const bignum256 *prime)
   memzero(&p, sizeof(p));
 }
 
+// Jacobi symbol (a/n) by the binary algorithm: factors of two are
+// removed from a with (2/n) = -1 iff n = 3, 5 mod 8, and a, n are
+// swapped with quadratic reciprocity whenever a < n.  Every step only
+// shifts and subtracts, so it is much cheaper than a square root.
+// a must be normalized and smaller than 2 * n, n must be odd.
+// Not constant time: only use with public data.
+// returns 1 or -1, or 0 if a and n have a common factor
+int bn_jacobi(const bignum256 *a, const bignum256 *n)
+{
+  bignum256 x, y, t;
+  int res = 1, len = 9, i;
+  uint32_t shift;
+  
+  x = *a;
+  y = *n;
+  bn_mod(&x, &y);
+  
+  while (len > 0) {
+    // x = x / 2^shift, flip the sign for odd shifts when y = 3, 5 mod 8
+    if (x.val[0] == 0) {
+      // x = 2^30 * x', 30 is even
+      for (i = 0; i < len - 1; i++) {
+        x.val[i] = x.val[i + 1];
+      }
+      x.val[len - 1] = 0;
+    } else {
+      shift = __builtin_ctz(x.val[0]);
+      if (shift > 0) {
+        for (i = 0; i < len - 1; i++) {
+          x.val[i] = (x.val[i] >> shift) | ((x.val[i + 1] << (30 - shift)) & 0x3FFFFFFF);
+        }
+        x.val[len - 1] >>= shift;
+        if ((shift & 1) && ((y.val[0] & 7) == 3 || (y.val[0] & 7) == 5)) {
+          res = -res;
+        }
+      }
+      // x is odd: (x/y) = (y/x), unless x = y = 3 mod 4
+      if (bn_is_less(&x, &y)) {
+        t = x;
+        x = y;
+        y = t;
+        if ((x.val[0] & 3) == 3 && (y.val[0] & 3) == 3) {
+          res = -res;
+        }
+      }
+      bn_subtract(&x, &y, &x);
+    }
+    while (len > 0 && x.val[len - 1] == 0 && y.val[len - 1] == 0) {
+      len--;
+    }
+    if (bn_is_zero(&x)) {
+      break;
+    }
+  }
+  
+  // gcd(a, n) = y
+  bn_one(&t);
+  return bn_is_equal(&y, &t) ? res : 0;
+}
+
 #if ! USE_INVERSE_FAST
 
 // in field G_prime, small but slow
 void bn_inverse(bignum256 *x, const bignum256 *prime)
+{
+  bn_inverse_with(x, prime, bn_multiply_reduce);
+}
+
+// bn_inverse with the multiplications reduced by reduce
+void bn_inverse_with(bignum256 *x, const bignum256 *prime, bn_reducer reduce)
 {
   // this method compute x^-1 = x^(prime-2)
   uint32_t i, j, limb;
@@ -564,10 +766,10 @@ void bn_inverse(bignum256 *x, const bignum256 *prime)
       // early abort when only zero bits follow
       if (i == 8 && limb == 0) break;
       if (limb & 1) {
-        bn_multiply(x, &res, prime);
+        bn_multiply_with(x, &res, prime, reduce);
       }
       limb >>= 1;
-      bn_multiply(x, x, prime);
+      bn_multiply_with(x, x, prime, reduce);
     }
   }
   bn_mod(&res, prime);
@@ -576,6 +778,13 @@ void bn_inverse(bignum256 *x, const bignum256 *prime)
 
 #else
 
+// the fast inversion does not multiply
+void bn_inverse_with(bignum256 *x, const bignum256 *prime, bn_reducer reduce)
+{
+  (void)reduce;
+  bn_inverse(x, prime);
+}
+
 // in field G_prime, big and complicated but fast
 // the input must not be 0 mod prime.
 // the result is smaller than prime
@@ -908,6 +1117,39 @@ void bn_subtractmod(const bignum256 *a, const bignum256 *b, bignum256 *res, cons
   }
 }
 
+// res = a - b mod prime.  More exactly res = a + k*prime - b.
+// b must be normalized and smaller than k * prime, k <= 16.
+// result is normalized but not reduced, smaller than a + k * prime.
+void bn_subtractmod_k(const bignum256 *a, const bignum256 *b, bignum256 *res, const bignum256 *prime, uint32_t k)
+{
+  int i;
+  uint64_t temp = 1;
+  assert(k <= 16);
+  for (i = 0; i < 9; i++) {
+    temp += 0x3FFFFFFFull + a->val[i] + (uint64_t)k * prime->val[i] - b->val[i];
+    res->val[i] = temp & 0x3FFFFFFF;
+    temp >>= 30;
+  }
+}
+
+#ifndef NDEBUG
+void bn_assert_bound(const bignum256 *x, uint32_t k, const bignum256 *prime)
+{
+  bignum256 kp;
+  uint64_t temp = 0;
+  int i;
+  
+  for (i = 0; i < 9; i++) {
+    assert(x->val[i] <= 0x3FFFFFFF);
+    temp += (uint64_t)k * prime->val[i];
+    kp.val[i] = temp & 0x3FFFFFFF;
+    temp >>= 30;
+  }
+  assert(temp == 0);
+  assert(bn_is_less(x, &kp));
+}
+#endif
+
 // res = a - b ; a > b
 void bn_subtract(const bignum256 *a, const bignum256 *b, bignum256 *res)
 {
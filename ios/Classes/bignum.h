@@ -40,6 +40,12 @@ void bn_read_le(const uint8_t *in_number, bignum256 *out_number);
 
 void bn_write_le(const bignum256 *in_number, uint8_t *out_number);
 
+// bn_read_be and bn_write_be of n numbers stored stride bytes apart, e.g.
+// stride 64 for the r or the s halves of an array of signatures
+void bn_read_be_batch(const uint8_t *in_numbers, size_t stride, bignum256 *out_numbers, size_t n);
+
+void bn_write_be_batch(const bignum256 *in_numbers, uint8_t *out_numbers, size_t stride, size_t n);
+
 void bn_read_uint32(uint32_t in_number, bignum256 *out_number);
 
 void bn_read_uint64(uint64_t in_number, bignum256 *out_number);
@@ -107,13 +113,30 @@ void bn_mult_k(bignum256 *x, uint8_t k, const bignum256 *prime);
 
 void bn_mod(bignum256 *x, const bignum256 *prime);
 
+// Reduces the 18 limb product res of two numbers modulo prime into x,
+// x < 2 * prime.  A curve picks the reducer of its field prime once, see
+// ecdsa_curve.reduce, instead of bn_multiply testing the prime every time.
+typedef void (*bn_reducer)(bignum256 *x, uint32_t res[18], const bignum256 *prime);
+
+// for any prime between 2^256 - 2^224 and 2^256
+void bn_multiply_reduce(bignum256 *x, uint32_t res[18], const bignum256 *prime);
+// for the secp256k1 field prime 2^256 - 2^32 - 977 only, prime is ignored
+void bn_multiply_reduce_k1(bignum256 *x, uint32_t res[18], const bignum256 *prime);
+
 void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime);
+void bn_multiply_with(const bignum256 *k, bignum256 *x, const bignum256 *prime, bn_reducer reduce);
+
+void bn_multiply_shift(const bignum256 *k, const bignum256 *x, bignum256 *res, unsigned int shift);
 
 void bn_fast_mod(bignum256 *x, const bignum256 *prime);
 
 void bn_sqrt(bignum256 *x, const bignum256 *prime);
+void bn_sqrt_with(bignum256 *x, const bignum256 *prime, bn_reducer reduce);
+
+int bn_jacobi(const bignum256 *a, const bignum256 *n);
 
 void bn_inverse(bignum256 *x, const bignum256 *prime);
+void bn_inverse_with(bignum256 *x, const bignum256 *prime, bn_reducer reduce);
 
 void bn_normalize(bignum256 *a);
 
@@ -129,6 +152,19 @@ void bn_subtractmod(const bignum256 *a, const bignum256 *b, bignum256 *res, cons
 
 void bn_subtract(const bignum256 *a, const bignum256 *b, bignum256 *res);
 
+void bn_subtractmod_k(const bignum256 *a, const bignum256 *b, bignum256 *res, const bignum256 *prime, uint32_t k);
+
+// Bound annotations for field elements: BN_BOUND(x, k, prime) states that
+// x is normalized and x < k * prime.  Debug builds check the annotation,
+// release builds drop it, so formulas can skip reductions wherever the
+// annotated bounds show the next operation accepts the larger value.
+#ifndef NDEBUG
+void bn_assert_bound(const bignum256 *x, uint32_t k, const bignum256 *prime);
+#define BN_BOUND(x, k, prime) bn_assert_bound((x), (k), (prime))
+#else
+#define BN_BOUND(x, k, prime) ((void)0)
+#endif
+
 void bn_divmod58(bignum256 *a, uint32_t *r);
 
 void bn_divmod1000(bignum256 *a, uint32_t *r);
@@ -8,12 +8,24 @@
 
 #include "ecdsa.h"
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "rand.h"
+#include "rfc6979.h"
 #include "memzero.h"
+#include "secmem.h"
 
 #define SIGNATURE_SIZE_IN_ASN1 64
 
+// x := k * x modulo the field prime of curve, with the reduction the curve
+// chose for its prime
+static inline void field_multiply(const bignum256 *k, bignum256 *x, const ecdsa_curve *curve)
+{
+  bn_multiply_with(k, x, &curve->prime, curve->reduce);
+}
+
 // Set cp2 = cp1
 void point_copy(const curve_point *cp1, curve_point *cp2)
 {
@@ -42,13 +54,13 @@ void point_add(const ecdsa_curve *curve, const curve_point *cp1, curve_point *cp
   }
   
   bn_subtractmod(&(cp2->x), &(cp1->x), &inv, &curve->prime);
-  bn_inverse(&inv, &curve->prime);
+  bn_inverse_with(&inv, &curve->prime, curve->reduce);
   bn_subtractmod(&(cp2->y), &(cp1->y), &lambda, &curve->prime);
-  bn_multiply(&inv, &lambda, &curve->prime);
+  field_multiply(&inv, &lambda, curve);
   
   // xr = lambda^2 - x1 - x2
   xr = lambda;
-  bn_multiply(&xr, &xr, &curve->prime);
+  field_multiply(&xr, &xr, curve);
   yr = cp1->x;
   bn_addmod(&yr, &(cp2->x), &curve->prime);
   bn_subtractmod(&xr, &yr, &xr, &curve->prime);
@@ -57,7 +69,7 @@ void point_add(const ecdsa_curve *curve, const curve_point *cp1, curve_point *cp
   
   // yr = lambda (x1 - xr) - y1
   bn_subtractmod(&(cp1->x), &xr, &yr, &curve->prime);
-  bn_multiply(&lambda, &yr, &curve->prime);
+  field_multiply(&lambda, &yr, curve);
   bn_subtractmod(&yr, &(cp1->y), &yr, &curve->prime);
   bn_fast_mod(&yr, &curve->prime);
   bn_mod(&yr, &curve->prime);
@@ -82,17 +94,17 @@ void point_double(const ecdsa_curve *curve, curve_point *cp)
   // lambda = (3 x^2 + a) / (2 y)
   lambda = cp->y;
   bn_mult_k(&lambda, 2, &curve->prime);
-  bn_inverse(&lambda, &curve->prime);
+  bn_inverse_with(&lambda, &curve->prime, curve->reduce);
   
   xr = cp->x;
-  bn_multiply(&xr, &xr, &curve->prime);
+  field_multiply(&xr, &xr, curve);
   bn_mult_k(&xr, 3, &curve->prime);
   bn_subi(&xr, -curve->a, &curve->prime);
-  bn_multiply(&xr, &lambda, &curve->prime);
+  field_multiply(&xr, &lambda, curve);
   
   // xr = lambda^2 - 2*x
   xr = lambda;
-  bn_multiply(&xr, &xr, &curve->prime);
+  field_multiply(&xr, &xr, curve);
   yr = cp->x;
   bn_lshift(&yr);
   bn_subtractmod(&xr, &yr, &xr, &curve->prime);
@@ -101,7 +113,7 @@ void point_double(const ecdsa_curve *curve, curve_point *cp)
   
   // yr = lambda (x - xr) - y
   bn_subtractmod(&(cp->x), &xr, &yr, &curve->prime);
-  bn_multiply(&lambda, &yr, &curve->prime);
+  field_multiply(&lambda, &yr, curve);
   bn_subtractmod(&yr, &(cp->y), &yr, &curve->prime);
   bn_fast_mod(&yr, &curve->prime);
   bn_mod(&yr, &curve->prime);
@@ -164,9 +176,8 @@ void conditional_negate(uint32_t cond, bignum256 *a, const bignum256 *prime)
   assert(a->val[8] < 0x20000);
 }
 
-typedef struct jacobian_curve_point {
-  bignum256 x, y, z;
-} jacobian_curve_point;
+// largest multiple of prime a jacobian x coordinate may reach
+#define JACOBIAN_X_BOUND 6
 
 // generate random K for signing/side-channel noise
 static void generate_k_random(bignum256 *k, const bignum256 *prime) {
@@ -180,47 +191,83 @@ static void generate_k_random(bignum256 *k, const bignum256 *prime) {
   } while (bn_is_zero(k) || !bn_is_less(k, prime));
 }
 
-void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp, const bignum256 *prime) {
+void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp, const ecdsa_curve *curve) {
+  const bignum256 *prime = &curve->prime;
+  
   // randomize z coordinate
   generate_k_random(&jp->z, prime);
   
   jp->x = jp->z;
-  bn_multiply(&jp->z, &jp->x, prime);
+  field_multiply(&jp->z, &jp->x, curve);
   // x = z^2
   jp->y = jp->x;
-  bn_multiply(&jp->z, &jp->y, prime);
+  field_multiply(&jp->z, &jp->y, curve);
   // y = z^3
   
-  bn_multiply(&p->x, &jp->x, prime);
-  bn_multiply(&p->y, &jp->y, prime);
+  field_multiply(&p->x, &jp->x, curve);
+  field_multiply(&p->y, &jp->y, curve);
 }
 
-void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p, const bignum256 *prime) {
+void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p, const ecdsa_curve *curve) {
+  const bignum256 *prime = &curve->prime;
+  
   p->y = jp->z;
-  bn_inverse(&p->y, prime);
+  bn_inverse_with(&p->y, &curve->prime, curve->reduce);
   // p->y = z^-1
   p->x = p->y;
-  bn_multiply(&p->x, &p->x, prime);
+  field_multiply(&p->x, &p->x, curve);
   // p->x = z^-2
-  bn_multiply(&p->x, &p->y, prime);
+  field_multiply(&p->x, &p->y, curve);
   // p->y = z^-3
-  bn_multiply(&jp->x, &p->x, prime);
+  field_multiply(&jp->x, &p->x, curve);
   // p->x = jp->x * z^-2
-  bn_multiply(&jp->y, &p->y, prime);
+  field_multiply(&jp->y, &p->y, curve);
   // p->y = jp->y * z^-3
   bn_mod(&p->x, prime);
   bn_mod(&p->y, prime);
 }
 
+// m = 3 x^2 + a z^4, the numerator of the tangent slope in jacobian
+// coordinates, given zsq = z^2.
+// The curves we support have a = 0 or a = -3 and both have a cheaper form
+// than the generic formula, saving one or two multiplications per doubling:
+//   a =  0:  m = 3 x^2
+//   a = -3:  m = 3 (x - z^2)(x + z^2)
+// x must be smaller than 6 * prime and zsq smaller than 2 * prime.
+// result is normalized and smaller than 4 * prime.
+static inline void jacobian_tangent(const bignum256 *x, const bignum256 *zsq, bignum256 *m, const ecdsa_curve *curve)
+{
+  const bignum256 *prime = &curve->prime;
+  bignum256 t;
+  
+  if (curve->a == -3) {
+    bn_subtractmod(x, zsq, m, prime);  // m = x - z^2
+    t = *x;
+    bn_add(&t, zsq);                   // t = x + z^2
+    field_multiply(&t, m, curve);
+    bn_mult_k(m, 3, prime);
+    return;
+  }
+  
+  *m = *x;
+  field_multiply(m, m, curve);
+  bn_mult_k(m, 3, prime);              // m = 3 x^2
+  if (curve->a != 0) {
+    t = *zsq;
+    field_multiply(&t, &t, curve);
+    bn_mult_k(&t, -curve->a, prime);   // t = -a z^4
+    bn_subtractmod(m, &t, m, prime);
+  }
+}
+
 void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const ecdsa_curve *curve) {
   bignum256 r, h, r2;
   bignum256 hcby, hsqx;
-  bignum256 xz, yz, az;
+  bignum256 xz, yz;
   int is_doubling;
   const bignum256 *prime = &curve->prime;
-  int a = curve->a;
   
-  assert (-3 <= a && a <= 0);
+  assert (-3 <= curve->a && curve->a <= 0);
   
   /* First we bring p1 to the same denominator:
    * x1' := x1 * z2^2
@@ -254,85 +301,81 @@ void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const e
    * z3 = h*z2
    */
   
+  BN_BOUND(&p2->x, JACOBIAN_X_BOUND, prime);
+  BN_BOUND(&p2->y, 2, prime);
+  BN_BOUND(&p2->z, 2, prime);
+  
   xz = p2->z;
-  bn_multiply(&xz, &xz, prime); // xz = z2^2
+  field_multiply(&xz, &xz, curve); // xz = z2^2
   yz = p2->z;
-  bn_multiply(&xz, &yz, prime); // yz = z2^3
+  field_multiply(&xz, &yz, curve); // yz = z2^3
   
-  if (a != 0) {
-    az  = xz;
-    bn_multiply(&az, &az, prime);   // az = z2^4
-    bn_mult_k(&az, -a, prime);      // az = -az2^4
-  }
+  // r2 = 3 x2^2 + a z2^4, used for r in case of doubling
+  jacobian_tangent(&p2->x, &xz, &r2, curve);
   
-  bn_multiply(&p1->x, &xz, prime);        // xz = x1' = x1*z2^2;
-  h = xz;
-  bn_subtractmod(&h, &p2->x, &h, prime);
+  field_multiply(&p1->x, &xz, curve);        // xz = x1' = x1*z2^2;
+  bn_subtractmod_k(&xz, &p2->x, &h, prime, JACOBIAN_X_BOUND);
   bn_fast_mod(&h, prime);
   // h = x1' - x2;
   
   bn_add(&xz, &p2->x);
+  BN_BOUND(&xz, 8, prime);
   // xz = x1' + x2
   
   // check for h == 0 % prime.  Note that h never normalizes to
-  // zero, since h = x1' + 2*prime - x2 > 0 and a positive
+  // zero, since h = x1' + 6*prime - x2 > 0 and a positive
   // multiple of prime is always normalized to prime by
   // bn_fast_mod.
   is_doubling = bn_is_equal(&h, prime);
   
-  bn_multiply(&p1->y, &yz, prime);        // yz = y1' = y1*z2^3;
+  field_multiply(&p1->y, &yz, curve);        // yz = y1' = y1*z2^3;
   bn_subtractmod(&yz, &p2->y, &r, prime);
   // r = y1' - y2;
   
   bn_add(&yz, &p2->y);
+  BN_BOUND(&yz, 4, prime);
   // yz = y1' + y2
   
-  r2 = p2->x;
-  bn_multiply(&r2, &r2, prime);
-  bn_mult_k(&r2, 3, prime);
-  
-  if (a != 0) {
-    // subtract -a z2^4, i.e, add a z2^4
-    bn_subtractmod(&r2, &az, &r2, prime);
-  }
   bn_cmov(&r, is_doubling, &r2, &r);
   bn_cmov(&h, is_doubling, &yz, &h);
   
   
   // hsqx = h^2
   hsqx = h;
-  bn_multiply(&hsqx, &hsqx, prime);
+  field_multiply(&hsqx, &hsqx, curve);
   
   // hcby = h^3
   hcby = h;
-  bn_multiply(&hsqx, &hcby, prime);
+  field_multiply(&hsqx, &hcby, curve);
   
   // hsqx = h^2 * (x1 + x2)
-  bn_multiply(&xz, &hsqx, prime);
+  field_multiply(&xz, &hsqx, curve);
   
   // hcby = h^3 * (y1 + y2)
-  bn_multiply(&yz, &hcby, prime);
+  field_multiply(&yz, &hcby, curve);
   
   // z3 = h*z2
-  bn_multiply(&h, &p2->z, prime);
+  field_multiply(&h, &p2->z, curve);
   
-  // x3 = r^2 - h^2 (x1 + x2)
+  // x3 = r^2 - h^2 (x1 + x2), left unreduced
   p2->x = r;
-  bn_multiply(&p2->x, &p2->x, prime);
+  field_multiply(&p2->x, &p2->x, curve);
   bn_subtractmod(&p2->x, &hsqx, &p2->x, prime);
-  bn_fast_mod(&p2->x, prime);
+  BN_BOUND(&p2->x, 4, prime);
   
   // y3 = 1/2 (r*(h^2 (x1 + x2) - 2x3) - h^3 (y1 + y2))
-  bn_subtractmod(&hsqx, &p2->x, &p2->y, prime);
-  bn_subtractmod(&p2->y, &p2->x, &p2->y, prime);
-  bn_multiply(&r, &p2->y, prime);
+  bn_subtractmod_k(&hsqx, &p2->x, &p2->y, prime, 4);
+  bn_subtractmod_k(&p2->y, &p2->x, &p2->y, prime, 4);
+  BN_BOUND(&p2->y, 10, prime);
+  field_multiply(&r, &p2->y, curve);
   bn_subtractmod(&p2->y, &hcby, &p2->y, prime);
   bn_mult_half(&p2->y, prime);
   bn_fast_mod(&p2->y, prime);
+  BN_BOUND(&p2->y, 2, prime);
 }
 
 void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
-  bignum256 az4, m, msq, ysq, xysq;
+  bignum256 zsq, m, msq, ysq, xysq;
   const bignum256 *prime = &curve->prime;
   
   assert (-3 <= curve->a && curve->a <= 0);
@@ -360,47 +403,45 @@ void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
    * z3 = y*z
    */
   
-  m = p->x;
-  bn_multiply(&m, &m, prime);
-  bn_mult_k(&m, 3, prime);
+  BN_BOUND(&p->x, JACOBIAN_X_BOUND, prime);
+  BN_BOUND(&p->y, 2, prime);
+  BN_BOUND(&p->z, 2, prime);
   
-  az4 = p->z;
-  bn_multiply(&az4, &az4, prime);
-  bn_multiply(&az4, &az4, prime);
-  bn_mult_k(&az4, -curve->a, prime);
-  bn_subtractmod(&m, &az4, &m, prime);
+  zsq = p->z;
+  field_multiply(&zsq, &zsq, curve);
+  jacobian_tangent(&p->x, &zsq, &m, curve);
   bn_mult_half(&m, prime);
   
   // msq = m^2
   msq = m;
-  bn_multiply(&msq, &msq, prime);
+  field_multiply(&msq, &msq, curve);
   // ysq = y^2
   ysq = p->y;
-  bn_multiply(&ysq, &ysq, prime);
+  field_multiply(&ysq, &ysq, curve);
   // xysq = xy^2
   xysq = p->x;
-  bn_multiply(&ysq, &xysq, prime);
+  field_multiply(&ysq, &xysq, curve);
   
   // z3 = yz
-  bn_multiply(&p->y, &p->z, prime);
+  field_multiply(&p->y, &p->z, curve);
   
-  // x3 = m^2 - 2*xy^2
-  p->x = xysq;
-  bn_lshift(&p->x);
-  bn_fast_mod(&p->x, prime);
-  bn_subtractmod(&msq, &p->x, &p->x, prime);
-  bn_fast_mod(&p->x, prime);
+  // x3 = m^2 - 2*xy^2, left unreduced
+  bn_subtractmod(&msq, &xysq, &p->x, prime);
+  bn_subtractmod(&p->x, &xysq, &p->x, prime);
+  BN_BOUND(&p->x, JACOBIAN_X_BOUND, prime);
   
   // y3 = m*(xy^2 - x3) - y^4
-  bn_subtractmod(&xysq, &p->x, &p->y, prime);
-  bn_multiply(&m, &p->y, prime);
-  bn_multiply(&ysq, &ysq, prime);
+  bn_subtractmod_k(&xysq, &p->x, &p->y, prime, JACOBIAN_X_BOUND);
+  field_multiply(&m, &p->y, curve);
+  field_multiply(&ysq, &ysq, curve);
   bn_subtractmod(&p->y, &ysq, &p->y, prime);
   bn_fast_mod(&p->y, prime);
+  BN_BOUND(&p->y, 2, prime);
 }
 
-// res = k * p
-void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res)
+// jres = k * p in jacobian coordinates
+// returns 1 if k is zero (jres is not set), 0 otherwise
+static int point_multiply_jacobian(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, jacobian_curve_point *jres)
 {
   // this algorithm is loosely based on
   //  Katsuyuki Okeya and Tsuyoshi Takagi, The Width-w NAF Method Provides
@@ -409,13 +450,12 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
   assert (bn_is_less(k, &curve->order));
   
   int i, j;
-  static CONFIDENTIAL bignum256 a;
+  CONFIDENTIAL bignum256 a;
   uint32_t *aptr;
   uint32_t abits;
   int ashift;
   uint32_t is_even = (k->val[0] & 1) - 1;
   uint32_t bits, sign, nsign;
-  static CONFIDENTIAL jacobian_curve_point jres;
   curve_point pmult[8];
   const bignum256 *prime = &curve->prime;
   
@@ -437,8 +477,7 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
   
   // special case 0*p:  just return zero. We don't care about constant time.
   if (!is_non_zero) {
-    point_set_infinity(res);
-    return;
+    return 1;
   }
   
   // Now a = k + 2^256 (mod curve->order) and a is odd.
@@ -479,16 +518,16 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
   sign = (bits >> 4) - 1;
   bits ^= sign;
   bits &= 15;
-  curve_to_jacobian(&pmult[bits>>1], &jres, prime);
+  curve_to_jacobian(&pmult[bits>>1], jres, curve);
   for (i = 62; i >= 0; i--) {
     // sign = sign(a[i+1])  (0xffffffff for negative, 0 for positive)
     // invariant jres = (-1)^sign sum_{j=i+1..63} (a[j] * 16^{j-i-1} * p)
     // abits >> (ashift - 4) = lowbits(a >> (i*4))
     
-    point_jacobian_double(&jres, curve);
-    point_jacobian_double(&jres, curve);
-    point_jacobian_double(&jres, curve);
-    point_jacobian_double(&jres, curve);
+    point_jacobian_double(jres, curve);
+    point_jacobian_double(jres, curve);
+    point_jacobian_double(jres, curve);
+    point_jacobian_double(jres, curve);
     
     // get lowest 5 bits of a >> (i*4).
     ashift -= 4;
@@ -509,36 +548,53 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
     
     // negate last result to make signs of this round and the
     // last round equal.
-    conditional_negate(sign ^ nsign, &jres.z, prime);
+    conditional_negate(sign ^ nsign, &jres->z, prime);
     
     // add odd factor
-    point_jacobian_add(&pmult[bits >> 1], &jres, curve);
+    point_jacobian_add(&pmult[bits >> 1], jres, curve);
     sign = nsign;
   }
-  conditional_negate(sign, &jres.z, prime);
-  jacobian_to_curve(&jres, res, prime);
+  conditional_negate(sign, &jres->z, prime);
   memzero(&a, sizeof(a));
-  memzero(&jres, sizeof(jres));
+  return 0;
 }
 
-#if USE_PRECOMPUTED_CP
+// res = k * p
+void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res)
+{
+  CONFIDENTIAL jacobian_curve_point jres;
+  
+  if (point_multiply_jacobian(curve, k, p, &jres) != 0) {
+    point_set_infinity(res);
+    return;
+  }
+  jacobian_to_curve(&jres, res, curve);
+  memzero(&jres, sizeof(jres));
+}
 
-// res = k * G
+// res = k * P using a comb table cp of P with the given window, i.e.
+// cp[i * 2^(window-1) + j] = (2j+1) * 2^(window*i) * P for
+// i < ceil(256/window).
 // k must be a normalized number with 0 <= k < curve->order
-void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res)
+// The result is left in jacobian coordinates in jres.
+// returns 1 if k is zero (jres is not set), 0 otherwise
+static int comb_multiply_jacobian(const ecdsa_curve *curve, const curve_point *cp, unsigned int window, const bignum256 *k, jacobian_curve_point *jres)
 {
   assert (bn_is_less(k, &curve->order));
+  assert (2 <= window && window <= 8);
   
   int i, j;
-  static CONFIDENTIAL bignum256 a;
+  CONFIDENTIAL bignum256 a;
   uint32_t is_even = (k->val[0] & 1) - 1;
   uint32_t lowbits;
-  static CONFIDENTIAL jacobian_curve_point jres;
   const bignum256 *prime = &curve->prime;
+  const int rows = (256 + window - 1) / window;
+  const int cols = 1 << (window - 1);
+  const uint32_t mask = (1 << window) - 1;
   
   // is_even = 0xffffffff if k is even, 0 otherwise.
   
-  // add 2^256.
+  // add 2^(window*rows) (2^256 for the usual window 4).
   // make number odd: subtract curve->order if even
   uint32_t tmp = 1;
   uint32_t is_non_zero = 0;
@@ -549,66 +605,85 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
     tmp >>= 30;
   }
   is_non_zero |= k->val[j];
-  a.val[j] = tmp + 0xffff + k->val[j] - (curve->order.val[j] & is_even);
+  a.val[j] = tmp + (1 << (window * rows - 240)) - 1 + k->val[j] - (curve->order.val[j] & is_even);
   assert((a.val[0] & 1) != 0);
   
   // special case 0*G:  just return zero. We don't care about constant time.
   if (!is_non_zero) {
-    point_set_infinity(res);
-    return;
+    return 1;
   }
   
-  // Now a = k + 2^256 (mod curve->order) and a is odd.
+  // Now a = k + 2^(window*rows) (mod curve->order) and a is odd.
+  // With w = window and n = rows:
   //
   // The idea is to bring the new a into the form.
-  // sum_{i=0..64} a[i] 16^i,  where |a[i]| < 16 and a[i] is odd.
+  // sum_{i=0..n} a[i] 2^(w*i),  where |a[i]| < 2^w and a[i] is odd.
   // a[0] is odd, since a is odd.  If a[i] would be even, we can
-  // add 1 to it and subtract 16 from a[i-1].  Afterwards,
-  // a[64] = 1, which is the 2^256 that we added before.
+  // add 1 to it and subtract 2^w from a[i-1].  Afterwards,
+  // a[n] = 1, which is the 2^(w*n) that we added before.
   //
-  // Since k = a - 2^256 (mod curve->order), we can compute
-  //   k*G = sum_{i=0..63} a[i] 16^i * G
+  // Since k = a - 2^(w*n) (mod curve->order), we can compute
+  //   k*P = sum_{i=0..n-1} a[i] 2^(w*i) * P
   //
-  // We have a big table curve->cp that stores all possible
-  // values of |a[i]| 16^i * G.
-  // curve->cp[i][j] = (2*j+1) * 16^i * G
+  // The table cp stores all possible values of |a[i]| 2^(w*i) * P.
   
-  // now compute  res = sum_{i=0..63} a[i] * 16^i * G step by step.
-  // initial res = |a[0]| * G.  Note that a[0] = a & 0xf if (a&0x10) != 0
-  // and - (16 - (a & 0xf)) otherwise.   We can compute this as
-  //   ((a ^ (((a >> 4) & 1) - 1)) & 0xf) >> 1
+  // now compute  res = sum_{i=0..n-1} a[i] * 2^(w*i) * P step by step.
+  // initial res = |a[0]| * P.  Note that a[0] = a & mask if (a >> w) & 1
+  // and - (2^w - (a & mask)) otherwise.   We can compute this as
+  //   ((a ^ (((a >> w) & 1) - 1)) & mask) >> 1
   // since a is odd.
-  lowbits = a.val[0] & ((1 << 5) - 1);
-  lowbits ^= (lowbits >> 4) - 1;
-  lowbits &= 15;
-  curve_to_jacobian(&curve->cp[0][lowbits >> 1], &jres, prime);
-  for (i = 1; i < 64; i ++) {
-    // invariant res = sign(a[i-1]) sum_{j=0..i-1} (a[j] * 16^j * G)
+  lowbits = a.val[0] & ((mask << 1) | 1);
+  lowbits ^= (lowbits >> window) - 1;
+  lowbits &= mask;
+  curve_to_jacobian(&cp[lowbits >> 1], jres, curve);
+  for (i = 1; i < rows; i ++) {
+    // invariant res = sign(a[i-1]) sum_{j=0..i-1} (a[j] * 2^(w*j) * P)
     
-    // shift a by 4 places.
+    // shift a by w places.
     for (j = 0; j < 8; j++) {
-      a.val[j] = (a.val[j] >> 4) | ((a.val[j + 1] & 0xf) << 26);
+      a.val[j] = (a.val[j] >> window) | ((a.val[j + 1] & mask) << (30 - window));
     }
-    a.val[j] >>= 4;
-    // a = old(a)>>(4*i)
+    a.val[j] >>= window;
+    // a = old(a)>>(w*i)
     // a is even iff sign(a[i-1]) = -1
     
-    lowbits = a.val[0] & ((1 << 5) - 1);
-    lowbits ^= (lowbits >> 4) - 1;
-    lowbits &= 15;
+    lowbits = a.val[0] & ((mask << 1) | 1);
+    lowbits ^= (lowbits >> window) - 1;
+    lowbits &= mask;
     // negate last result to make signs of this round and the
     // last round equal.
-    conditional_negate((lowbits & 1) - 1, &jres.y, prime);
+    conditional_negate((lowbits & 1) - 1, &jres->y, prime);
     
     // add odd factor
-    point_jacobian_add(&curve->cp[i][lowbits >> 1], &jres, curve);
+    point_jacobian_add(&cp[i * cols + (lowbits >> 1)], jres, curve);
   }
-  conditional_negate(((a.val[0] >> 4) & 1) - 1, &jres.y, prime);
-  jacobian_to_curve(&jres, res, prime);
+  conditional_negate(((a.val[0] >> window) & 1) - 1, &jres->y, prime);
   memzero(&a, sizeof(a));
+  return 0;
+}
+
+// res = k * P using the comb table cp of P, see comb_multiply_jacobian
+void comb_multiply(const ecdsa_curve *curve, const curve_point *cp, unsigned int window, const bignum256 *k, curve_point *res)
+{
+  CONFIDENTIAL jacobian_curve_point jres;
+  
+  if (comb_multiply_jacobian(curve, cp, window, k, &jres) != 0) {
+    point_set_infinity(res);
+    return;
+  }
+  jacobian_to_curve(&jres, res, curve);
   memzero(&jres, sizeof(jres));
 }
 
+#if USE_PRECOMPUTED_CP
+
+// res = k * G
+// k must be a normalized number with 0 <= k < curve->order
+void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res)
+{
+  comb_multiply(curve, &curve->cp[0][0], 4, k, res);
+}
+
 #else
 
 void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res)
@@ -618,18 +693,266 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 
 #endif
 
-void uncompress_coords(const ecdsa_curve *curve, uint8_t odd, const bignum256 *x, bignum256 *y)
+// convert n jacobian points to affine coordinates with a single inversion
+// (Montgomery's trick).  The z coordinates must not be zero modulo prime.
+// jp and p must not overlap.
+static void jacobian_to_curve_batch(const jacobian_curve_point *jp, curve_point *p, int n, const ecdsa_curve *curve)
+{
+  const bignum256 *prime = &curve->prime;
+  bignum256 inv, zinv, zinv2;
+  int i;
+  
+  // p[i].x = z_0 * ... * z_i
+  p[0].x = jp[0].z;
+  for (i = 1; i < n; i++) {
+    p[i].x = p[i - 1].x;
+    field_multiply(&jp[i].z, &p[i].x, curve);
+  }
+  inv = p[n - 1].x;
+  bn_inverse_with(&inv, &curve->prime, curve->reduce);
+  for (i = n - 1; i >= 0; i--) {
+    // inv = (z_0 * ... * z_i)^-1
+    if (i > 0) {
+      zinv = p[i - 1].x;
+      field_multiply(&inv, &zinv, curve);
+      field_multiply(&jp[i].z, &inv, curve);
+    } else {
+      zinv = inv;
+    }
+    // zinv = z_i^-1
+    zinv2 = zinv;
+    field_multiply(&zinv, &zinv2, curve);
+    p[i].x = jp[i].x;
+    field_multiply(&zinv2, &p[i].x, curve);
+    field_multiply(&zinv, &zinv2, curve);
+    p[i].y = jp[i].y;
+    field_multiply(&zinv2, &p[i].y, curve);
+    bn_mod(&p[i].x, prime);
+    bn_mod(&p[i].y, prime);
+  }
+}
+
+#define WNAF_WINDOW 5
+
+// Compute the width-5 NAF of k, i.e. k = sum_i naf[i] 2^i where every
+// digit is zero or odd with |naf[i]| < 16.
+// k must be normalized.  Not constant time: only use with public data.
+// returns the number of digits (at most 257).
+static int wnaf_encode(const bignum256 *k, int8_t naf[257])
+{
+  bignum256 a = *k;
+  int len = 0;
+  int digit;
+  
+  while (!bn_is_zero(&a)) {
+    digit = 0;
+    if (a.val[0] & 1) {
+      digit = a.val[0] & ((1 << WNAF_WINDOW) - 1);
+      if (digit & (1 << (WNAF_WINDOW - 1))) {
+        digit -= 1 << WNAF_WINDOW;
+        bn_addi(&a, -digit);
+      } else {
+        a.val[0] -= digit;
+      }
+    }
+    naf[len++] = digit;
+    bn_rshift(&a);
+  }
+  return len;
+}
+
+// Split k = k1 + k2 * lambda (mod order) with |k1|, |k2| < 2^128.
+// k1 and k2 are returned as absolute values and neg1, neg2 tell whether
+// they have to be negated.  k must be fully reduced.
+static void endo_split(const ecdsa_curve *curve, const bignum256 *k, bignum256 *k1, int *neg1, bignum256 *k2, int *neg2)
+{
+  const ecdsa_endomorphism *endo = curve->endo;
+  const bignum256 *order = &curve->order;
+  bignum256 c1, c2;
+  
+  // c1 = round(k * b2 / order), c2 = round(k * -b1 / order)
+  bn_multiply_shift(k, &endo->g1, &c1, 384);
+  bn_multiply_shift(k, &endo->g2, &c2, 384);
+  
+  // k2 = -c1 * b1 - c2 * b2
+  bn_multiply(&endo->minus_b1, &c1, order);
+  bn_multiply(&endo->minus_b2, &c2, order);
+  *k2 = c1;
+  bn_addmod(k2, &c2, order);
+  bn_mod(k2, order);
+  
+  // k1 = k - k2 * lambda
+  c1 = *k2;
+  bn_multiply(&endo->lambda, &c1, order);
+  bn_subtractmod(k, &c1, k1, order);
+  bn_fast_mod(k1, order);
+  bn_mod(k1, order);
+  
+  *neg1 = bn_is_less(&curve->order_half, k1);
+  if (*neg1) {
+    bn_subtract(order, k1, k1);
+  }
+  *neg2 = bn_is_less(&curve->order_half, k2);
+  if (*neg2) {
+    bn_subtract(order, k2, k2);
+  }
+}
+
+// add sign * p to the jacobian point jres, or set jres = sign * p if
+// jres is still the point at infinity.
+static void point_jacobian_add_signed(const curve_point *p, int negate, jacobian_curve_point *jres, int *is_infinity, const ecdsa_curve *curve)
+{
+  curve_point np;
+  
+  if (negate) {
+    np.x = p->x;
+    bn_subtract(&curve->prime, &p->y, &np.y);
+    p = &np;
+  }
+  if (*is_infinity) {
+    jres->x = p->x;
+    jres->y = p->y;
+    bn_one(&jres->z);
+    *is_infinity = 0;
+  } else {
+    point_jacobian_add(p, jres, curve);
+  }
+}
+
+// jres = k * p using the GLV endomorphism of the curve:
+//   k * p = k1 * p + k2 * (beta * x, y)
+// with |k1|, |k2| < 2^128 evaluated together, which halves the number of
+// doublings compared to point_multiply.
+// k must be fully reduced and p a valid point other than infinity.
+// Not constant time: only use with public data (recovery, verification).
+// returns 0 on success and 1 if k is zero or an intermediate sum
+// cancelled out, in which case the caller has to fall back to
+// point_multiply.
+static int point_multiply_endo_jacobian(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, jacobian_curve_point *jres)
+{
+  const bignum256 *prime = &curve->prime;
+  bignum256 k1, k2;
+  int neg1, neg2, len1, len2, i, is_infinity = 1;
+  int8_t naf1[257], naf2[257];
+  jacobian_curve_point jmult[8];
+  curve_point pmult[8], emult[8], twice;
+  
+  endo_split(curve, k, &k1, &neg1, &k2, &neg2);
+  len1 = wnaf_encode(&k1, naf1);
+  len2 = wnaf_encode(&k2, naf2);
+  
+  // pmult[i] = (2*i+1) * p, computed in jacobian coordinates and
+  // normalized with a single inversion.
+  twice = *p;
+  point_double(curve, &twice);
+  jmult[0].x = p->x;
+  jmult[0].y = p->y;
+  bn_one(&jmult[0].z);
+  for (i = 1; i < 8; i++) {
+    jmult[i] = jmult[i - 1];
+    point_jacobian_add(&twice, &jmult[i], curve);
+  }
+  jacobian_to_curve_batch(jmult, pmult, 8, curve);
+  
+  // emult[i] = lambda * pmult[i] = (beta * x, y)
+  for (i = 0; i < 8; i++) {
+    emult[i].x = pmult[i].x;
+    field_multiply(&curve->endo->beta, &emult[i].x, curve);
+    bn_mod(&emult[i].x, prime);
+    emult[i].y = pmult[i].y;
+  }
+  
+  for (i = (len1 > len2 ? len1 : len2) - 1; i >= 0; i--) {
+    if (!is_infinity) {
+      point_jacobian_double(jres, curve);
+    }
+    if (i < len1 && naf1[i] != 0) {
+      point_jacobian_add_signed(&pmult[abs(naf1[i]) >> 1], (naf1[i] < 0) ^ neg1, jres, &is_infinity, curve);
+    }
+    if (i < len2 && naf2[i] != 0) {
+      point_jacobian_add_signed(&emult[abs(naf2[i]) >> 1], (naf2[i] < 0) ^ neg2, jres, &is_infinity, curve);
+    }
+  }
+  
+  if (is_infinity) {
+    return 1;
+  }
+  // z = 0 means some partial sum was the point at infinity, which the
+  // jacobian formulas cannot continue from.
+  bn_fast_mod(&jres->z, prime);
+  bn_mod(&jres->z, prime);
+  return bn_is_zero(&jres->z);
+}
+
+// jres = k * p for public k, using the endomorphism if the curve has one.
+// returns 1 if k is zero (jres is not set), 0 otherwise
+static int point_multiply_public_jacobian(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, jacobian_curve_point *jres)
+{
+  if (curve->endo != NULL && point_multiply_endo_jacobian(curve, k, p, jres) == 0) {
+    return 0;
+  }
+  return point_multiply_jacobian(curve, k, p, jres);
+}
+
+// jres = k * G
+// returns 1 if k is zero (jres is not set), 0 otherwise
+static int scalar_multiply_jacobian(const ecdsa_curve *curve, const bignum256 *k, jacobian_curve_point *jres)
+{
+#if USE_PRECOMPUTED_CP
+  return comb_multiply_jacobian(curve, &curve->cp[0][0], 4, k, jres);
+#else
+  return point_multiply_jacobian(curve, k, &curve->G, jres);
+#endif
+}
+
+// res = u1 * G + u2 * p
+// u1 and u2 must be fully reduced, p a valid point other than infinity.
+// Uses the endomorphism if the curve has one, so u1, u2 must be public.
+static void point_multiply_add_public(const ecdsa_curve *curve, const bignum256 *u1, const bignum256 *u2, const curve_point *p, curve_point *res)
+{
+  jacobian_curve_point jres;
+  curve_point g;
+  
+  if (point_multiply_public_jacobian(curve, u2, p, &jres) != 0) {
+    point_set_infinity(res);
+  } else {
+    jacobian_to_curve(&jres, res, curve);
+  }
+  scalar_multiply(curve, u1, &g);
+  point_add(curve, &g, res);
+}
+
+// y2 = x^3 + a*x + b, fully reduced
+static void curve_y2(const ecdsa_curve *curve, const bignum256 *x, bignum256 *y2)
 {
-  // y^2 = x^3 + a*x + b
-  memcpy(y, x, sizeof(bignum256));         // y is x
-  bn_multiply(x, y, &curve->prime);        // y is x^2
-  bn_subi(y, -curve->a, &curve->prime);    // y is x^2 + a
-  bn_multiply(x, y, &curve->prime);        // y is x^3 + ax
-  bn_add(y, &curve->b);                    // y is x^3 + ax + b
-  bn_sqrt(y, &curve->prime);               // y = sqrt(y)
+  memcpy(y2, x, sizeof(bignum256));       // y2 is x
+  field_multiply(x, y2, curve);      // y2 is x^2
+  bn_subi(y2, -curve->a, &curve->prime);  // y2 is x^2 + a
+  field_multiply(x, y2, curve);      // y2 is x^3 + ax
+  bn_add(y2, &curve->b);                  // y2 is x^3 + ax + b
+  bn_fast_mod(y2, &curve->prime);
+  bn_mod(y2, &curve->prime);
+}
+
+// Compute y from x and the parity of y.
+// x is public.  The square root is only taken once the Jacobi symbol shows
+// that x^3 + ax + b is a square, so invalid x are rejected cheaply.
+// returns 0 on success and 1 if x is not the x coordinate of a point on
+// the curve (y is then not set)
+int uncompress_coords(const ecdsa_curve *curve, uint8_t odd, const bignum256 *x, bignum256 *y)
+{
+  bignum256 y2;
+  
+  curve_y2(curve, x, &y2);
+  if (bn_jacobi(&y2, &curve->prime) < 0) {
+    return 1;
+  }
+  *y = y2;
+  bn_sqrt_with(y, &curve->prime, curve->reduce);  // y = sqrt(y2)
   if ((odd & 0x01) != (y->val[0] & 1)) {
     bn_subtract(&curve->prime, y, y);   // y = -y
   }
+  return 0;
 }
 
 // Compute public key from signature and recovery id.
@@ -657,28 +980,614 @@ int ecdsa_recover_pub_from_sig (const ecdsa_curve *curve, uint8_t *pub_key, cons
     }
   }
   // compute y from x
-  uncompress_coords(curve, recid & 1, &cp.x, &cp.y);
-  if (!ecdsa_validate_pubkey(curve, &cp)) {
+  if (uncompress_coords(curve, recid & 1, &cp.x, &cp.y) != 0 ||
+      !ecdsa_validate_pubkey(curve, &cp)) {
     return 1;
   }
-  // e = -digest
+  // Pub = r^-1 (s * R - digest * G) = u1 * G + u2 * R
+  // with u1 = -digest * r^-1 and u2 = s * r^-1
+  bn_inverse(&r, &curve->order);
   bn_read_be(digest, &e);
+  bn_multiply(&r, &e, &curve->order);
   bn_subtractmod(&curve->order, &e, &e, &curve->order);
   bn_fast_mod(&e, &curve->order);
   bn_mod(&e, &curve->order);
-  // r := r^-1
-  bn_inverse(&r, &curve->order);
-  // cp := s * R = s * k *G
-  point_multiply(curve, &s, &cp, &cp);
-  // cp2 := -digest * G
-  scalar_multiply(curve, &e, &cp2);
-  // cp := (s * k - digest) * G = (r*priv) * G = r * Pub
-  point_add(curve, &cp2, &cp);
-  // cp := r^{-1} * r * Pub = Pub
-  point_multiply(curve, &r, &cp, &cp);
+  bn_multiply(&r, &s, &curve->order);
+  bn_mod(&s, &curve->order);
+  point_multiply_add_public(curve, &e, &s, &cp, &cp2);
+  if (point_is_infinity(&cp2)) {
+    return 1;
+  }
   pub_key[0] = 0x04;
-  bn_write_be(&cp.x, pub_key + 1);
-  bn_write_be(&cp.y, pub_key + 33);
+  bn_write_be(&cp2.x, pub_key + 1);
+  bn_write_be(&cp2.y, pub_key + 33);
+  return 0;
+}
+
+static unsigned int batch_recover, batch_sign, batch_sign_threads;
+
+// clamps a batch parameter to 1 .. max, 0 selects the default
+static unsigned int batch_param(unsigned int value, unsigned int def, unsigned int max)
+{
+  if (value == 0) {
+    return def;
+  }
+  return value < max ? value : max;
+}
+
+// Sets the chunk sizes and thread count of the batch functions.  Batch calls
+// already running keep the values they started with.
+void ecdsa_set_batch_params(const ecdsa_batch_params *params)
+{
+  __atomic_store_n(&batch_recover, batch_param(params->recover_batch, ECDSA_RECOVER_BATCH, ECDSA_RECOVER_BATCH), __ATOMIC_RELAXED);
+  __atomic_store_n(&batch_sign, batch_param(params->sign_batch, ECDSA_SIGN_BATCH, ECDSA_SIGN_BATCH), __ATOMIC_RELAXED);
+  __atomic_store_n(&batch_sign_threads, batch_param(params->sign_threads, 0, ECDSA_SIGN_THREADS), __ATOMIC_RELAXED);
+}
+
+// Reads the parameters in effect, with the defaults filled in.
+void ecdsa_get_batch_params(ecdsa_batch_params *params)
+{
+  long cpus;
+  
+  params->recover_batch = batch_param(__atomic_load_n(&batch_recover, __ATOMIC_RELAXED), ECDSA_RECOVER_BATCH, ECDSA_RECOVER_BATCH);
+  params->sign_batch = batch_param(__atomic_load_n(&batch_sign, __ATOMIC_RELAXED), ECDSA_SIGN_BATCH, ECDSA_SIGN_BATCH);
+  params->sign_threads = __atomic_load_n(&batch_sign_threads, __ATOMIC_RELAXED);
+  if (params->sign_threads == 0) {
+    // one per online processor
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    params->sign_threads = batch_param(cpus > 1 ? (unsigned int)cpus : 1, 1, ECDSA_SIGN_THREADS);
+  }
+}
+
+// Recovers the keys of up to ECDSA_RECOVER_BATCH signatures, see
+// ecdsa_recover_pub_from_sig_batch.
+static int recover_chunk(const ecdsa_curve *curve, uint8_t *pub_keys, const uint8_t *sigs, const uint8_t *digests, const int *recids, int *results, int n)
+{
+  const bignum256 *order = &curve->order, *prime = &curve->prime;
+  bignum256 r[ECDSA_RECOVER_BATCH], s[ECDSA_RECOVER_BATCH], prod[ECDSA_RECOVER_BATCH];
+  bignum256 e, inv, tmp;
+  curve_point R[ECDSA_RECOVER_BATCH], g[ECDSA_RECOVER_BATCH];
+  jacobian_curve_point ja[ECDSA_RECOVER_BATCH], jg[ECDSA_RECOVER_BATCH];
+  int idx[ECDSA_RECOVER_BATCH], gidx[ECDSA_RECOVER_BATCH];
+  int i, k, m = 0, gm = 0, failed = 0;
+  
+  // read r, s and R, keep the valid signatures in idx[0 .. m-1]
+  bn_read_be_batch(sigs, 64, r, n);
+  bn_read_be_batch(sigs + 32, 64, s, n);
+  for (i = 0; i < n; i++) {
+    results[i] = 1;
+    r[m] = r[i];
+    s[m] = s[i];
+    if (!bn_is_less(&r[m], order) || bn_is_zero(&r[m]) ||
+        !bn_is_less(&s[m], order) || bn_is_zero(&s[m])) {
+      continue;
+    }
+    R[m].x = r[m];
+    if (recids[i] & 2) {
+      bn_add(&R[m].x, order);
+      if (!bn_is_less(&R[m].x, prime)) {
+        continue;
+      }
+    }
+    if (uncompress_coords(curve, recids[i] & 1, &R[m].x, &R[m].y) != 0 ||
+        !ecdsa_validate_pubkey(curve, &R[m])) {
+      continue;
+    }
+    idx[m++] = i;
+  }
+  if (m == 0) {
+    return n;
+  }
+  
+  // r[k] := r[k]^-1 for all k with one inversion
+  prod[0] = r[0];
+  for (k = 1; k < m; k++) {
+    prod[k] = prod[k - 1];
+    bn_multiply(&r[k], &prod[k], order);
+  }
+  inv = prod[m - 1];
+  bn_mod(&inv, order);
+  bn_inverse(&inv, order);
+  for (k = m - 1; k > 0; k--) {
+    // inv = (r[0] * ... * r[k])^-1
+    tmp = prod[k - 1];
+    bn_multiply(&inv, &tmp, order);
+    bn_multiply(&r[k], &inv, order);
+    r[k] = tmp;
+    bn_mod(&r[k], order);
+  }
+  r[0] = inv;
+  bn_mod(&r[0], order);
+  
+  // Pub = u1 * G + u2 * R with u1 = -digest * r^-1 and u2 = s * r^-1
+  for (k = 0; k < m; k++) {
+    bn_read_be(digests + 32 * idx[k], &e);
+    bn_multiply(&r[k], &e, order);
+    bn_subtractmod(order, &e, &e, order);
+    bn_fast_mod(&e, order);
+    bn_mod(&e, order);
+    bn_multiply(&r[k], &s[k], order);
+    bn_mod(&s[k], order);
+    point_multiply_public_jacobian(curve, &s[k], &R[k], &ja[k]);
+    if (scalar_multiply_jacobian(curve, &e, &jg[gm]) == 0) {
+      gidx[gm++] = k;
+    }
+  }
+  
+  // normalize all u1 * G with one inversion and add them to u2 * R
+  if (gm > 0) {
+    jacobian_to_curve_batch(jg, g, gm, curve);
+  }
+  for (i = 0; i < gm; i++) {
+    point_jacobian_add(&g[i], &ja[gidx[i]], curve);
+  }
+  
+  // u1 * G = +-u2 * R makes the mixed addition degenerate, recover those
+  // one by one and normalize the rest together.
+  gm = 0;
+  for (k = 0; k < m; k++) {
+    tmp = ja[k].z;
+    bn_fast_mod(&tmp, prime);
+    bn_mod(&tmp, prime);
+    if (bn_is_zero(&tmp)) {
+      i = idx[k];
+      results[i] = ecdsa_recover_pub_from_sig(curve, pub_keys + 65 * i, sigs + 64 * i, digests + 32 * i, recids[i]);
+    } else {
+      ja[gm] = ja[k];
+      gidx[gm++] = idx[k];
+    }
+  }
+  if (gm > 0) {
+    jacobian_to_curve_batch(ja, g, gm, curve);
+  }
+  for (k = 0; k < gm; k++) {
+    i = gidx[k];
+    pub_keys[65 * i] = 0x04;
+    bn_write_be(&g[k].x, pub_keys + 65 * i + 1);
+    bn_write_be(&g[k].y, pub_keys + 65 * i + 33);
+    results[i] = 0;
+  }
+  
+  for (i = 0; i < n; i++) {
+    failed += results[i] != 0;
+  }
+  return failed;
+}
+
+// Recovers the public keys of n signatures like n calls of
+// ecdsa_recover_pub_from_sig, but shares the inversions within chunks of
+// up to ECDSA_RECOVER_BATCH signatures (Montgomery's trick, the chunk size
+// is set by ecdsa_set_batch_params): r^-1 modulo order,
+// the normalization of u1 * G and the final conversion to affine
+// coordinates.
+// pub_keys holds n * 65 bytes, sigs n * 64, digests n * 32 and results
+// receives 0 for every recovered key.
+// returns the number of keys that could not be recovered
+int ecdsa_recover_pub_from_sig_batch(const ecdsa_curve *curve, uint8_t *pub_keys, const uint8_t *sigs, const uint8_t *digests, const int *recids, int *results, size_t n)
+{
+  ecdsa_batch_params params;
+  size_t i;
+  int chunk, failed = 0;
+  
+  ecdsa_get_batch_params(&params);
+  for (i = 0; i < n; i += chunk) {
+    chunk = n - i < params.recover_batch ? (int)(n - i) : (int)params.recover_batch;
+    failed += recover_chunk(curve, pub_keys + 65 * i, sigs + 64 * i, digests + 32 * i, recids + i, results + i, chunk);
+  }
+  return failed;
+}
+
+// Completes a signature from the nonce point R = k * G and kinv = k^-1:
+//   r = R.x mod order, s = kinv * (e + r * d) mod order
+// s is normalized to the lower half of the order and the recovery id is
+// adjusted to match.
+// returns 0 on success and 1 if r or s is zero, in which case the caller
+// has to retry with the next nonce.
+static int sign_finish(const ecdsa_curve *curve, const bignum256 *d, const bignum256 *e, const curve_point *R, const bignum256 *kinv, uint8_t *sig, uint8_t *pby, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  const bignum256 *order = &curve->order;
+  bignum256 r;
+  CONFIDENTIAL bignum256 s;
+  uint8_t recid = R->y.val[0] & 1;
+  
+  r = R->x;
+  if (!bn_is_less(&r, order)) {
+    bn_subtract(&r, order, &r);
+    recid |= 2;
+  }
+  if (bn_is_zero(&r)) {
+    return 1;
+  }
+  
+  s = r;
+  bn_multiply(d, &s, order);
+  bn_addmod(&s, e, order);
+  bn_multiply(kinv, &s, order);
+  bn_mod(&s, order);
+  if (bn_is_zero(&s)) {
+    memzero(&s, sizeof(s));
+    return 1;
+  }
+  
+  // low s, (r, s) and (r, -s) are both valid
+  if (bn_is_less(&curve->order_half, &s)) {
+    bn_subtract(order, &s, &s);
+    recid ^= 1;
+  }
+  
+  bn_write_be(&r, sig);
+  bn_write_be(&s, sig + 32);
+  memzero(&s, sizeof(s));
+  if (is_canonical && !is_canonical(recid, sig)) {
+    return 1;
+  }
+  if (pby) {
+    *pby = recid;
+  }
+  return 0;
+}
+
+// k = the next valid nonce from the RFC 6979 generator
+static void generate_k_rfc6979(bignum256 *k, rfc6979_state *state, const bignum256 *order)
+{
+  uint8_t buf[32];
+  
+  do {
+    generate_rfc6979(buf, state);
+    bn_read_be(buf, k);
+  } while (bn_is_zero(k) || !bn_is_less(k, order));
+  memzero(buf, sizeof(buf));
+}
+
+// Seeds state for priv_key and the digest e, which must already be reduced
+// modulo the order: RFC 6979 seeds with bits2octets(h), not the raw h.
+static void init_rfc6979_reduced(const uint8_t *priv_key, const bignum256 *e, rfc6979_state *state)
+{
+  uint8_t h1[32];
+  
+  bn_write_be(e, h1);
+  init_rfc6979(priv_key, h1, state);
+}
+
+// Sets blind to a secret factor in [1, order - 1] from the system CSPRNG.
+// random32 is a predictable LCG and must not be used here.
+// returns 0 on success and -1 if no secure randomness is available
+static int generate_blind(bignum256 *blind, const bignum256 *order)
+{
+  CONFIDENTIAL uint8_t buf[32];
+  int result;
+  
+  do {
+    result = random_secure(buf, sizeof(buf));
+    bn_read_be(buf, blind);
+  } while (result == 0 && (bn_is_zero(blind) || !bn_is_less(blind, order)));
+  memzero(buf, sizeof(buf));
+  return result;
+}
+
+// x = x^-1 modulo order.  The inversion is blinded with a secret random
+// factor since x is secret; without a system CSPRNG it is not blinded.
+// x must be normalized and not zero.
+static void inverse_blinded(bignum256 *x, const bignum256 *order)
+{
+  CONFIDENTIAL bignum256 blind;
+  
+  if (generate_blind(&blind, order) != 0) {
+    memzero(&blind, sizeof(blind));
+    bn_inverse(x, order);
+    return;
+  }
+  bn_multiply(&blind, x, order);
+  bn_mod(x, order);
+  bn_inverse(x, order);
+  bn_multiply(&blind, x, order);
+  bn_mod(x, order);
+  memzero(&blind, sizeof(blind));
+}
+
+// signs with the nonces from state until one gives a valid signature that
+// is_canonical (if not NULL) accepts.  k holds the nonce, the caller zeroes
+// it with the rest of its secrets.
+static void sign_with_rfc6979(const ecdsa_curve *curve, const bignum256 *d, const bignum256 *e, rfc6979_state *state, bignum256 *k, uint8_t *sig, uint8_t *pby, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  curve_point R;
+  
+  do {
+    generate_k_rfc6979(k, state, &curve->order);
+    scalar_multiply(curve, k, &R);
+    inverse_blinded(k, &curve->order);
+  } while (sign_finish(curve, d, e, &R, k, sig, pby, is_canonical) != 0);
+}
+
+// The private keys, nonces and nonce generators of a signing call.  They
+// live in a slot of a locked arena (see secmem.h) shared by all signing
+// threads, or on the stack of the call when every slot is taken or the
+// arena could not be mapped.
+typedef struct {
+  bignum256 d[ECDSA_SIGN_BATCH], k[ECDSA_SIGN_BATCH], prod[ECDSA_SIGN_BATCH];
+  bignum256 inv, tmp;
+  rfc6979_state state[ECDSA_SIGN_BATCH];
+  jacobian_curve_point jr[ECDSA_SIGN_BATCH];
+} sign_secrets;
+
+// a slot for every signing thread of one batch call
+#define SIGN_SECRET_SLOTS ECDSA_SIGN_THREADS
+
+static secmem_arena *sign_arena;
+static pthread_once_t sign_arena_once = PTHREAD_ONCE_INIT;
+
+static void sign_arena_init(void)
+{
+  sign_arena = secmem_arena_new(sizeof(sign_secrets), SIGN_SECRET_SLOTS);
+}
+
+// returns a zeroed arena slot, or NULL if none is free
+static sign_secrets *take_secrets(void)
+{
+  pthread_once(&sign_arena_once, sign_arena_init);
+  return sign_arena != NULL ? secmem_alloc(sign_arena) : NULL;
+}
+
+// zeroes and returns slot from take_secrets, or zeroes the local
+// secrets used in its place
+static void release_secrets(sign_secrets *slot, void *local, size_t local_size)
+{
+  if (slot != NULL) {
+    secmem_free(sign_arena, slot);
+  } else {
+    memzero(local, local_size);
+  }
+}
+
+// reads a private key, returns 1 if it is not in [1, order - 1]
+static int read_priv_key(const ecdsa_curve *curve, const uint8_t *priv_key, bignum256 *d)
+{
+  bn_read_be(priv_key, d);
+  return bn_is_zero(d) || !bn_is_less(d, &curve->order);
+}
+
+// Signs digest with priv_key using a deterministic nonce (RFC 6979).
+// sig receives r | s with s in the lower half of the order, pby (if not
+// NULL) the recovery id.  If is_canonical is not NULL, nonces are drawn
+// until it accepts the signature, see ecdsa_sig_is_canonical.
+// returns 0 on success and 1 if priv_key is not a valid private key
+int ecdsa_sign_digest(const ecdsa_curve *curve, const uint8_t *priv_key, const uint8_t *digest, uint8_t *sig, uint8_t *pby, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  // only the first key, nonce and generator of a slot are used
+  CONFIDENTIAL struct {
+    bignum256 d, k;
+    rfc6979_state state;
+  } local;
+  sign_secrets *secrets = take_secrets();
+  bignum256 *d = secrets != NULL ? &secrets->d[0] : &local.d;
+  bignum256 *k = secrets != NULL ? &secrets->k[0] : &local.k;
+  rfc6979_state *state = secrets != NULL ? &secrets->state[0] : &local.state;
+  bignum256 e;
+  int result = 1;
+  
+  if (read_priv_key(curve, priv_key, d) == 0) {
+    bn_read_be(digest, &e);
+    bn_mod(&e, &curve->order);
+    init_rfc6979_reduced(priv_key, &e, state);
+    sign_with_rfc6979(curve, d, &e, state, k, sig, pby, is_canonical);
+    result = 0;
+  }
+  
+  release_secrets(secrets, &local, sizeof(local));
+  return result;
+}
+
+// Signs up to ECDSA_SIGN_BATCH digests, see ecdsa_sign_batch.  The key of
+// digest i is at keys + key_stride * i.
+static int sign_chunk(const ecdsa_curve *curve, const uint8_t *keys, size_t key_stride, const uint8_t *digests, uint8_t *sigs, int *recids, int n, int (*is_canonical)(uint8_t by, uint8_t sig[64]), sign_secrets *secrets)
+{
+  const bignum256 *order = &curve->order;
+  bignum256 *d = secrets->d, *k = secrets->k, *prod = secrets->prod;
+  bignum256 *inv = &secrets->inv, *tmp = &secrets->tmp;
+  rfc6979_state *state = secrets->state;
+  jacobian_curve_point *jr = secrets->jr;
+  bignum256 e[ECDSA_SIGN_BATCH];
+  curve_point R[ECDSA_SIGN_BATCH];
+  int idx[ECDSA_SIGN_BATCH];
+  int i, j, m = 0;
+  uint8_t recid;
+  
+  // derive the nonces and R = k * G of the valid keys, kept in
+  // idx[0 .. m-1]
+  bn_read_be_batch(digests, 32, e, n);
+  for (i = 0; i < n; i++) {
+    recids[i] = -1;
+    memset(sigs + 64 * i, 0, 64);
+    if (read_priv_key(curve, keys + key_stride * i, &d[m]) != 0) {
+      continue;
+    }
+    e[m] = e[i];
+    bn_mod(&e[m], order);
+    init_rfc6979_reduced(keys + key_stride * i, &e[m], &state[m]);
+    generate_k_rfc6979(&k[m], &state[m], order);
+    scalar_multiply_jacobian(curve, &k[m], &jr[m]);
+    idx[m++] = i;
+  }
+  if (m == 0) {
+    return n;
+  }
+  
+  // R to affine coordinates with one inversion
+  jacobian_to_curve_batch(jr, R, m, curve);
+  
+  // k[j] := k[j]^-1 for all j with one inversion
+  prod[0] = k[0];
+  for (j = 1; j < m; j++) {
+    prod[j] = prod[j - 1];
+    bn_multiply(&k[j], &prod[j], order);
+  }
+  *inv = prod[m - 1];
+  bn_mod(inv, order);
+  inverse_blinded(inv, order);
+  for (j = m - 1; j > 0; j--) {
+    // inv = (k[0] * ... * k[j])^-1
+    *tmp = prod[j - 1];
+    bn_multiply(inv, tmp, order);
+    bn_multiply(&k[j], inv, order);
+    k[j] = *tmp;
+    bn_mod(&k[j], order);
+  }
+  k[0] = *inv;
+  bn_mod(&k[0], order);
+  
+  for (j = 0; j < m; j++) {
+    i = idx[j];
+    if (sign_finish(curve, &d[j], &e[j], &R[j], &k[j], sigs + 64 * i, &recid, is_canonical) != 0) {
+      // r or s is zero or the signature is not canonical, continue with
+      // the next nonce of this digest
+      sign_with_rfc6979(curve, &d[j], &e[j], &state[j], &k[j], sigs + 64 * i, &recid, is_canonical);
+    }
+    recids[i] = recid;
+  }
+  return n - m;
+}
+
+typedef struct {
+  const ecdsa_curve *curve;
+  const uint8_t *keys;
+  size_t key_stride;  // 32, or 0 for one key
+  const uint8_t *digests;
+  uint8_t *sigs;
+  int *recids;
+  size_t n;
+  size_t chunk;   // digests per chunk
+  size_t first;   // first chunk of this worker
+  size_t step;    // number of workers
+  int (*is_canonical)(uint8_t by, uint8_t sig[64]);
+  int failed;
+} sign_job;
+
+// Signs the chunks of one worker with the secrets in one arena slot, which
+// is zeroed once all of them are done.
+static void *sign_worker(void *arg)
+{
+  sign_job *job = arg;
+  CONFIDENTIAL sign_secrets local;
+  sign_secrets *secrets = take_secrets();
+  size_t i;
+  int chunk;
+  
+  for (i = job->first * job->chunk; i < job->n; i += job->step * job->chunk) {
+    chunk = job->n - i < job->chunk ? (int)(job->n - i) : (int)job->chunk;
+    job->failed += sign_chunk(job->curve, job->keys + job->key_stride * i, job->key_stride, job->digests + 32 * i,
+                              job->sigs + 64 * i, job->recids + i, chunk, job->is_canonical,
+                              secrets != NULL ? secrets : &local);
+  }
+  release_secrets(secrets, &local, sizeof(local));
+  return NULL;
+}
+
+// signs n digests, the key of digest i at keys + key_stride * i
+static int sign_batch(const ecdsa_curve *curve, const uint8_t *keys, size_t key_stride, const uint8_t *digests, size_t n, uint8_t *sigs, int *recids, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  sign_job jobs[ECDSA_SIGN_THREADS];
+  pthread_t threads[ECDSA_SIGN_THREADS];
+  int started[ECDSA_SIGN_THREADS];
+  ecdsa_batch_params params;
+  size_t chunks, workers, i;
+  int failed = 0;
+  
+  ecdsa_get_batch_params(&params);
+  chunks = (n + params.sign_batch - 1) / params.sign_batch;
+  workers = params.sign_threads;
+  if (workers > chunks) {
+    workers = chunks;
+  }
+  if (workers <= 1) {
+    sign_job job = { curve, keys, key_stride, digests, sigs, recids, n, params.sign_batch, 0, 1, is_canonical, 0 };
+    sign_worker(&job);
+    return job.failed;
+  }
+  
+  for (i = 0; i < workers; i++) {
+    sign_job job = { curve, keys, key_stride, digests, sigs, recids, n, params.sign_batch, i, workers, is_canonical, 0 };
+    jobs[i] = job;
+    // the calling thread takes the first share
+    started[i] = i > 0 && pthread_create(&threads[i], NULL, sign_worker, &jobs[i]) == 0;
+  }
+  for (i = 0; i < workers; i++) {
+    if (!started[i]) {
+      sign_worker(&jobs[i]);
+    }
+  }
+  for (i = 0; i < workers; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+    failed += jobs[i].failed;
+  }
+  return failed;
+}
+
+// Signs n digests like n calls of ecdsa_sign_digest, with the same
+// signatures.  Within chunks of up to ECDSA_SIGN_BATCH digests the
+// conversion of the nonce points to affine coordinates and the inversion of
+// the nonces share one inversion each (Montgomery's trick).  Chunks are
+// spread over up to ECDSA_SIGN_THREADS threads, by default one per online
+// processor.  See ecdsa_set_batch_params for both.
+// keys holds n * 32 bytes, digests n * 32 and sigs n * 64.  recids
+// receives the recovery id of every signature, or -1 if its key is not a
+// valid private key.  is_canonical is used as by ecdsa_sign_digest.
+// returns the number of digests that could not be signed
+int ecdsa_sign_batch(const ecdsa_curve *curve, const uint8_t *keys, const uint8_t *digests, size_t n, uint8_t *sigs, int *recids, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  return sign_batch(curve, keys, 32, digests, n, sigs, recids, is_canonical);
+}
+
+// ecdsa_sign_batch with the same priv_key for all n digests
+int ecdsa_sign_batch_key(const ecdsa_curve *curve, const uint8_t *priv_key, const uint8_t *digests, size_t n, uint8_t *sigs, int *recids, int (*is_canonical)(uint8_t by, uint8_t sig[64]))
+{
+  return sign_batch(curve, priv_key, 0, digests, n, sigs, recids, is_canonical);
+}
+
+// EOSIO accepts a K1 signature only if r and s, as 32 big endian bytes,
+// have the top bit clear and no redundant leading zero byte.
+int ecdsa_sig_is_canonical(uint8_t by, uint8_t sig[64])
+{
+  (void)by;
+  return !(sig[0] & 0x80) && !(sig[0] == 0 && !(sig[1] & 0x80)) &&
+         !(sig[32] & 0x80) && !(sig[32] == 0 && !(sig[33] & 0x80));
+}
+
+// Verifies a signature r | s over digest with pub_key (33 or 65 bytes).
+// returns 0 if the signature is valid
+int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key, const uint8_t *sig, const uint8_t *digest)
+{
+  curve_point pub, res;
+  bignum256 r, s, z;
+  
+  if (!ecdsa_read_pubkey(curve, pub_key, &pub)) {
+    return 1;
+  }
+  bn_read_be(sig, &r);
+  bn_read_be(sig + 32, &s);
+  if (!bn_is_less(&r, &curve->order) || bn_is_zero(&r)) {
+    return 2;
+  }
+  if (!bn_is_less(&s, &curve->order) || bn_is_zero(&s)) {
+    return 2;
+  }
+  // res = (digest * G + r * Pub) / s
+  bn_inverse(&s, &curve->order);
+  bn_read_be(digest, &z);
+  bn_multiply(&s, &z, &curve->order);
+  bn_mod(&z, &curve->order);
+  bn_multiply(&r, &s, &curve->order);
+  bn_mod(&s, &curve->order);
+  point_multiply_add_public(curve, &z, &s, &pub, &res);
+  if (point_is_infinity(&res)) {
+    return 3;
+  }
+  // res.x < prime < 2 * order on the supported curves
+  bn_mod(&(res.x), &curve->order);
+  if (!bn_is_equal(&res.x, &r)) {
+    return 4;
+  }
   return 0;
 }
 
@@ -703,13 +1612,13 @@ int ecdsa_validate_pubkey(const ecdsa_curve *curve, const curve_point *pub)
   memcpy(&x3_ax_b, &(pub->x), sizeof(bignum256));
   
   // y^2
-  bn_multiply(&(pub->y), &y_2, &curve->prime);
+  field_multiply(&(pub->y), &y_2, curve);
   bn_mod(&y_2, &curve->prime);
   
   // x^3 + ax + b
-  bn_multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^2
+  field_multiply(&(pub->x), &x3_ax_b, curve);  // x^2
   bn_subi(&x3_ax_b, -curve->a, &curve->prime);      // x^2 + a
-  bn_multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^3 + ax
+  field_multiply(&(pub->x), &x3_ax_b, curve);  // x^3 + ax
   bn_addmod(&x3_ax_b, &curve->b, &curve->prime);    // x^3 + ax + b
   bn_mod(&x3_ax_b, &curve->prime);
   
@@ -720,6 +1629,73 @@ int ecdsa_validate_pubkey(const ecdsa_curve *curve, const curve_point *pub)
   return 1;
 }
 
+// Parse a 33 byte compressed or 65 byte uncompressed public key.
+// returns 1 if the key is a valid point on the curve, 0 otherwise
+int ecdsa_read_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key, curve_point *pub)
+{
+  if (pub_key[0] == 0x04) {
+    bn_read_be(pub_key + 1, &(pub->x));
+    bn_read_be(pub_key + 33, &(pub->y));
+    return ecdsa_validate_pubkey(curve, pub);
+  }
+  if (pub_key[0] == 0x02 || pub_key[0] == 0x03) {
+    bn_read_be(pub_key + 1, &(pub->x));
+    if (!bn_is_less(&(pub->x), &curve->prime) ||
+        uncompress_coords(curve, pub_key[0], &(pub->x), &(pub->y)) != 0) {
+      return 0;
+    }
+    return ecdsa_validate_pubkey(curve, pub);
+  }
+  return 0;
+}
+
+// Checks a compressed public key (0x02 or 0x03 | x) without computing y.
+// The curves have prime order, so every point on them except infinity is
+// a valid key and x is valid iff x < p and x^3 + ax + b is a square, which
+// the Jacobi symbol decides in a fraction of the time of the square root.
+// returns 1 if ecdsa_read_pubkey would accept the key, 0 otherwise
+int ecdsa_validate_compressed_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key)
+{
+  bignum256 x, y2;
+  
+  if (pub_key[0] != 0x02 && pub_key[0] != 0x03) {
+    return 0;
+  }
+  bn_read_be(pub_key + 1, &x);
+  if (!bn_is_less(&x, &curve->prime)) {
+    return 0;
+  }
+  curve_y2(curve, &x, &y2);
+  return bn_jacobi(&y2, &curve->prime) >= 0;
+}
+
+// Compress an uncompressed public key (0x04 | x | y) into (0x02 + odd(y) | x).
+// returns 0 if the key is successfully compressed
+int ecdsa_compress_pubkey(const uint8_t *pub_key, uint8_t *compressed)
+{
+  if (pub_key[0] != 0x04) {
+    return 1;
+  }
+  compressed[0] = 0x02 | (pub_key[64] & 0x01);
+  memcpy(compressed + 1, pub_key + 1, 32);
+  return 0;
+}
+
+// Expand a compressed or uncompressed public key into 65 byte uncompressed form.
+// returns 0 if the key is valid and successfully uncompressed
+int ecdsa_uncompress_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key, uint8_t *uncompressed)
+{
+  curve_point pub;
+  
+  if (!ecdsa_read_pubkey(curve, pub_key, &pub)) {
+    return 1;
+  }
+  uncompressed[0] = 0x04;
+  bn_write_be(&pub.x, uncompressed + 1);
+  bn_write_be(&pub.y, uncompressed + 33);
+  return 0;
+}
+
 // returns 0 if conversion succeeds and 1 if it fails
 // ASN1 format: r (32 bytes) | s (32 bytes)
 int ecdsa_der_to_sig(const uint8_t *der, uint8_t *sig) {
@@ -778,3 +1754,33 @@ int ecdsa_der_to_sig(const uint8_t *der, uint8_t *sig) {
   
   return result;
 }
+
+// Turn a raw signature r | s over digest into the 65 byte compact form
+// (27 + 4 + recid) | r | s that the chain expects.  s is normalized to the
+// lower half of the order and recid is chosen so that the signature recovers
+// to pub_key (65 bytes, uncompressed).
+// returns 0 on success and 1 if no recovery id matches pub_key
+int ecdsa_sig_to_compact(const ecdsa_curve *curve, const uint8_t *sig, const uint8_t *digest, const uint8_t *pub_key, uint8_t *compact_sig)
+{
+  uint8_t norm_sig[64];
+  uint8_t rec_pub_key[65];
+  bignum256 s;
+  int recid;
+  
+  memcpy(norm_sig, sig, 64);
+  bn_read_be(sig + 32, &s);
+  if (bn_is_less(&curve->order_half, &s)) {
+    bn_subtract(&curve->order, &s, &s);
+    bn_write_be(&s, norm_sig + 32);
+  }
+  
+  for (recid = 0; recid < 4; recid++) {
+    if (ecdsa_recover_pub_from_sig(curve, rec_pub_key, norm_sig, digest, recid) == 0 &&
+        memcmp(rec_pub_key, pub_key, 65) == 0) {
+      compact_sig[0] = 27 + 4 + recid;
+      memcpy(compact_sig + 1, norm_sig, 64);
+      return 0;
+    }
+  }
+  return 1;
+}
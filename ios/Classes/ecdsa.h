@@ -18,6 +18,40 @@ typedef struct {
   bignum256 x, y;
 } curve_point;
 
+// Jacobian coordinates are kept only as reduced as the formulas need:
+// x < 6 * prime, y < 2 * prime and z < 2 * prime, all normalized.
+typedef struct jacobian_curve_point {
+  bignum256 x, y, z;
+} jacobian_curve_point;
+
+// Efficiently computable endomorphism (x, y) -> (beta * x, y) = lambda * (x, y)
+// of a curve with a = 0.  Scalars are split as k = k1 + k2 * lambda with
+// |k1|, |k2| < 2^128 using the reduced lattice basis (a1, b1), (a2, b2).
+typedef struct {
+  bignum256 beta;        // cube root of unity modulo prime
+  bignum256 lambda;      // cube root of unity modulo order
+  bignum256 g1;          // round(2^384 * b2 / order)
+  bignum256 g2;          // round(2^384 * -b1 / order)
+  bignum256 minus_b1;    // -b1 modulo order
+  bignum256 minus_b2;    // -b2 modulo order
+} ecdsa_endomorphism;
+
+// signatures recovered together by ecdsa_recover_pub_from_sig_batch
+#define ECDSA_RECOVER_BATCH 32
+
+// digests signed together by ecdsa_sign_batch, and the most threads it uses
+#define ECDSA_SIGN_BATCH 32
+#define ECDSA_SIGN_THREADS 16
+
+// Chunk sizes and signing threads of the batch functions, e.g. from a
+// tuning profile (tune.h).  Zero selects the default: the largest chunks
+// and one signing thread per online processor.
+typedef struct {
+  unsigned int recover_batch;  // 1 .. ECDSA_RECOVER_BATCH
+  unsigned int sign_batch;     // 1 .. ECDSA_SIGN_BATCH
+  unsigned int sign_threads;   // 1 .. ECDSA_SIGN_THREADS
+} ecdsa_batch_params;
+
 typedef struct {
   
   bignum256 prime;       // prime order of the finite field
@@ -26,6 +60,9 @@ typedef struct {
   bignum256 order_half;  // order of G divided by 2
   int       a;           // coefficient 'a' of the elliptic curve
   bignum256 b;           // coefficient 'b' of the elliptic curve
+  bn_reducer reduce;     // reduction of products modulo prime
+  
+  const ecdsa_endomorphism *endo;  // GLV endomorphism, NULL if the curve has none
   
 #if USE_PRECOMPUTED_CP
   const curve_point cp[64][8];
@@ -42,10 +79,31 @@ int point_is_infinity(const curve_point *p);
 int point_is_equal(const curve_point *p, const curve_point *q);
 int point_is_negative_of(const curve_point *p, const curve_point *q);
 void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res);
-void uncompress_coords(const ecdsa_curve *curve, uint8_t odd, const bignum256 *x, bignum256 *y);
+void comb_multiply(const ecdsa_curve *curve, const curve_point *cp, unsigned int window, const bignum256 *k, curve_point *res);
+int uncompress_coords(const ecdsa_curve *curve, uint8_t odd, const bignum256 *x, bignum256 *y);
+
+// conversions to and from jacobian coordinates, the addition p2 += p1 and
+// the doubling p = 2p; see jacobian_curve_point for the bounds they keep
+void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp, const ecdsa_curve *curve);
+void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p, const ecdsa_curve *curve);
+void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const ecdsa_curve *curve);
+void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve);
 
 int ecdsa_recover_pub_from_sig (const ecdsa_curve *curve, uint8_t *pub_key, const uint8_t *sig, const uint8_t *digest, int recid);
+void ecdsa_set_batch_params(const ecdsa_batch_params *params);
+void ecdsa_get_batch_params(ecdsa_batch_params *params);
+int ecdsa_recover_pub_from_sig_batch(const ecdsa_curve *curve, uint8_t *pub_keys, const uint8_t *sigs, const uint8_t *digests, const int *recids, int *results, size_t n);
+int ecdsa_sign_digest(const ecdsa_curve *curve, const uint8_t *priv_key, const uint8_t *digest, uint8_t *sig, uint8_t *pby, int (*is_canonical)(uint8_t by, uint8_t sig[64]));
+int ecdsa_sign_batch(const ecdsa_curve *curve, const uint8_t *keys, const uint8_t *digests, size_t n, uint8_t *sigs, int *recids, int (*is_canonical)(uint8_t by, uint8_t sig[64]));
+int ecdsa_sign_batch_key(const ecdsa_curve *curve, const uint8_t *priv_key, const uint8_t *digests, size_t n, uint8_t *sigs, int *recids, int (*is_canonical)(uint8_t by, uint8_t sig[64]));
+int ecdsa_sig_is_canonical(uint8_t by, uint8_t sig[64]);
+int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key, const uint8_t *sig, const uint8_t *digest);
 int ecdsa_validate_pubkey(const ecdsa_curve *curve, const curve_point *pub);
+int ecdsa_read_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key, curve_point *pub);
+int ecdsa_validate_compressed_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key);
+int ecdsa_compress_pubkey(const uint8_t *pub_key, uint8_t *compressed);
+int ecdsa_uncompress_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key, uint8_t *uncompressed);
 int ecdsa_der_to_sig(const uint8_t *der, uint8_t *sig);
+int ecdsa_sig_to_compact(const ecdsa_curve *curve, const uint8_t *sig, const uint8_t *digest, const uint8_t *pub_key, uint8_t *compact_sig);
 
 #endif /* ecdsa_h */
@@ -0,0 +1,254 @@
+//
+//  ectable.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "ectable.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ripemd160.h"
+
+size_t ectable_size(unsigned int window)
+{
+  return (size_t)((256 + window - 1) / window) * (1 << (window - 1)) * sizeof(curve_point);
+}
+
+void ectable_build(const ecdsa_curve *curve, const curve_point *base, unsigned int window, curve_point *cp)
+{
+  const int rows = (256 + window - 1) / window;
+  const int cols = 1 << (window - 1);
+  curve_point row_base = *base, twice;
+  int i, j;
+  unsigned int k;
+
+  for (i = 0; i < rows; i++) {
+    // row_base = 2^(window*i) * base
+    twice = row_base;
+    point_double(curve, &twice);
+    cp[i * cols] = row_base;
+    for (j = 1; j < cols; j++) {
+      // (2j+1) * row_base
+      cp[i * cols + j] = cp[i * cols + j - 1];
+      point_add(curve, &twice, &cp[i * cols + j]);
+    }
+    for (k = 0; k < window; k++) {
+      point_double(curve, &row_base);
+    }
+  }
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+  const uint8_t *p = buf;
+  ssize_t n;
+
+  while (len > 0) {
+    n = write(fd, p, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+int ectable_write(const char *path, const ecdsa_curve *curve, const curve_point *base, unsigned int window)
+{
+  uint8_t *header_page;
+  ectable_header *header;
+  curve_point *cp;
+  char tmp_path[1024];
+  size_t payload_size;
+  int fd, res = 1;
+
+  if (window < 2 || window > 8) {
+    return 1;
+  }
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp_path)) {
+    return 1;
+  }
+  payload_size = ectable_size(window);
+  header_page = calloc(1, ECTABLE_HEADER_SIZE);
+  cp = malloc(payload_size);
+  if (header_page == NULL || cp == NULL) {
+    free(header_page);
+    free(cp);
+    return 1;
+  }
+  ectable_build(curve, base, window, cp);
+
+  header = (ectable_header *)header_page;
+  memcpy(header->magic, ECTABLE_MAGIC, sizeof(header->magic));
+  header->version = ECTABLE_VERSION;
+  header->byte_order = ECTABLE_BYTE_ORDER;
+  header->point_size = sizeof(curve_point);
+  header->window = window;
+  header->rows = (256 + window - 1) / window;
+  header->cols = 1 << (window - 1);
+  header->payload_offset = ECTABLE_HEADER_SIZE;
+  header->payload_size = payload_size;
+  bn_write_be(&curve->prime, header->prime);
+  header->base[0] = 0x04;
+  bn_write_be(&base->x, header->base + 1);
+  bn_write_be(&base->y, header->base + 33);
+  ripemd160((const uint8_t *)cp, (uint32_t)payload_size, header->checksum);
+
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    if (write_all(fd, header_page, ECTABLE_HEADER_SIZE) == 0 &&
+        write_all(fd, cp, payload_size) == 0 &&
+        fsync(fd) == 0) {
+      res = 0;
+    }
+    if (close(fd) != 0) {
+      res = 1;
+    }
+    if (res == 0 && rename(tmp_path, path) != 0) {
+      res = 1;
+    }
+    if (res != 0) {
+      unlink(tmp_path);
+    }
+  }
+  free(header_page);
+  free(cp);
+  return res;
+}
+
+static int check_header(const ectable_header *header, const ecdsa_curve *curve, size_t file_size, curve_point *base)
+{
+  uint8_t prime[32];
+
+  if (memcmp(header->magic, ECTABLE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != ECTABLE_VERSION ||
+      header->byte_order != ECTABLE_BYTE_ORDER ||
+      header->point_size != sizeof(curve_point)) {
+    return 1;
+  }
+  if (header->window < 2 || header->window > 8 ||
+      header->rows != (256 + header->window - 1) / header->window ||
+      header->cols != 1u << (header->window - 1) ||
+      header->payload_offset != ECTABLE_HEADER_SIZE ||
+      header->payload_size != ectable_size(header->window) ||
+      file_size < header->payload_offset + header->payload_size) {
+    return 1;
+  }
+  bn_write_be(&curve->prime, prime);
+  if (memcmp(prime, header->prime, sizeof(prime)) != 0) {
+    return 1;
+  }
+  if (!ecdsa_read_pubkey(curve, header->base, base)) {
+    return 1;
+  }
+  return 0;
+}
+
+// Maps size bytes of fd such that map + payload_offset is aligned to a
+// huge page, so the kernel can back the payload with huge pages.
+static void *map_aligned(int fd, size_t size, size_t payload_offset)
+{
+  uint8_t *reserved, *start, *end;
+  size_t reserved_size = size + ECTABLE_HUGE_PAGE;
+  void *map;
+
+  reserved = mmap(NULL, reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (reserved == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  start = (uint8_t *)(((uintptr_t)reserved + payload_offset + ECTABLE_HUGE_PAGE - 1) & ~(uintptr_t)(ECTABLE_HUGE_PAGE - 1)) - payload_offset;
+  end = reserved + reserved_size;
+  map = mmap(start, size, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0);
+  if (map == MAP_FAILED) {
+    munmap(reserved, reserved_size);
+    return MAP_FAILED;
+  }
+  // release the parts of the reservation around the table
+  if (start > reserved) {
+    munmap(reserved, start - reserved);
+  }
+  start += (size + getpagesize() - 1) & ~(size_t)(getpagesize() - 1);
+  if (start < end) {
+    munmap(start, end - start);
+  }
+  return map;
+}
+
+int ectable_map(const char *path, const ecdsa_curve *curve, int flags, ectable *table)
+{
+  ectable_header header;
+  uint8_t checksum[RIPEMD160_DIGEST_LENGTH];
+  struct stat st;
+  size_t size;
+  uint8_t *map;
+  int fd;
+
+  memset(table, 0, sizeof(*table));
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < ECTABLE_HEADER_SIZE ||
+      pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      check_header(&header, curve, st.st_size, &table->base) != 0) {
+    close(fd);
+    return 1;
+  }
+  size = header.payload_offset + header.payload_size;
+  if (header.payload_size >= ECTABLE_HUGE_PAGE) {
+    map = map_aligned(fd, size, header.payload_offset);
+  } else {
+    map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    return 1;
+  }
+#ifdef MADV_HUGEPAGE
+  if (header.payload_size >= ECTABLE_HUGE_PAGE) {
+    madvise(map + header.payload_offset, header.payload_size & ~(size_t)(ECTABLE_HUGE_PAGE - 1), MADV_HUGEPAGE);
+  }
+#endif
+#ifdef MADV_WILLNEED
+  madvise(map, size, MADV_WILLNEED);
+#endif
+
+  if (flags & ECTABLE_VERIFY_CHECKSUM) {
+    ripemd160(map + header.payload_offset, (uint32_t)header.payload_size, checksum);
+    if (memcmp(checksum, header.checksum, sizeof(checksum)) != 0) {
+      munmap(map, size);
+      return 1;
+    }
+  }
+
+  table->cp = (const curve_point *)(map + header.payload_offset);
+  table->window = header.window;
+  table->map = map;
+  table->map_size = size;
+  return 0;
+}
+
+void ectable_unmap(ectable *table)
+{
+  if (table->map != NULL) {
+    munmap(table->map, table->map_size);
+  }
+  memset(table, 0, sizeof(*table));
+}
+
+void ectable_multiply(const ecdsa_curve *curve, const ectable *table, const bignum256 *k, curve_point *res)
+{
+  comb_multiply(curve, table->cp, table->window, k, res);
+}
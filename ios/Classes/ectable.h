@@ -0,0 +1,75 @@
+//
+//  ectable.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Precomputed comb tables stored in binary files and mapped read-only.
+//
+//  A table file is a page sized header followed by the points in their
+//  in-memory representation, so a mapped table is used by comb_multiply
+//  as is.  The mapping is shared with every other process mapping the same
+//  file through the page cache.
+//
+
+#ifndef ectable_h
+#define ectable_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ecdsa.h"
+
+#define ECTABLE_MAGIC        "YOSECTAB"
+#define ECTABLE_VERSION      1
+#define ECTABLE_BYTE_ORDER   0x01020304
+#define ECTABLE_HEADER_SIZE  4096
+#define ECTABLE_HUGE_PAGE    (2 * 1024 * 1024)
+
+// flags for ectable_map
+#define ECTABLE_VERIFY_CHECKSUM  1  // hash the whole payload before use
+
+typedef struct {
+  char     magic[8];         // ECTABLE_MAGIC, not terminated
+  uint32_t version;          // ECTABLE_VERSION
+  uint32_t byte_order;       // ECTABLE_BYTE_ORDER as written by the host
+  uint32_t point_size;       // sizeof(curve_point)
+  uint32_t window;           // comb window, 2 .. 8
+  uint32_t rows;             // ceil(256 / window)
+  uint32_t cols;             // 2^(window - 1)
+  uint64_t payload_offset;   // ECTABLE_HEADER_SIZE
+  uint64_t payload_size;     // rows * cols * point_size
+  uint8_t  prime[32];        // field prime of the curve, big endian
+  uint8_t  base[65];         // uncompressed base point of the table
+  uint8_t  checksum[20];     // ripemd160 of the payload
+} ectable_header;
+
+typedef struct {
+  const curve_point *cp;     // rows * cols points, see comb_multiply
+  unsigned int window;
+  curve_point base;
+  void *map;                 // start of the mapping, NULL if not mapped
+  size_t map_size;
+} ectable;
+
+// Computes the comb table of base with the given window into cp, which
+// must hold ectable_size(window) / sizeof(curve_point) points.
+void ectable_build(const ecdsa_curve *curve, const curve_point *base, unsigned int window, curve_point *cp);
+size_t ectable_size(unsigned int window);
+
+// Builds the table of base and writes it to path.  The file is written
+// under a temporary name and renamed, so concurrent readers never map a
+// partial table.  returns 0 on success
+int ectable_write(const char *path, const ecdsa_curve *curve, const curve_point *base, unsigned int window);
+
+// Maps the table file at path read-only.  The header must match this
+// build and the curve, and the base point has to be on the curve.
+// returns 0 on success
+int ectable_map(const char *path, const ecdsa_curve *curve, int flags, ectable *table);
+void ectable_unmap(ectable *table);
+
+// res = k * table->base
+// k must be a normalized number with 0 <= k < curve->order
+void ectable_multiply(const ecdsa_curve *curve, const ectable *table, const bignum256 *k, curve_point *res);
+
+#endif /* ectable_h */
@@ -0,0 +1,58 @@
+//
+//  hmac.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include <string.h>
+#include "hmac.h"
+#include "memzero.h"
+
+void hmac_sha256_Init(HMAC_SHA256_CTX *hctx, const uint8_t *key, const uint32_t keylen)
+{
+  uint8_t i_key_pad[SHA256_BLOCK_LENGTH];
+  int i;
+  
+  memset(i_key_pad, 0, SHA256_BLOCK_LENGTH);
+  if (keylen > SHA256_BLOCK_LENGTH) {
+    sha256_Raw(key, keylen, i_key_pad);
+  } else {
+    memcpy(i_key_pad, key, keylen);
+  }
+  for (i = 0; i < SHA256_BLOCK_LENGTH; i++) {
+    hctx->o_key_pad[i] = i_key_pad[i] ^ 0x5c;
+    i_key_pad[i] ^= 0x36;
+  }
+  sha256_Init(&hctx->ctx);
+  sha256_Update(&hctx->ctx, i_key_pad, SHA256_BLOCK_LENGTH);
+  memzero(i_key_pad, sizeof(i_key_pad));
+}
+
+void hmac_sha256_Update(HMAC_SHA256_CTX *hctx, const uint8_t *msg, const uint32_t msglen)
+{
+  sha256_Update(&hctx->ctx, msg, msglen);
+}
+
+void hmac_sha256_Final(HMAC_SHA256_CTX *hctx, uint8_t *hmac)
+{
+  uint8_t hash[SHA256_DIGEST_LENGTH];
+  
+  sha256_Final(&hctx->ctx, hash);
+  sha256_Init(&hctx->ctx);
+  sha256_Update(&hctx->ctx, hctx->o_key_pad, SHA256_BLOCK_LENGTH);
+  sha256_Update(&hctx->ctx, hash, SHA256_DIGEST_LENGTH);
+  sha256_Final(&hctx->ctx, hmac);
+  memzero(hash, sizeof(hash));
+  memzero(hctx, sizeof(HMAC_SHA256_CTX));
+}
+
+void hmac_sha256(const uint8_t *key, const uint32_t keylen, const uint8_t *msg, const uint32_t msglen, uint8_t *hmac)
+{
+  HMAC_SHA256_CTX hctx;
+  
+  hmac_sha256_Init(&hctx, key, keylen);
+  hmac_sha256_Update(&hctx, msg, msglen);
+  hmac_sha256_Final(&hctx, hmac);
+}
@@ -0,0 +1,26 @@
+//
+//  hmac.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#ifndef hmac_h
+#define hmac_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha2.h"
+
+typedef struct {
+  uint8_t o_key_pad[SHA256_BLOCK_LENGTH];
+  SHA256_CTX ctx;
+} HMAC_SHA256_CTX;
+
+void hmac_sha256_Init(HMAC_SHA256_CTX *hctx, const uint8_t *key, const uint32_t keylen);
+void hmac_sha256_Update(HMAC_SHA256_CTX *hctx, const uint8_t *msg, const uint32_t msglen);
+void hmac_sha256_Final(HMAC_SHA256_CTX *hctx, uint8_t *hmac);
+void hmac_sha256(const uint8_t *key, const uint32_t keylen, const uint8_t *msg, const uint32_t msglen, uint8_t *hmac);
+
+#endif /* hmac_h */
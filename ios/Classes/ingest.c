@@ -0,0 +1,691 @@
+//
+//  ingest.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "ingest.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ecdsa.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "trx_digest.h"
+
+#define DEFAULT_QUEUE_CAPACITY 256
+#define DEFAULT_BATCH          16
+#define CACHE_LINE             64
+
+// Bounded multi-producer multi-consumer queue (D. Vyukov).  Every cell
+// carries a sequence number telling producers and consumers whose turn it
+// is, so enqueue and dequeue are one compare and swap on the position.
+typedef struct {
+  atomic_size_t seq;
+  ingest_trx *trx;
+} cell;
+
+typedef struct {
+  cell *cells;
+  size_t mask;
+  _Alignas(CACHE_LINE) atomic_size_t enqueue_pos;
+  _Alignas(CACHE_LINE) atomic_size_t dequeue_pos;
+} queue;
+
+typedef struct {
+  _Alignas(CACHE_LINE) atomic_uint_fast64_t items;
+  atomic_uint_fast64_t batches;
+  atomic_uint_fast64_t busy_ns;
+  atomic_uint_fast64_t stalls;
+  atomic_uint_fast64_t idle;
+} stage_counters;
+
+typedef struct ingest_worker ingest_worker;
+
+struct ingest_engine {
+  ingest_config config;
+  queue queues[INGEST_STAGES];       // input queue of every stage
+  stage_counters counters[INGEST_STAGES];
+  ingest_worker *workers;
+  unsigned int worker_count;
+  _Alignas(CACHE_LINE) atomic_uint_fast64_t submitted;
+  _Alignas(CACHE_LINE) atomic_uint_fast64_t completed;
+  atomic_int stopping;
+};
+
+// a signature of the current recover batch
+typedef struct {
+  ingest_trx *trx;
+  size_t sig;
+} sig_ref;
+
+struct ingest_worker {
+  ingest_engine *engine;
+  int stage;
+  pthread_t thread;
+  int started;
+  ingest_trx **items;
+
+  // recover stage
+  size_t sig_alloc;
+  sig_ref *refs;
+  uint8_t *sigs;
+  uint8_t *digests;
+  int *recids;
+  uint8_t *pub_keys;
+  int *results;
+
+  // authorize stage
+  authority_scratch *scratch;
+};
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Waits a little longer on every call: spin first, then give up the time
+// slice, then sleep, so an idle or blocked stage does not burn a core.
+static void backoff(unsigned int *spins)
+{
+  struct timespec ts;
+  unsigned int shift;
+
+  if (*spins < 16) {
+    for (shift = 0; shift < (1u << *spins); shift++) {
+      atomic_signal_fence(memory_order_seq_cst);
+    }
+  } else if (*spins < 32) {
+    sched_yield();
+  } else {
+    shift = *spins - 32 < 6 ? *spins - 32 : 6;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 16000L << shift;  // up to 1 ms
+    nanosleep(&ts, NULL);
+  }
+  (*spins)++;
+}
+
+static int queue_init(queue *q, size_t capacity)
+{
+  size_t size = 2, i;
+
+  while (size < capacity) {
+    size <<= 1;
+  }
+  q->cells = malloc(size * sizeof(cell));
+  if (q->cells == NULL) {
+    return 1;
+  }
+  for (i = 0; i < size; i++) {
+    atomic_init(&q->cells[i].seq, i);
+  }
+  q->mask = size - 1;
+  atomic_init(&q->enqueue_pos, 0);
+  atomic_init(&q->dequeue_pos, 0);
+  return 0;
+}
+
+// returns 0 on success, 1 if the queue is full
+static int queue_push(queue *q, ingest_trx *trx)
+{
+  size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+  cell *c;
+  intptr_t diff;
+
+  for (;;) {
+    c = &q->cells[pos & q->mask];
+    diff = (intptr_t)atomic_load_explicit(&c->seq, memory_order_acquire) - (intptr_t)pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return 1;
+    } else {
+      pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  c->trx = trx;
+  atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+  return 0;
+}
+
+// returns NULL if the queue is empty
+static ingest_trx *queue_pop(queue *q)
+{
+  size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+  ingest_trx *trx;
+  cell *c;
+  intptr_t diff;
+
+  for (;;) {
+    c = &q->cells[pos & q->mask];
+    diff = (intptr_t)atomic_load_explicit(&c->seq, memory_order_acquire) - (intptr_t)(pos + 1);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return NULL;
+    } else {
+      pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    }
+  }
+  trx = c->trx;
+  atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release);
+  return trx;
+}
+
+// -- parse --------------------------------------------------------------
+
+typedef struct {
+  const uint8_t *p;
+  const uint8_t *end;
+} reader;
+
+static int skip(reader *r, size_t len)
+{
+  if ((size_t)(r->end - r->p) < len) {
+    return 1;
+  }
+  r->p += len;
+  return 0;
+}
+
+static int read_uint64(reader *r, uint64_t *value)
+{
+  int i;
+
+  if (r->end - r->p < 8) {
+    return 1;
+  }
+  *value = 0;
+  for (i = 7; i >= 0; i--) {
+    *value = (*value << 8) | r->p[i];
+  }
+  r->p += 8;
+  return 0;
+}
+
+static int read_varuint(reader *r, uint32_t *value)
+{
+  uint64_t v = 0;
+  int shift = 0;
+  uint8_t b;
+
+  do {
+    if (r->p == r->end || shift > 28) {
+      return 1;
+    }
+    b = *r->p++;
+    v |= (uint64_t)(b & 0x7f) << shift;
+    shift += 7;
+  } while (b & 0x80);
+  if (v > 0xffffffffu) {
+    return 1;
+  }
+  *value = (uint32_t)v;
+  return 0;
+}
+
+static int skip_bytes(reader *r)
+{
+  uint32_t len;
+
+  return read_varuint(r, &len) || skip(r, len);
+}
+
+// Reads a vector of actions.  The authorizations are appended to
+// trx->levels if collect is set and must be absent otherwise.
+static int read_actions(reader *r, ingest_trx *trx, size_t *level_alloc, int collect)
+{
+  authority_level *levels;
+  uint32_t count, auth_count, i, j;
+
+  if (read_varuint(r, &count)) {
+    return 1;
+  }
+  for (i = 0; i < count; i++) {
+    // account, name
+    if (skip(r, 16) || read_varuint(r, &auth_count)) {
+      return 1;
+    }
+    if (auth_count > 0 && !collect) {
+      return 1;
+    }
+    if ((size_t)(r->end - r->p) / 16 < auth_count) {
+      return 1;
+    }
+    if (trx->level_count + auth_count > *level_alloc) {
+      *level_alloc = (trx->level_count + auth_count) * 2;
+      levels = realloc(trx->levels, *level_alloc * sizeof(authority_level));
+      if (levels == NULL) {
+        return -1;
+      }
+      trx->levels = levels;
+    }
+    for (j = 0; j < auth_count; j++) {
+      read_uint64(r, &trx->levels[trx->level_count].actor);
+      read_uint64(r, &trx->levels[trx->level_count].permission);
+      trx->level_count++;
+    }
+    if (skip_bytes(r)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void parse_trx(ingest_trx *trx)
+{
+  reader r = { trx->packed_trx, trx->packed_trx + trx->packed_trx_len };
+  size_t level_alloc = 0;
+  uint32_t value, count, i;
+  int res;
+
+  trx->levels = NULL;
+  trx->level_count = 0;
+  trx->status = INGEST_OK;
+  trx->expiration = 0;
+
+  if (trx->packed_trx_len >= 4) {
+    trx->expiration = (uint32_t)r.p[0] | (uint32_t)r.p[1] << 8 | (uint32_t)r.p[2] << 16 | (uint32_t)r.p[3] << 24;
+  }
+  // expiration, ref_block_num, ref_block_prefix, max_net_usage_words,
+  // max_cpu_usage_ms, delay_sec
+  res = skip(&r, 10) || read_varuint(&r, &value) || skip(&r, 1) || read_varuint(&r, &value);
+  // context free actions, actions
+  if (res == 0) {
+    res = read_actions(&r, trx, &level_alloc, 0);
+  }
+  if (res == 0) {
+    res = read_actions(&r, trx, &level_alloc, 1);
+  }
+  // transaction extensions
+  if (res == 0) {
+    res = read_varuint(&r, &count);
+    for (i = 0; res == 0 && i < count; i++) {
+      res = skip(&r, 2) || skip_bytes(&r);
+    }
+  }
+  if (res == 0 && r.p != r.end) {
+    res = 1;
+  }
+  if (res != 0) {
+    trx->status = res < 0 ? INGEST_ERR_MEMORY : INGEST_ERR_PARSE;
+  }
+}
+
+// -- recover ------------------------------------------------------------
+
+static int reserve_sigs(ingest_worker *w, size_t n)
+{
+  void *p;
+
+  if (n <= w->sig_alloc) {
+    return 0;
+  }
+  n *= 2;
+#define GROW(field, size) \
+  p = realloc(w->field, n * (size)); \
+  if (p == NULL) { \
+    return 1; \
+  } \
+  w->field = p;
+  GROW(refs, sizeof(sig_ref))
+  GROW(sigs, 64)
+  GROW(digests, 32)
+  GROW(recids, sizeof(int))
+  GROW(pub_keys, 65)
+  GROW(results, sizeof(int))
+#undef GROW
+  w->sig_alloc = n;
+  return 0;
+}
+
+// Recovers the keys of all signatures of the given key type in the batch
+// with one call to ecdsa_recover_pub_from_sig_batch.
+static void recover_keys(ingest_worker *w, ingest_trx **items, size_t n, uint8_t type)
+{
+  const ecdsa_curve *curve = type == AUTHORITY_KEY_K1 ? &secp256k1 : &secp256r1;
+  const uint8_t *sig;
+  size_t i, j, m = 0;
+  int recid;
+
+  for (i = 0; i < n; i++) {
+    if (items[i]->status != INGEST_OK) {
+      continue;
+    }
+    for (j = 0; j < items[i]->sig_count; j++) {
+      sig = items[i]->signatures + j * INGEST_SIGNATURE_SIZE;
+      if (sig[0] != type) {
+        continue;
+      }
+      recid = sig[1] - 27;
+      if (recid >= 4) {
+        recid -= 4;
+      }
+      if (recid < 0 || recid > 3) {
+        items[i]->status = INGEST_ERR_SIGNATURE;
+        break;
+      }
+      w->refs[m].trx = items[i];
+      w->refs[m].sig = j;
+      memcpy(w->sigs + 64 * m, sig + 2, 64);
+      memcpy(w->digests + 32 * m, items[i]->digest, 32);
+      w->recids[m] = recid;
+      m++;
+    }
+  }
+  if (m == 0) {
+    return;
+  }
+  ecdsa_recover_pub_from_sig_batch(curve, w->pub_keys, w->sigs, w->digests, w->recids, w->results, m);
+  for (i = 0; i < m; i++) {
+    if (w->results[i] != 0) {
+      w->refs[i].trx->status = INGEST_ERR_SIGNATURE;
+      continue;
+    }
+    w->refs[i].trx->keys[w->refs[i].sig].type = type;
+    ecdsa_compress_pubkey(w->pub_keys + 65 * i, w->refs[i].trx->keys[w->refs[i].sig].data);
+  }
+}
+
+static void recover_batch(ingest_worker *w, ingest_trx **items, size_t n)
+{
+  const uint8_t *sig;
+  size_t i, j, total = 0;
+
+  for (i = 0; i < n; i++) {
+    if (items[i]->status != INGEST_OK) {
+      continue;
+    }
+    for (j = 0; j < items[i]->sig_count; j++) {
+      sig = items[i]->signatures + j * INGEST_SIGNATURE_SIZE;
+      if (sig[0] != AUTHORITY_KEY_R1 && sig[0] != AUTHORITY_KEY_K1) {
+        items[i]->status = INGEST_ERR_SIGNATURE;
+        break;
+      }
+    }
+    total += items[i]->sig_count;
+  }
+  if (reserve_sigs(w, total) != 0) {
+    for (i = 0; i < n; i++) {
+      if (items[i]->status == INGEST_OK) {
+        items[i]->status = INGEST_ERR_MEMORY;
+      }
+    }
+    return;
+  }
+  recover_keys(w, items, n, AUTHORITY_KEY_R1);
+  recover_keys(w, items, n, AUTHORITY_KEY_K1);
+}
+
+// -- stages -------------------------------------------------------------
+
+static void process(ingest_worker *w, ingest_trx **items, size_t n)
+{
+  ingest_engine *engine = w->engine;
+  ingest_trx *trx;
+  uint32_t now = (uint32_t)time(NULL);
+  size_t i;
+  int res;
+
+  switch (w->stage) {
+    case INGEST_STAGE_PARSE:
+      for (i = 0; i < n; i++) {
+        parse_trx(items[i]);
+      }
+      break;
+    case INGEST_STAGE_DIGEST:
+      for (i = 0; i < n; i++) {
+        trx = items[i];
+        if (trx->status != INGEST_OK) {
+          continue;
+        }
+        trx_digest_id(engine->config.chain_id, trx->packed_trx, trx->packed_trx_len,
+                      trx->packed_cfd, trx->packed_cfd != NULL ? trx->packed_cfd_len : 0, trx->digest, trx->id);
+        // only drop ids already accepted, the id does not cover the
+        // signatures, so it is registered once the transaction passed
+        if (engine->config.ids != NULL && trx_index_contains(engine->config.ids, trx->id, now)) {
+          trx->status = INGEST_ERR_DUPLICATE;
+        }
+      }
+      break;
+    case INGEST_STAGE_RECOVER:
+      recover_batch(w, items, n);
+      break;
+    case INGEST_STAGE_AUTHORIZE:
+      for (i = 0; i < n; i++) {
+        trx = items[i];
+        if (trx->status == INGEST_OK && engine->config.authority != NULL) {
+          res = authority_check_scratch(engine->config.authority, w->scratch, trx->keys, trx->sig_count,
+                                        trx->levels, trx->level_count, NULL);
+          if (res != 0) {
+            trx->status = res < 0 ? INGEST_ERR_MEMORY : INGEST_ERR_UNAUTHORIZED;
+          }
+        }
+        // a copy accepted since the digest stage makes this one a duplicate
+        if (trx->status == INGEST_OK && engine->config.ids != NULL &&
+            trx_index_insert(engine->config.ids, trx->id, trx->expiration, now) != 0) {
+          trx->status = INGEST_ERR_DUPLICATE;
+        }
+        if (engine->config.done != NULL) {
+          engine->config.done(trx, engine->config.done_ctx);
+        }
+        free(trx->levels);
+        trx->levels = NULL;
+        trx->level_count = 0;
+      }
+      atomic_fetch_add_explicit(&engine->completed, n, memory_order_release);
+      break;
+  }
+}
+
+static void *worker_main(void *arg)
+{
+  ingest_worker *w = arg;
+  ingest_engine *engine = w->engine;
+  stage_counters *counters = &engine->counters[w->stage];
+  queue *in = &engine->queues[w->stage];
+  queue *out = w->stage + 1 < INGEST_STAGES ? &engine->queues[w->stage + 1] : NULL;
+  size_t batch = engine->config.batch[w->stage], n, i;
+  unsigned int spins = 0;
+  uint64_t start, stalls;
+
+  for (;;) {
+    for (n = 0; n < batch; n++) {
+      w->items[n] = queue_pop(in);
+      if (w->items[n] == NULL) {
+        break;
+      }
+    }
+    if (n == 0) {
+      if (atomic_load_explicit(&engine->stopping, memory_order_acquire)) {
+        break;
+      }
+      atomic_fetch_add_explicit(&counters->idle, 1, memory_order_relaxed);
+      backoff(&spins);
+      continue;
+    }
+    spins = 0;
+
+    start = now_ns();
+    process(w, w->items, n);
+    atomic_fetch_add_explicit(&counters->busy_ns, now_ns() - start, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->items, n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->batches, 1, memory_order_relaxed);
+
+    if (out != NULL) {
+      stalls = 0;
+      for (i = 0; i < n; i++) {
+        while (queue_push(out, w->items[i]) != 0) {
+          stalls++;
+          backoff(&spins);
+        }
+        spins = 0;
+      }
+      if (stalls > 0) {
+        atomic_fetch_add_explicit(&counters->stalls, stalls, memory_order_relaxed);
+      }
+    }
+  }
+  return NULL;
+}
+
+static void stop_workers(ingest_engine *engine)
+{
+  unsigned int i;
+
+  atomic_store_explicit(&engine->stopping, 1, memory_order_release);
+  for (i = 0; i < engine->worker_count; i++) {
+    if (engine->workers[i].started) {
+      pthread_join(engine->workers[i].thread, NULL);
+    }
+  }
+}
+
+static void free_engine(ingest_engine *engine)
+{
+  ingest_worker *w;
+  unsigned int i;
+
+  for (i = 0; i < engine->worker_count; i++) {
+    w = &engine->workers[i];
+    free(w->items);
+    free(w->refs);
+    free(w->sigs);
+    free(w->digests);
+    free(w->recids);
+    free(w->pub_keys);
+    free(w->results);
+    authority_scratch_free(w->scratch);
+  }
+  for (i = 0; i < INGEST_STAGES; i++) {
+    free(engine->queues[i].cells);
+  }
+  free(engine->workers);
+  free(engine);
+}
+
+ingest_engine *ingest_start(const ingest_config *config)
+{
+  ingest_engine *engine;
+  ingest_worker *w;
+  size_t capacity;
+  unsigned int i, j, k;
+
+  // the counters are cache line aligned, which malloc does not guarantee
+  if (posix_memalign((void **)&engine, CACHE_LINE, sizeof(ingest_engine)) != 0) {
+    return NULL;
+  }
+  memset(engine, 0, sizeof(ingest_engine));
+  engine->config = *config;
+  capacity = config->queue_capacity != 0 ? config->queue_capacity : DEFAULT_QUEUE_CAPACITY;
+  for (i = 0; i < INGEST_STAGES; i++) {
+    if (engine->config.threads[i] == 0) {
+      engine->config.threads[i] = 1;
+    }
+    if (engine->config.batch[i] == 0) {
+      engine->config.batch[i] = DEFAULT_BATCH;
+    }
+    engine->worker_count += engine->config.threads[i];
+    if (queue_init(&engine->queues[i], capacity) != 0) {
+      free_engine(engine);
+      return NULL;
+    }
+  }
+  atomic_init(&engine->submitted, 0);
+  atomic_init(&engine->completed, 0);
+  atomic_init(&engine->stopping, 0);
+
+  engine->workers = calloc(engine->worker_count, sizeof(ingest_worker));
+  if (engine->workers == NULL) {
+    engine->worker_count = 0;
+    free_engine(engine);
+    return NULL;
+  }
+  for (i = 0, k = 0; i < INGEST_STAGES; i++) {
+    for (j = 0; j < engine->config.threads[i]; j++, k++) {
+      w = &engine->workers[k];
+      w->engine = engine;
+      w->stage = i;
+      w->items = malloc(engine->config.batch[i] * sizeof(ingest_trx *));
+      if (w->items == NULL) {
+        free_engine(engine);
+        return NULL;
+      }
+      if (i == INGEST_STAGE_AUTHORIZE) {
+        w->scratch = authority_scratch_new();
+        if (w->scratch == NULL) {
+          free_engine(engine);
+          return NULL;
+        }
+      }
+    }
+  }
+  for (k = 0; k < engine->worker_count; k++) {
+    w = &engine->workers[k];
+    if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+      stop_workers(engine);
+      free_engine(engine);
+      return NULL;
+    }
+    w->started = 1;
+  }
+  return engine;
+}
+
+void ingest_submit(ingest_engine *engine, ingest_trx *trx)
+{
+  unsigned int spins = 0;
+
+  atomic_fetch_add_explicit(&engine->submitted, 1, memory_order_relaxed);
+  while (queue_push(&engine->queues[INGEST_STAGE_PARSE], trx) != 0) {
+    backoff(&spins);
+  }
+}
+
+void ingest_wait(ingest_engine *engine)
+{
+  unsigned int spins = 0;
+
+  while (atomic_load_explicit(&engine->completed, memory_order_acquire) !=
+         atomic_load_explicit(&engine->submitted, memory_order_relaxed)) {
+    backoff(&spins);
+  }
+}
+
+void ingest_stats(const ingest_engine *engine, ingest_stage_stats stats[INGEST_STAGES])
+{
+  const stage_counters *c;
+  int i;
+
+  for (i = 0; i < INGEST_STAGES; i++) {
+    c = &engine->counters[i];
+    stats[i].items = atomic_load_explicit(&c->items, memory_order_relaxed);
+    stats[i].batches = atomic_load_explicit(&c->batches, memory_order_relaxed);
+    stats[i].busy_ns = atomic_load_explicit(&c->busy_ns, memory_order_relaxed);
+    stats[i].stalls = atomic_load_explicit(&c->stalls, memory_order_relaxed);
+    stats[i].idle = atomic_load_explicit(&c->idle, memory_order_relaxed);
+  }
+}
+
+void ingest_stop(ingest_engine *engine)
+{
+  if (engine == NULL) {
+    return;
+  }
+  ingest_wait(engine);
+  stop_workers(engine);
+  free_engine(engine);
+}
@@ -0,0 +1,108 @@
+//
+//  ingest.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Pipelined validation of signed transactions:
+//
+//    parse -> digest -> recover -> authorize -> done callback
+//
+//  The digest stage also computes the transaction id and, given an id
+//  index, drops transactions already accepted before any signature work.
+//  Ids enter the index only in the authorize stage, once a transaction
+//  passed, as the id does not cover the signatures.
+//
+//  Every stage runs on its own threads and hands transactions to the next
+//  stage through a bounded lock-free queue.  A stage takes up to its batch
+//  size of transactions at once; the recover stage recovers all signatures
+//  of a batch together so they share their field inversions.  A full queue
+//  makes the stage in front of it wait (backpressure), down to
+//  ingest_submit.
+//
+
+#ifndef ingest_h
+#define ingest_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "authority.h"
+#include "trx_index.h"
+
+#define INGEST_STAGE_PARSE     0
+#define INGEST_STAGE_DIGEST    1
+#define INGEST_STAGE_RECOVER   2
+#define INGEST_STAGE_AUTHORIZE 3
+#define INGEST_STAGES          4
+
+// ingest_trx.status
+#define INGEST_OK                0
+#define INGEST_ERR_PARSE         1  // malformed packed transaction
+#define INGEST_ERR_SIGNATURE     2  // a signature could not be recovered
+#define INGEST_ERR_UNAUTHORIZED  3  // the keys do not satisfy an authorization
+#define INGEST_ERR_MEMORY        4
+#define INGEST_ERR_DUPLICATE     5  // a transaction with this id was accepted
+
+// key type byte followed by a compact signature (header | r | s)
+#define INGEST_SIGNATURE_SIZE 66
+
+typedef struct {
+  // set by the caller
+  const uint8_t *packed_trx;
+  size_t packed_trx_len;
+  const uint8_t *packed_cfd;      // packed context free data, NULL if none
+  size_t packed_cfd_len;
+  const uint8_t *signatures;      // sig_count * INGEST_SIGNATURE_SIZE bytes
+  size_t sig_count;
+  authority_key *keys;            // sig_count entries for the recovered keys
+  void *user;
+
+  // set by the pipeline, valid in the done callback
+  uint8_t digest[32];
+  uint8_t id[32];                 // sha256 of packed_trx
+  uint32_t expiration;
+  authority_level *levels;        // authorizations of all actions
+  size_t level_count;
+  int status;                     // INGEST_OK or INGEST_ERR_*
+} ingest_trx;
+
+typedef struct {
+  uint8_t chain_id[32];
+  const authority_index *authority;  // NULL to skip the authority check
+  trx_index *ids;                    // NULL to skip duplicate detection
+  unsigned int threads[INGEST_STAGES];   // 0 for one thread
+  unsigned int batch[INGEST_STAGES];     // 0 for the default batch size
+  unsigned int queue_capacity;           // rounded up to a power of two
+
+  // Called on an authorize thread for every transaction in no particular
+  // order.  levels are freed when it returns.
+  void (*done)(ingest_trx *trx, void *ctx);
+  void *done_ctx;
+} ingest_config;
+
+typedef struct {
+  uint64_t items;      // transactions processed
+  uint64_t batches;    // dequeues that returned work
+  uint64_t busy_ns;    // time spent processing batches
+  uint64_t stalls;     // waits for room in the next queue
+  uint64_t idle;       // waits for work
+} ingest_stage_stats;
+
+typedef struct ingest_engine ingest_engine;
+
+ingest_engine *ingest_start(const ingest_config *config);
+
+// Queues trx for validation, waiting while the pipeline is full.
+// trx must stay valid until its done callback.
+void ingest_submit(ingest_engine *engine, ingest_trx *trx);
+
+// Waits until every submitted transaction is done.
+void ingest_wait(ingest_engine *engine);
+
+void ingest_stats(const ingest_engine *engine, ingest_stage_stats stats[INGEST_STAGES]);
+
+// Waits for pending transactions, stops the threads and frees the engine.
+void ingest_stop(ingest_engine *engine);
+
+#endif /* ingest_h */
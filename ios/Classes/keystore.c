@@ -0,0 +1,554 @@
+//
+//  keystore.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "keystore.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "authority.h"
+#include "base58.h"
+#include "ecdsa.h"
+#include "ripemd160.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+
+// "PUB_R1_" or "PUB_K1_"
+#define KEY_PREFIX_LENGTH  7
+
+// a valid key is encoded in at least 37 base58 digits, one per byte of key
+// and checksum at best
+#define KEY_MIN_DIGITS     37
+
+// snapshot bytes per parsing thread at least
+#define MIN_CHUNK_SIZE     65536
+
+typedef struct {
+  const ecdsa_curve *curve;
+  const char *prefix;
+  const char *suffix;          // of the checksum, "R1" or "K1"
+  int binary;
+  const uint8_t *data;         // the whole snapshot
+  const uint8_t *begin, *end;  // the chunk of this worker
+  uint8_t *keys;               // valid keys of the chunk, sorted when done
+  size_t count;
+  uint64_t found;
+  uint64_t invalid;
+} import_worker;
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static unsigned int online_cpus(void)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return cpus > 1 ? (unsigned int)cpus : 1;
+}
+
+static size_t peak_rss(void)
+{
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return (size_t)usage.ru_maxrss;
+#else
+  // kilobytes on Linux
+  return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+static inline uint64_t mix64(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Part of the file format: stores of another byte order are rejected by
+// the header check, so the host order of the load does not matter.
+static inline uint32_t key_hash(const uint8_t *key)
+{
+  uint64_t x;
+  // the x coordinate is already uniformly distributed
+  memcpy(&x, key + 1, sizeof(x));
+  return (uint32_t)mix64(x ^ key[0]);
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+  return memcmp(a, b, KEYSTORE_KEY_SIZE);
+}
+
+static uint64_t index_slots(uint64_t count)
+{
+  uint64_t slots = 1;
+
+  while (slots < 2 * count) {
+    slots <<= 1;
+  }
+  return slots;
+}
+
+static uint64_t index_offset(uint64_t count)
+{
+  return (count * KEYSTORE_KEY_SIZE + 7) & ~(uint64_t)7;
+}
+
+// parsing
+
+static inline int is_token_char(uint8_t c)
+{
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+static void add_key(import_worker *w, const uint8_t *key)
+{
+  if (ecdsa_validate_compressed_pubkey(w->curve, key)) {
+    memcpy(w->keys + KEYSTORE_KEY_SIZE * w->count++, key, KEYSTORE_KEY_SIZE);
+  } else {
+    w->invalid++;
+  }
+}
+
+static void parse_binary(import_worker *w)
+{
+  const uint8_t *p;
+
+  for (p = w->begin; p < w->end; p += KEYSTORE_KEY_SIZE) {
+    w->found++;
+    add_key(w, p);
+  }
+}
+
+// Keys are tokens starting with the prefix, up to the first character that
+// cannot be part of a token.  Other PUB_ tokens are skipped as a whole.
+static void parse_text(import_worker *w)
+{
+  const uint8_t *p = w->begin, *end = w->end, *digits;
+  uint8_t key[KEYSTORE_KEY_SIZE];
+
+  while (p < end && (p = memchr(p, 'P', end - p)) != NULL) {
+    if (end - p < KEY_PREFIX_LENGTH || memcmp(p, "PUB_", 4) != 0 ||
+        (p > w->data && is_token_char(p[-1]))) {
+      p++;
+      continue;
+    }
+    digits = p + KEY_PREFIX_LENGTH;
+    for (p = digits; p < end && is_token_char(*p); p++) {
+    }
+    if (memcmp(digits - KEY_PREFIX_LENGTH, w->prefix, KEY_PREFIX_LENGTH) != 0) {
+      continue;
+    }
+    w->found++;
+    if (p > digits && b58decWithChecksum(key, sizeof(key), (const char *)digits, p - digits, w->suffix)) {
+      add_key(w, key);
+    } else {
+      w->invalid++;
+    }
+  }
+}
+
+static void *import_worker_main(void *arg)
+{
+  import_worker *w = arg;
+
+  if (w->binary) {
+    parse_binary(w);
+  } else {
+    parse_text(w);
+  }
+  qsort(w->keys, w->count, KEYSTORE_KEY_SIZE, compare_keys);
+  return NULL;
+}
+
+// The first chunk boundary at or after pos that does not split a key.
+static const uint8_t *chunk_boundary(const uint8_t *data, size_t size, size_t pos, int binary)
+{
+  if (binary) {
+    return data + pos - pos % KEYSTORE_KEY_SIZE;
+  }
+  while (pos < size && is_token_char(data[pos])) {
+    pos++;
+  }
+  return data + pos;
+}
+
+// Merges the sorted keys of the workers into keys and drops duplicates.
+// returns the number of distinct keys
+static size_t merge_keys(const import_worker *workers, unsigned int n, uint8_t *keys)
+{
+  size_t pos[KEYSTORE_MAX_THREADS] = { 0 }, count = 0;
+  const uint8_t *min, *key;
+  unsigned int i, best = 0;
+
+  for (;;) {
+    min = NULL;
+    for (i = 0; i < n; i++) {
+      if (pos[i] < workers[i].count) {
+        key = workers[i].keys + KEYSTORE_KEY_SIZE * pos[i];
+        if (min == NULL || memcmp(key, min, KEYSTORE_KEY_SIZE) < 0) {
+          min = key;
+          best = i;
+        }
+      }
+    }
+    if (min == NULL) {
+      return count;
+    }
+    pos[best]++;
+    if (count == 0 || memcmp(keys + KEYSTORE_KEY_SIZE * (count - 1), min, KEYSTORE_KEY_SIZE) != 0) {
+      memcpy(keys + KEYSTORE_KEY_SIZE * count++, min, KEYSTORE_KEY_SIZE);
+    }
+  }
+}
+
+// writing
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+  const uint8_t *p = buf;
+  ssize_t n;
+
+  while (len > 0) {
+    n = write(fd, p, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+static void hash_update(RIPEMD160_CTX *ctx, const uint8_t *data, size_t len)
+{
+  uint32_t n;
+
+  while (len > 0) {
+    n = len > 0x40000000 ? 0x40000000 : (uint32_t)len;
+    ripemd160_Update(ctx, data, n);
+    data += n;
+    len -= n;
+  }
+}
+
+static int write_store(const char *path, uint8_t key_type, const uint8_t *keys, size_t count)
+{
+  static const uint8_t padding[8];
+  uint8_t *header_page;
+  keystore_header *header;
+  uint32_t *slots, mask, i;
+  RIPEMD160_CTX ctx;
+  char tmp_path[1024];
+  size_t keys_size = count * KEYSTORE_KEY_SIZE, pad = index_offset(count) - keys_size;
+  size_t nslots = index_slots(count);
+  int fd, res = 1;
+
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp_path)) {
+    return 1;
+  }
+  header_page = calloc(1, KEYSTORE_HEADER_SIZE);
+  slots = calloc(nslots, sizeof(uint32_t));
+  if (header_page == NULL || slots == NULL) {
+    free(header_page);
+    free(slots);
+    return 1;
+  }
+  mask = (uint32_t)(nslots - 1);
+  for (i = 0; i < count; i++) {
+    uint32_t j = key_hash(keys + KEYSTORE_KEY_SIZE * i) & mask;
+    while (slots[j] != 0) {
+      j = (j + 1) & mask;
+    }
+    slots[j] = i + 1;
+  }
+
+  header = (keystore_header *)header_page;
+  memcpy(header->magic, KEYSTORE_MAGIC, sizeof(header->magic));
+  header->version = KEYSTORE_VERSION;
+  header->byte_order = KEYSTORE_BYTE_ORDER;
+  header->key_type = key_type;
+  header->key_size = KEYSTORE_KEY_SIZE;
+  header->count = count;
+  header->index_slots = nslots;
+  header->payload_offset = KEYSTORE_HEADER_SIZE;
+  header->index_offset = index_offset(count);
+  header->payload_size = header->index_offset + nslots * sizeof(uint32_t);
+  ripemd160_Init(&ctx);
+  hash_update(&ctx, keys, keys_size);
+  hash_update(&ctx, padding, pad);
+  hash_update(&ctx, (const uint8_t *)slots, nslots * sizeof(uint32_t));
+  ripemd160_Final(&ctx, header->checksum);
+
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    if (write_all(fd, header_page, KEYSTORE_HEADER_SIZE) == 0 &&
+        write_all(fd, keys, keys_size) == 0 &&
+        write_all(fd, padding, pad) == 0 &&
+        write_all(fd, slots, nslots * sizeof(uint32_t)) == 0 &&
+        fsync(fd) == 0) {
+      res = 0;
+    }
+    if (close(fd) != 0) {
+      res = 1;
+    }
+    if (res == 0 && rename(tmp_path, path) != 0) {
+      res = 1;
+    }
+    if (res != 0) {
+      unlink(tmp_path);
+    }
+  }
+  free(header_page);
+  free(slots);
+  return res;
+}
+
+int keystore_import(const char *snapshot, const char *path, uint8_t key_type, unsigned int threads, int flags, keystore_import_stats *stats)
+{
+  import_worker workers[KEYSTORE_MAX_THREADS];
+  pthread_t thread_ids[KEYSTORE_MAX_THREADS];
+  int started[KEYSTORE_MAX_THREADS];
+  const int binary = flags & KEYSTORE_BINARY_SNAPSHOT;
+  const uint64_t start = now_ns();
+  const uint8_t *data = NULL, *prev;
+  uint8_t *keys = NULL;
+  struct stat st;
+  size_t size, capacity, total = 0, count = 0;
+  unsigned int n, i;
+  int fd, res = 1;
+
+  if (key_type != AUTHORITY_KEY_R1 && key_type != AUTHORITY_KEY_K1) {
+    return 1;
+  }
+  fd = open(snapshot, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+  if (fstat(fd, &st) != 0 || (binary && st.st_size % KEYSTORE_KEY_SIZE != 0)) {
+    close(fd);
+    return 1;
+  }
+  size = st.st_size;
+  if (size > 0) {
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    return 1;
+  }
+#ifdef MADV_SEQUENTIAL
+  if (size > 0) {
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+  }
+#endif
+
+  if (threads == 0) {
+    threads = online_cpus();
+  }
+  if (threads > KEYSTORE_MAX_THREADS) {
+    threads = KEYSTORE_MAX_THREADS;
+  }
+  n = size == 0 ? 0 : (unsigned int)(size / MIN_CHUNK_SIZE + 1 < threads ? size / MIN_CHUNK_SIZE + 1 : threads);
+
+  memset(workers, 0, sizeof(workers));
+  prev = data;
+  for (i = 0; i < n; i++) {
+    import_worker *w = &workers[i];
+    w->curve = key_type == AUTHORITY_KEY_K1 ? &secp256k1 : &secp256r1;
+    w->prefix = key_type == AUTHORITY_KEY_K1 ? "PUB_K1_" : "PUB_R1_";
+    w->suffix = key_type == AUTHORITY_KEY_K1 ? "K1" : "R1";
+    w->binary = binary;
+    w->data = data;
+    w->begin = prev;
+    w->end = i + 1 == n ? data + size : chunk_boundary(data, size, size / n * (i + 1), binary);
+    if (w->end < w->begin) {
+      w->end = w->begin;
+    }
+    prev = w->end;
+    // every stored key takes at least this much of the chunk
+    capacity = binary ? (w->end - w->begin) / KEYSTORE_KEY_SIZE
+                      : (w->end - w->begin) / (KEY_PREFIX_LENGTH + KEY_MIN_DIGITS) + 1;
+    w->keys = malloc(capacity * KEYSTORE_KEY_SIZE);
+    if (w->keys == NULL) {
+      goto done;
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    // the calling thread takes the first chunk
+    started[i] = i > 0 && pthread_create(&thread_ids[i], NULL, import_worker_main, &workers[i]) == 0;
+  }
+  for (i = 0; i < n; i++) {
+    if (!started[i]) {
+      import_worker_main(&workers[i]);
+    }
+  }
+  for (i = 0; i < n; i++) {
+    if (started[i]) {
+      pthread_join(thread_ids[i], NULL);
+    }
+    total += workers[i].count;
+  }
+
+  if (total > KEYSTORE_MAX_KEYS) {
+    goto done;
+  }
+  keys = malloc(total > 0 ? total * KEYSTORE_KEY_SIZE : 1);
+  if (keys == NULL) {
+    goto done;
+  }
+  count = merge_keys(workers, n, keys);
+  for (i = 0; i < n; i++) {
+    free(workers[i].keys);
+    workers[i].keys = NULL;
+  }
+  res = write_store(path, key_type, keys, count);
+
+  if (stats != NULL) {
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < n; i++) {
+      stats->found += workers[i].found;
+      stats->invalid += workers[i].invalid;
+    }
+    stats->stored = count;
+    stats->threads = n;
+    stats->seconds = (now_ns() - start) / 1e9;
+    stats->keys_per_second = stats->seconds > 0 ? stats->found / stats->seconds : 0;
+    stats->peak_rss = peak_rss();
+  }
+
+done:
+  for (i = 0; i < n; i++) {
+    free(workers[i].keys);
+  }
+  free(keys);
+  if (size > 0) {
+    munmap((void *)data, size);
+  }
+  return res;
+}
+
+// mapping
+
+static int check_header(const keystore_header *header, uint8_t key_type, size_t file_size)
+{
+  if (memcmp(header->magic, KEYSTORE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != KEYSTORE_VERSION ||
+      header->byte_order != KEYSTORE_BYTE_ORDER ||
+      header->key_size != KEYSTORE_KEY_SIZE ||
+      header->key_type != key_type) {
+    return 1;
+  }
+  if (header->count > KEYSTORE_MAX_KEYS ||
+      header->index_slots != index_slots(header->count) ||
+      header->payload_offset != KEYSTORE_HEADER_SIZE ||
+      header->index_offset != index_offset(header->count) ||
+      header->payload_size != header->index_offset + header->index_slots * sizeof(uint32_t) ||
+      file_size < header->payload_offset + header->payload_size) {
+    return 1;
+  }
+  return 0;
+}
+
+int keystore_map(const char *path, uint8_t key_type, int flags, keystore *store)
+{
+  keystore_header header;
+  uint8_t checksum[RIPEMD160_DIGEST_LENGTH];
+  struct stat st;
+  size_t size;
+  uint8_t *map;
+  int fd;
+
+  memset(store, 0, sizeof(*store));
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < KEYSTORE_HEADER_SIZE ||
+      pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      check_header(&header, key_type, st.st_size) != 0) {
+    close(fd);
+    return 1;
+  }
+  size = header.payload_offset + header.payload_size;
+  map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return 1;
+  }
+
+  if (flags & KEYSTORE_VERIFY_CHECKSUM) {
+    RIPEMD160_CTX ctx;
+    ripemd160_Init(&ctx);
+    hash_update(&ctx, map + header.payload_offset, header.payload_size);
+    ripemd160_Final(&ctx, checksum);
+    if (memcmp(checksum, header.checksum, sizeof(checksum)) != 0) {
+      munmap(map, size);
+      return 1;
+    }
+  }
+#ifdef MADV_RANDOM
+  // a lookup touches one slot and one key, read ahead would be wasted
+  madvise(map, size, MADV_RANDOM);
+#endif
+
+  store->keys = map + header.payload_offset;
+  store->slots = (const uint32_t *)(map + header.payload_offset + header.index_offset);
+  store->count = header.count;
+  store->mask = (uint32_t)(header.index_slots - 1);
+  store->key_type = key_type;
+  store->map = map;
+  store->map_size = size;
+  return 0;
+}
+
+void keystore_unmap(keystore *store)
+{
+  if (store->map != NULL) {
+    munmap(store->map, store->map_size);
+  }
+  memset(store, 0, sizeof(*store));
+}
+
+int64_t keystore_find(const keystore *store, const uint8_t *key)
+{
+  uint32_t i = key_hash(key) & store->mask, slot, probes;
+
+  // bounded, so that a damaged index cannot make a lookup loop or read
+  // outside the keys
+  for (probes = 0; probes <= store->mask && (slot = store->slots[i]) != 0 && slot <= store->count; probes++) {
+    if (memcmp(store->keys + KEYSTORE_KEY_SIZE * (size_t)(slot - 1), key, KEYSTORE_KEY_SIZE) == 0) {
+      return slot - 1;
+    }
+    i = (i + 1) & store->mask;
+  }
+  return -1;
+}
@@ -0,0 +1,102 @@
+//
+//  keystore.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Compact stores of public keys in binary files that are mapped read-only.
+//
+//  keystore_import reads a permission snapshot once, decoding and
+//  validating its keys on several threads, and writes the distinct valid
+//  keys as a store: a page sized header, the 33 byte compressed keys in
+//  ascending byte order and an open addressing index over them.  Later
+//  starts map the store and look keys up in place, without any parsing:
+//
+//    keystore store;
+//    if (keystore_map(path, AUTHORITY_KEY_R1, 0, &store) != 0) {
+//      keystore_import(snapshot, path, AUTHORITY_KEY_R1, 0, 0, NULL);
+//      keystore_map(path, AUTHORITY_KEY_R1, 0, &store);
+//    }
+//    keystore_find(&store, key);
+//
+//  tools/yoskeys.c imports and checks stores on demand.
+//
+
+#ifndef keystore_h
+#define keystore_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define KEYSTORE_MAGIC        "YOSKEYST"
+#define KEYSTORE_VERSION      1
+#define KEYSTORE_BYTE_ORDER   0x01020304
+#define KEYSTORE_HEADER_SIZE  4096
+#define KEYSTORE_KEY_SIZE     33
+#define KEYSTORE_MAX_KEYS     0x7FFFFFFF
+#define KEYSTORE_MAX_THREADS  16
+
+// flags for keystore_import
+#define KEYSTORE_BINARY_SNAPSHOT  1  // the snapshot is a sequence of compressed keys
+
+// flags for keystore_map
+#define KEYSTORE_VERIFY_CHECKSUM  1  // hash the whole payload before use
+
+typedef struct {
+  char     magic[8];         // KEYSTORE_MAGIC, not terminated
+  uint32_t version;          // KEYSTORE_VERSION
+  uint32_t byte_order;       // KEYSTORE_BYTE_ORDER as written by the host
+  uint32_t key_type;         // AUTHORITY_KEY_* of every key
+  uint32_t key_size;         // KEYSTORE_KEY_SIZE
+  uint64_t count;            // number of keys
+  uint64_t index_slots;      // smallest power of two >= 2 * count
+  uint64_t payload_offset;   // KEYSTORE_HEADER_SIZE
+  uint64_t index_offset;     // count * key_size rounded up to 8, within the payload
+  uint64_t payload_size;     // index_offset + index_slots * 4
+  uint8_t  checksum[20];     // ripemd160 of the payload
+} keystore_header;
+
+typedef struct {
+  const uint8_t *keys;       // count keys of KEYSTORE_KEY_SIZE bytes, sorted
+  const uint32_t *slots;     // position + 1 of a key, 0 for an empty slot
+  size_t count;
+  uint32_t mask;             // index_slots - 1
+  uint8_t key_type;
+  void *map;                 // start of the mapping, NULL if not mapped
+  size_t map_size;
+} keystore;
+
+typedef struct {
+  uint64_t found;            // keys of the imported type in the snapshot
+  uint64_t invalid;          // of those, undecodable, with a bad checksum or off the curve
+  uint64_t stored;           // distinct valid keys in the store
+  unsigned int threads;      // threads that parsed the snapshot
+  double seconds;            // wall time of the whole import
+  double keys_per_second;    // found / seconds
+  size_t peak_rss;           // peak resident memory of the process, bytes
+} keystore_import_stats;
+
+// Imports the keys of key_type (AUTHORITY_KEY_*) from the snapshot file
+// into a new store at path.  A text snapshot is scanned for PUB_R1_ or
+// PUB_K1_ keys, so it may hold a key per line as well as a richer dump such
+// as JSON; keys of the other type are skipped.  The snapshot is mapped and
+// split into chunks for up to threads threads (0 for one per online
+// processor, at most KEYSTORE_MAX_THREADS).  Invalid keys are left out and
+// counted in stats, which may be NULL.  The store is written under a
+// temporary name and renamed, so concurrent readers never map a partial
+// store.
+// returns 0 on success
+int keystore_import(const char *snapshot, const char *path, uint8_t key_type, unsigned int threads, int flags, keystore_import_stats *stats);
+
+// Maps the store at path read-only.  The header must match this build and
+// key_type.
+// returns 0 on success
+int keystore_map(const char *path, uint8_t key_type, int flags, keystore *store);
+void keystore_unmap(keystore *store);
+
+// returns the position of the compressed key in store->keys, or -1 if the
+// store does not hold it
+int64_t keystore_find(const keystore *store, const uint8_t *key);
+
+#endif /* keystore_h */
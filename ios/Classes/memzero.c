@@ -6,10 +6,27 @@
 //  Copyright © 2019 Joe Park. All rights reserved.
 //
 
+#ifndef __STDC_WANT_LIB_EXT1__
+#define __STDC_WANT_LIB_EXT1__ 1  // memset_s
+#endif
+
 #include "memzero.h"
 #include <string.h>
 
+// A plain memset of memory that is not read again may be removed by the
+// compiler, so use a zeroing function it has to keep where there is one,
+// and otherwise hide the buffer from the optimizer behind a barrier.
 void memzero(void *s, size_t n)
 {
+  if (n == 0) {
+    return;
+  }
+#if defined(__APPLE__) || defined(__STDC_LIB_EXT1__)
+  memset_s(s, n, 0, n);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+  explicit_bzero(s, n);
+#else
   memset(s, 0, n);
+  __asm__ __volatile__("" : : "r"(s) : "memory");
+#endif
 }
@@ -7,6 +7,10 @@
 //
 
 #include "rand.h"
+#include <errno.h>
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/random.h>
+#endif
 
 // The following code is not supposed to be used in a production environment.
 // It's included only to make the library testable.
@@ -19,15 +23,20 @@ static uint32_t seed = 0;
 
 void random_reseed(const uint32_t value)
 {
-  seed = value;
+  __atomic_store_n(&seed, value, __ATOMIC_RELAXED);
 }
 
 uint32_t random32(void)
 {
   // Linear congruential generator from Numerical Recipes
   // https://en.wikipedia.org/wiki/Linear_congruential_generator
-  seed = 1664525 * seed + 1013904223;
-  return seed;
+  // The seed is advanced atomically, batch signing calls this from
+  // several threads.
+  uint32_t old = __atomic_load_n(&seed, __ATOMIC_RELAXED), next;
+  do {
+    next = 1664525 * old + 1013904223;
+  } while (!__atomic_compare_exchange_n(&seed, &old, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return next;
 }
 
 //
@@ -45,6 +54,31 @@ void __attribute__((weak)) random_buffer(uint8_t *buf, size_t len)
   }
 }
 
+int random_secure(uint8_t *buf, size_t len)
+{
+#if defined(__APPLE__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+  arc4random_buf(buf, len);
+  return 0;
+#elif defined(__linux__)
+  while (len > 0) {
+    ssize_t got = getrandom(buf, len, 0);
+    if (got < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf += got;
+    len -= (size_t)got;
+  }
+  return 0;
+#else
+  (void)buf;
+  (void)len;
+  return -1;
+#endif
+}
+
 uint32_t random_uniform(uint32_t n)
 {
   uint32_t x, max = 0xFFFFFFFF - (0xFFFFFFFF % n);
@@ -16,6 +16,10 @@ void random_reseed(const uint32_t value);
 uint32_t random32(void);
 void random_buffer(uint8_t *buf, size_t len);
 
+// Fills buf from the operating system's CSPRNG, unlike the functions above.
+// returns 0 on success and -1 if no such generator is available
+int random_secure(uint8_t *buf, size_t len);
+
 uint32_t random_uniform(uint32_t n);
 void random_permute(char *buf, size_t len);
 
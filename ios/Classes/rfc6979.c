@@ -0,0 +1,56 @@
+//
+//  rfc6979.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include <string.h>
+#include "rfc6979.h"
+#include "hmac.h"
+#include "memzero.h"
+
+void init_rfc6979(const uint8_t *priv_key, const uint8_t *hash, rfc6979_state *state)
+{
+  uint8_t bx[2 * 32];
+  uint8_t buf[32 + 1 + 2 * 32];
+  
+  memcpy(bx, priv_key, 32);
+  memcpy(bx + 32, hash, 32);
+  
+  memset(state->v, 1, sizeof(state->v));
+  memset(state->k, 0, sizeof(state->k));
+  
+  // K = HMAC_K(V | 0x00 | x | h1), V = HMAC_K(V)
+  memcpy(buf, state->v, sizeof(state->v));
+  buf[sizeof(state->v)] = 0x00;
+  memcpy(buf + sizeof(state->v) + 1, bx, 64);
+  hmac_sha256(state->k, sizeof(state->k), buf, sizeof(buf), state->k);
+  hmac_sha256(state->k, sizeof(state->k), state->v, sizeof(state->v), state->v);
+  
+  // K = HMAC_K(V | 0x01 | x | h1), V = HMAC_K(V)
+  memcpy(buf, state->v, sizeof(state->v));
+  buf[sizeof(state->v)] = 0x01;
+  hmac_sha256(state->k, sizeof(state->k), buf, sizeof(buf), state->k);
+  hmac_sha256(state->k, sizeof(state->k), state->v, sizeof(state->v), state->v);
+  
+  memzero(bx, sizeof(bx));
+  memzero(buf, sizeof(buf));
+}
+
+void generate_rfc6979(uint8_t rnd[32], rfc6979_state *state)
+{
+  uint8_t t[32 + 1];
+  
+  // V = HMAC_K(V), the output of this round
+  hmac_sha256(state->k, sizeof(state->k), state->v, sizeof(state->v), state->v);
+  memcpy(rnd, state->v, 32);
+  
+  // prepare the next round: K = HMAC_K(V | 0x00), V = HMAC_K(V)
+  memcpy(t, state->v, 32);
+  t[32] = 0x00;
+  hmac_sha256(state->k, sizeof(state->k), t, sizeof(t), state->k);
+  hmac_sha256(state->k, sizeof(state->k), state->v, sizeof(state->v), state->v);
+  memzero(t, sizeof(t));
+}
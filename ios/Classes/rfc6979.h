@@ -0,0 +1,30 @@
+//
+//  rfc6979.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Deterministic nonces for ECDSA (RFC 6979) with HMAC-SHA256, so signing
+//  does not depend on the quality of the random number generator.
+//
+
+#ifndef rfc6979_h
+#define rfc6979_h
+
+#include <stdint.h>
+
+// HMAC_DRBG state
+typedef struct {
+  uint8_t v[32], k[32];
+} rfc6979_state;
+
+// Seeds the generator with the private key and h1 = bits2octets(h), the
+// digest to sign reduced modulo the curve order.
+void init_rfc6979(const uint8_t *priv_key, const uint8_t *hash, rfc6979_state *state);
+
+// Writes the next 32 bytes of output.  The caller retries with the next
+// output while it is not a valid nonce.
+void generate_rfc6979(uint8_t rnd[32], rfc6979_state *state);
+
+#endif /* rfc6979_h */
@@ -0,0 +1,150 @@
+//
+//  secmem.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "secmem.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "memzero.h"
+
+struct secmem_arena {
+  pthread_mutex_t lock;
+  uint8_t *map;           // guard page | slots | guard page
+  size_t map_size;
+  uint8_t *slots;
+  size_t data_size;       // page aligned size of the slots
+  size_t slot_size;
+  size_t slot_count;
+  uint32_t *free_list;    // stack of free slot indices, not secret
+  size_t free_count;
+  uint32_t *in_use;       // bitmap of the taken slots
+  int locked;
+};
+
+secmem_arena *secmem_arena_new(size_t slot_size, size_t slot_count)
+{
+  size_t page = (size_t)getpagesize(), i;
+  secmem_arena *arena;
+
+  if (slot_size == 0 || slot_count == 0 || slot_count > UINT32_MAX) {
+    return NULL;
+  }
+  arena = calloc(1, sizeof(secmem_arena));
+  if (arena == NULL) {
+    return NULL;
+  }
+  arena->slot_size = (slot_size + SECMEM_ALIGN - 1) & ~(size_t)(SECMEM_ALIGN - 1);
+  arena->slot_count = slot_count;
+  arena->data_size = (arena->slot_size * slot_count + page - 1) & ~(page - 1);
+  arena->map_size = arena->data_size + 2 * page;
+  arena->free_list = malloc(slot_count * sizeof(uint32_t));
+  arena->in_use = calloc((slot_count + 31) / 32, sizeof(uint32_t));
+  arena->map = mmap(NULL, arena->map_size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (arena->free_list == NULL || arena->in_use == NULL || arena->map == MAP_FAILED) {
+    if (arena->map != MAP_FAILED) {
+      munmap(arena->map, arena->map_size);
+    }
+    free(arena->free_list);
+    free(arena->in_use);
+    free(arena);
+    return NULL;
+  }
+  arena->slots = arena->map + page;
+  if (mprotect(arena->slots, arena->data_size, PROT_READ | PROT_WRITE) != 0) {
+    munmap(arena->map, arena->map_size);
+    free(arena->free_list);
+    free(arena->in_use);
+    free(arena);
+    return NULL;
+  }
+  arena->locked = mlock(arena->slots, arena->data_size) == 0;
+#ifdef MADV_DONTDUMP
+  madvise(arena->slots, arena->data_size, MADV_DONTDUMP);
+#endif
+#ifdef MADV_WIPEONFORK
+  madvise(arena->slots, arena->data_size, MADV_WIPEONFORK);
+#endif
+
+  // hand out the lowest slots first
+  for (i = 0; i < slot_count; i++) {
+    arena->free_list[i] = (uint32_t)(slot_count - 1 - i);
+  }
+  arena->free_count = slot_count;
+  pthread_mutex_init(&arena->lock, NULL);
+  return arena;
+}
+
+void secmem_arena_free(secmem_arena *arena)
+{
+  if (arena == NULL) {
+    return;
+  }
+  memzero(arena->slots, arena->data_size);
+  if (arena->locked) {
+    munlock(arena->slots, arena->data_size);
+  }
+  munmap(arena->map, arena->map_size);
+  pthread_mutex_destroy(&arena->lock);
+  free(arena->free_list);
+  free(arena->in_use);
+  free(arena);
+}
+
+int secmem_arena_locked(const secmem_arena *arena)
+{
+  return arena->locked;
+}
+
+size_t secmem_slot_size(const secmem_arena *arena)
+{
+  return arena->slot_size;
+}
+
+void *secmem_alloc(secmem_arena *arena)
+{
+  void *p = NULL;
+  uint32_t i;
+
+  pthread_mutex_lock(&arena->lock);
+  if (arena->free_count > 0) {
+    i = arena->free_list[--arena->free_count];
+    arena->in_use[i / 32] |= 1u << (i % 32);
+    p = arena->slots + (size_t)i * arena->slot_size;
+  }
+  pthread_mutex_unlock(&arena->lock);
+  // slots are zeroed when freed and by the initial mapping
+  return p;
+}
+
+void secmem_free(secmem_arena *arena, void *p)
+{
+  size_t offset;
+  uint32_t i;
+
+  if (p == NULL) {
+    return;
+  }
+  offset = (size_t)((uint8_t *)p - arena->slots);
+  if ((uint8_t *)p < arena->slots || offset >= arena->slot_size * arena->slot_count ||
+      offset % arena->slot_size != 0) {
+    abort();
+  }
+  i = (uint32_t)(offset / arena->slot_size);
+
+  pthread_mutex_lock(&arena->lock);
+  if (!(arena->in_use[i / 32] & (1u << (i % 32)))) {
+    // double free, the slot may already hold another secret
+    abort();
+  }
+  memzero(p, arena->slot_size);
+  arena->in_use[i / 32] &= ~(1u << (i % 32));
+  arena->free_list[arena->free_count++] = i;
+  pthread_mutex_unlock(&arena->lock);
+}
@@ -0,0 +1,46 @@
+//
+//  secmem.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Arena of fixed size slots for secrets such as private keys and nonces.
+//
+//  The slots live in one mapping that is locked into memory, excluded from
+//  core dumps and surrounded by inaccessible guard pages.  All of this is
+//  set up once per arena, so taking and returning a slot is a free list
+//  operation without system calls.  Returned slots are zeroed with
+//  memzero.
+//
+
+#ifndef secmem_h
+#define secmem_h
+
+#include <stddef.h>
+
+// slots are aligned to, and sized in multiples of, this many bytes
+#define SECMEM_ALIGN 16
+
+typedef struct secmem_arena secmem_arena;
+
+// returns NULL if the mapping cannot be created
+secmem_arena *secmem_arena_new(size_t slot_size, size_t slot_count);
+
+// Zeroes and unmaps all slots, including those still taken.
+void secmem_arena_free(secmem_arena *arena);
+
+// returns 1 if the slots are locked into memory.  Locking fails when the
+// process is over its locked memory limit; the arena still works then.
+int secmem_arena_locked(const secmem_arena *arena);
+
+size_t secmem_slot_size(const secmem_arena *arena);
+
+// returns a zeroed slot, or NULL if all slots are taken
+void *secmem_alloc(secmem_arena *arena);
+
+// Zeroes p and returns its slot to the arena.  p may be NULL.  Aborts if p
+// is not a slot of the arena or its slot is not taken.
+void secmem_free(secmem_arena *arena, void *p);
+
+#endif /* secmem_h */
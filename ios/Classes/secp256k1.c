@@ -0,0 +1,72 @@
+//
+//  secp256k1.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "secp256k1.h"
+
+static const ecdsa_endomorphism secp256k1_endo = {
+  /* beta */ {
+    /*.val =*/{0x319501ee, 0x4e5b0a1, 0x2f58995c, 0x3c125d44, 0x3434e99c, 0x111e7ab0, 0x7106e6, 0x1a8ad95f, 0x7ae9}
+  },
+  
+  /* lambda */ {
+    /*.val =*/{0x1b23bd72, 0x3c0a59f0, 0x816678d, 0xb88ba88, 0x12645a12, 0x18700a20, 0x30e0a52, 0x2b533017, 0x5363}
+  },
+  
+  /* g1 */ {
+    /*.val =*/{0x5dbb031, 0x224c8269, 0x1e8ca7fe, 0x2aa2851c, 0x4eb153d, 0x3243924a, 0x6bcde86, 0x348869f5, 0x3086}
+  },
+  
+  /* g2 */ {
+    /*.val =*/{0xac47f71, 0x15c6d2ba, 0x1f506c61, 0x4822b27, 0x3fe4c422, 0x11fea42a, 0x288286f5, 0x1fb58043, 0xe443}
+  },
+  
+  /* minus_b1 */ {
+    /*.val =*/{0xabfe4c3, 0x3d51fea4, 0x10e88286, 0x10dfb580, 0xe4, 0x0, 0x0, 0x0, 0x0}
+  },
+  
+  /* minus_b2 */ {
+    /*.val =*/{0x3db1562c, 0x1d9736a0, 0x374346dd, 0xa02b141, 0x3ffffe8a, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0xffff}
+  }
+};
+
+const ecdsa_curve secp256k1 = {
+  /* .prime */ {
+    /*.val =*/ {0x3ffffc2f, 0x3ffffffb, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0xffff}
+  },
+  
+  /* G */ {
+    /*.x =*/{/*.val =*/{0x16f81798, 0x27ca056c, 0x1ce28d95, 0x26ff36cb, 0x70b0702, 0x18a573a, 0xbbac55a, 0x199fbe77, 0x79be}},
+    /*.y =*/{/*.val =*/{0x3b10d4b8, 0x311f423f, 0x28554199, 0x5ed1229, 0x1108a8fd, 0x13eff038, 0x3c4655da, 0x369dc9a8, 0x483a}}
+  },
+  
+  /* order */ {
+    /*.val =*/{0x10364141, 0x3f497a33, 0x348a03bb, 0x2bb739ab, 0x3ffffeba, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0xffff}
+  },
+  
+  /* order_half */ {
+    /*.val =*/{0x281b20a0, 0x3fa4bd19, 0x3a4501dd, 0x15db9cd5, 0x3fffff5d, 0x3fffffff, 0x3fffffff, 0x3fffffff, 0x7fff}
+  },
+  
+  /* a */ 0,
+  
+  /* b */ {
+    /*.val =*/{0x7, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}
+  },
+  
+  /* reduce */ bn_multiply_reduce_k1,
+  
+  /* endo */ &secp256k1_endo
+  
+#if USE_PRECOMPUTED_CP
+  ,
+  /* cp */ {
+    // generated by tools/mktable.c: mktable secp256k1 4
+#include "secp256k1.table"
+  }
+#endif
+};
@@ -0,0 +1,17 @@
+//
+//  secp256k1.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#ifndef secp256k1_h
+#define secp256k1_h
+
+#include <stdio.h>
+#include "ecdsa.h"
+
+extern const ecdsa_curve secp256k1;
+
+#endif /* secp256k1_h */
@@ -30,11 +30,16 @@ const ecdsa_curve secp256r1 = {
   
   /* b */ {
     /*.val =*/{0x27d2604b, 0x2f38f0f8, 0x53b0f63, 0x741ac33, 0x1886bc65, 0x2ef555da, 0x293e7b3e, 0xd762a8e, 0x5ac6}
-  }
+  },
+  
+  /* reduce */ bn_multiply_reduce,
+  
+  /* endo */ NULL
   
 #if USE_PRECOMPUTED_CP
   ,
   /* cp */ {
+    // generated by tools/mktable.c: mktable secp256r1 4
 #include "secp256r1.table"
   }
 #endif
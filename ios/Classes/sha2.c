@@ -0,0 +1,201 @@
+/*
+ *  SHA-256 (FIPS 180-4)
+ *
+ *  Streaming interface in the style of ripemd160.c: sha256_Update may be
+ *  called with input of any length and keeps at most one block buffered,
+ *  so arbitrarily long messages are hashed in constant memory.
+ */
+
+#include <string.h>
+
+#include "sha2.h"
+#include "memzero.h"
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+{                                                       \
+(n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+| ( (uint32_t) (b)[(i) + 1] << 16 )             \
+| ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+| ( (uint32_t) (b)[(i) + 3]       );            \
+}
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                                    \
+{                                                               \
+(b)[(i)    ] = (uint8_t) ( ( (n) >> 24 ) & 0xFF );    \
+(b)[(i) + 1] = (uint8_t) ( ( (n) >> 16 ) & 0xFF );    \
+(b)[(i) + 2] = (uint8_t) ( ( (n) >>  8 ) & 0xFF );    \
+(b)[(i) + 3] = (uint8_t) ( ( (n)       ) & 0xFF );    \
+}
+#endif
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x,n)   (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x,y,z)   (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x,y,z)  (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define S0(x)       (ROTR(x, 2) ^ ROTR(x,13) ^ ROTR(x,22))
+#define S1(x)       (ROTR(x, 6) ^ ROTR(x,11) ^ ROTR(x,25))
+#define s0(x)       (ROTR(x, 7) ^ ROTR(x,18) ^ ((x) >>  3))
+#define s1(x)       (ROTR(x,17) ^ ROTR(x,19) ^ ((x) >> 10))
+
+/*
+ * SHA-256 context setup
+ */
+void sha256_Init(SHA256_CTX *ctx)
+{
+  memset(ctx, 0, sizeof(SHA256_CTX));
+  
+  ctx->state[0] = 0x6a09e667;
+  ctx->state[1] = 0xbb67ae85;
+  ctx->state[2] = 0x3c6ef372;
+  ctx->state[3] = 0xa54ff53a;
+  ctx->state[4] = 0x510e527f;
+  ctx->state[5] = 0x9b05688c;
+  ctx->state[6] = 0x1f83d9ab;
+  ctx->state[7] = 0x5be0cd19;
+}
+
+static void sha256_process(SHA256_CTX *ctx, const uint8_t data[SHA256_BLOCK_LENGTH])
+{
+  uint32_t W[64], A, B, C, D, E, F, G, H, T1, T2;
+  int i;
+  
+  for (i = 0; i < 16; i++) {
+    GET_UINT32_BE(W[i], data, 4 * i);
+  }
+  for (; i < 64; i++) {
+    W[i] = s1(W[i - 2]) + W[i - 7] + s0(W[i - 15]) + W[i - 16];
+  }
+  
+  A = ctx->state[0];
+  B = ctx->state[1];
+  C = ctx->state[2];
+  D = ctx->state[3];
+  E = ctx->state[4];
+  F = ctx->state[5];
+  G = ctx->state[6];
+  H = ctx->state[7];
+  
+  for (i = 0; i < 64; i++) {
+    T1 = H + S1(E) + CH(E, F, G) + K[i] + W[i];
+    T2 = S0(A) + MAJ(A, B, C);
+    H = G;
+    G = F;
+    F = E;
+    E = D + T1;
+    D = C;
+    C = B;
+    B = A;
+    A = T1 + T2;
+  }
+  
+  ctx->state[0] += A;
+  ctx->state[1] += B;
+  ctx->state[2] += C;
+  ctx->state[3] += D;
+  ctx->state[4] += E;
+  ctx->state[5] += F;
+  ctx->state[6] += G;
+  ctx->state[7] += H;
+}
+
+/*
+ * SHA-256 process buffer
+ */
+void sha256_Update(SHA256_CTX *ctx, const uint8_t *input, size_t ilen)
+{
+  size_t fill;
+  uint32_t left;
+  
+  if (ilen == 0)
+    return;
+  
+  left = ctx->total[0] & 0x3F;
+  fill = SHA256_BLOCK_LENGTH - left;
+  
+  ctx->total[0] += (uint32_t) ilen;
+  if (ctx->total[0] < (uint32_t) ilen)
+    ctx->total[1]++;
+  ctx->total[1] += (uint32_t) ((uint64_t) ilen >> 32);
+  
+  if (left && ilen >= fill) {
+    memcpy((void *) (ctx->buffer + left), input, fill);
+    sha256_process(ctx, ctx->buffer);
+    input += fill;
+    ilen  -= fill;
+    left = 0;
+  }
+  
+  while (ilen >= SHA256_BLOCK_LENGTH) {
+    sha256_process(ctx, input);
+    input += SHA256_BLOCK_LENGTH;
+    ilen  -= SHA256_BLOCK_LENGTH;
+  }
+  
+  if (ilen > 0) {
+    memcpy((void *) (ctx->buffer + left), input, ilen);
+  }
+}
+
+static const uint8_t sha256_padding[SHA256_BLOCK_LENGTH] = {
+  0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/*
+ * SHA-256 final digest
+ */
+void sha256_Final(SHA256_CTX *ctx, uint8_t output[SHA256_DIGEST_LENGTH])
+{
+  uint32_t last, padn;
+  uint32_t high, low;
+  uint8_t msglen[8];
+  int i;
+  
+  high = ( ctx->total[0] >> 29 )
+  | ( ctx->total[1] <<  3 );
+  low  = ( ctx->total[0] <<  3 );
+  
+  PUT_UINT32_BE( high, msglen, 0 );
+  PUT_UINT32_BE( low,  msglen, 4 );
+  
+  last = ctx->total[0] & 0x3F;
+  padn = ( last < 56 ) ? ( 56 - last ) : ( 120 - last );
+  
+  sha256_Update( ctx, sha256_padding, padn );
+  sha256_Update( ctx, msglen, 8 );
+  
+  for (i = 0; i < 8; i++) {
+    PUT_UINT32_BE( ctx->state[i], output, 4 * i );
+  }
+  
+  memzero(ctx, sizeof(SHA256_CTX));
+}
+
+/*
+ * output = SHA-256( input buffer )
+ */
+void sha256_Raw(const uint8_t *msg, size_t msg_len, uint8_t hash[SHA256_DIGEST_LENGTH])
+{
+  SHA256_CTX ctx;
+  sha256_Init( &ctx );
+  sha256_Update( &ctx, msg, msg_len );
+  sha256_Final( &ctx, hash );
+}
@@ -0,0 +1,21 @@
+#ifndef __SHA2_H__
+#define __SHA2_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHA256_BLOCK_LENGTH   64
+#define SHA256_DIGEST_LENGTH  32
+
+typedef struct _SHA256_CTX {
+  uint32_t total[2];    /*!< number of bytes processed  */
+  uint32_t state[8];    /*!< intermediate digest state  */
+  uint8_t buffer[SHA256_BLOCK_LENGTH];   /*!< data block being processed */
+} SHA256_CTX;
+
+void sha256_Init(SHA256_CTX *ctx);
+void sha256_Update(SHA256_CTX *ctx, const uint8_t *input, size_t ilen);
+void sha256_Final(SHA256_CTX *ctx, uint8_t output[SHA256_DIGEST_LENGTH]);
+void sha256_Raw(const uint8_t *msg, size_t msg_len, uint8_t hash[SHA256_DIGEST_LENGTH]);
+
+#endif
@@ -0,0 +1,97 @@
+//
+//  trx_digest.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "trx_digest.h"
+#include <string.h>
+
+static const uint8_t zero_digest[SHA256_DIGEST_LENGTH];
+
+// packed transaction bytes go into the digest and, if wanted, the id
+static void put(trx_digest_ctx *ctx, const uint8_t *data, size_t len)
+{
+  sha256_Update(&ctx->trx, data, len);
+  if (ctx->with_id) {
+    sha256_Update(&ctx->id, data, len);
+  }
+}
+
+void trx_digest_init(trx_digest_ctx *ctx, const uint8_t chain_id[32])
+{
+  sha256_Init(&ctx->trx);
+  sha256_Init(&ctx->cfd);
+  ctx->has_cfd = 0;
+  ctx->with_id = 0;
+  sha256_Update(&ctx->trx, chain_id, 32);
+}
+
+void trx_digest_init_id(trx_digest_ctx *ctx, const uint8_t chain_id[32])
+{
+  trx_digest_init(ctx, chain_id);
+  sha256_Init(&ctx->id);
+  ctx->with_id = 1;
+}
+
+void trx_digest_update(trx_digest_ctx *ctx, const uint8_t *data, size_t len)
+{
+  put(ctx, data, len);
+}
+
+void trx_digest_cfd_update(trx_digest_ctx *ctx, const uint8_t *data, size_t len)
+{
+  // a packed vector starting with a zero count is empty
+  if (len == 0 || (!ctx->has_cfd && data[0] == 0)) {
+    return;
+  }
+  ctx->has_cfd = 1;
+  sha256_Update(&ctx->cfd, data, len);
+}
+
+void trx_digest_final(trx_digest_ctx *ctx, uint8_t digest[SHA256_DIGEST_LENGTH])
+{
+  uint8_t cfd_digest[SHA256_DIGEST_LENGTH];
+  
+  if (ctx->has_cfd) {
+    sha256_Final(&ctx->cfd, cfd_digest);
+    sha256_Update(&ctx->trx, cfd_digest, sizeof(cfd_digest));
+  } else {
+    sha256_Update(&ctx->trx, zero_digest, sizeof(zero_digest));
+  }
+  sha256_Final(&ctx->trx, digest);
+  memset(&ctx->cfd, 0, sizeof(ctx->cfd));
+  ctx->has_cfd = 0;
+}
+
+void trx_digest_final_id(trx_digest_ctx *ctx, uint8_t digest[SHA256_DIGEST_LENGTH], uint8_t id[SHA256_DIGEST_LENGTH])
+{
+  trx_digest_final(ctx, digest);
+  sha256_Final(&ctx->id, id);
+  ctx->with_id = 0;
+}
+
+void trx_digest(const uint8_t chain_id[32], const uint8_t *packed_trx, size_t trx_len,
+                const uint8_t *packed_cfd, size_t cfd_len, uint8_t digest[SHA256_DIGEST_LENGTH])
+{
+  trx_digest_ctx ctx;
+  
+  trx_digest_init(&ctx, chain_id);
+  trx_digest_update(&ctx, packed_trx, trx_len);
+  trx_digest_cfd_update(&ctx, packed_cfd, cfd_len);
+  trx_digest_final(&ctx, digest);
+}
+
+void trx_digest_id(const uint8_t chain_id[32], const uint8_t *packed_trx, size_t trx_len,
+                   const uint8_t *packed_cfd, size_t cfd_len,
+                   uint8_t digest[SHA256_DIGEST_LENGTH], uint8_t id[SHA256_DIGEST_LENGTH])
+{
+  trx_digest_ctx ctx;
+  
+  trx_digest_init_id(&ctx, chain_id);
+  trx_digest_update(&ctx, packed_trx, trx_len);
+  trx_digest_cfd_update(&ctx, packed_cfd, cfd_len);
+  trx_digest_final_id(&ctx, digest, id);
+}
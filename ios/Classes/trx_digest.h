@@ -0,0 +1,56 @@
+//
+//  trx_digest.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Incremental computation of the digest a transaction is signed over:
+//
+//    sha256(chain_id | packed_trx | cfd_digest)
+//
+//  where cfd_digest is sha256 of the packed context free data, or 32 zero
+//  bytes if the transaction has none.  The packed transaction and context
+//  free data are hashed where they are, in pieces of any size, so the
+//  preimage is never joined into one buffer.
+//
+//  The transaction id, sha256(packed_trx), can be computed in the same
+//  pass by starting with trx_digest_init_id.
+//
+
+#ifndef trx_digest_h
+#define trx_digest_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha2.h"
+
+typedef struct {
+  SHA256_CTX trx;
+  SHA256_CTX cfd;
+  SHA256_CTX id;
+  int has_cfd;
+  int with_id;
+} trx_digest_ctx;
+
+void trx_digest_init(trx_digest_ctx *ctx, const uint8_t chain_id[32]);
+// also computes the transaction id, see trx_digest_final_id
+void trx_digest_init_id(trx_digest_ctx *ctx, const uint8_t chain_id[32]);
+
+// packed transaction, in order and in pieces of any size
+void trx_digest_update(trx_digest_ctx *ctx, const uint8_t *data, size_t len);
+// packed context free data vector, in order and in pieces of any size
+void trx_digest_cfd_update(trx_digest_ctx *ctx, const uint8_t *data, size_t len);
+
+void trx_digest_final(trx_digest_ctx *ctx, uint8_t digest[SHA256_DIGEST_LENGTH]);
+void trx_digest_final_id(trx_digest_ctx *ctx, uint8_t digest[SHA256_DIGEST_LENGTH], uint8_t id[SHA256_DIGEST_LENGTH]);
+
+// one shot over an already packed transaction and packed context free
+// data (cfd_len 0 for none)
+void trx_digest(const uint8_t chain_id[32], const uint8_t *packed_trx, size_t trx_len,
+                const uint8_t *packed_cfd, size_t cfd_len, uint8_t digest[SHA256_DIGEST_LENGTH]);
+void trx_digest_id(const uint8_t chain_id[32], const uint8_t *packed_trx, size_t trx_len,
+                   const uint8_t *packed_cfd, size_t cfd_len,
+                   uint8_t digest[SHA256_DIGEST_LENGTH], uint8_t id[SHA256_DIGEST_LENGTH]);
+
+#endif /* trx_digest_h */
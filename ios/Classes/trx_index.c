@@ -0,0 +1,188 @@
+//
+//  trx_index.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "trx_index.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+
+// expiration 0 marks an empty slot
+typedef struct {
+  uint8_t id[32];
+  uint32_t expiration;
+} entry;
+
+typedef struct {
+  _Alignas(CACHE_LINE) pthread_mutex_t lock;
+  entry *slots;
+  trx_index_stats stats;
+} stripe;
+
+struct trx_index {
+  stripe *stripes;
+  uint32_t stripe_mask;
+  uint32_t slot_mask;      // slots per stripe - 1
+  entry *slots;
+};
+
+// Ids are hashes already, their first bytes pick the stripe and the slot.
+static inline uint64_t id_hash(const uint8_t id[32])
+{
+  uint64_t h;
+
+  memcpy(&h, id, sizeof(h));
+  return h;
+}
+
+trx_index *trx_index_new(size_t capacity, unsigned int stripes)
+{
+  trx_index *index;
+  size_t stripe_count = 1, per_stripe = TRX_INDEX_PROBE, i;
+
+  while (stripe_count < stripes) {
+    stripe_count <<= 1;
+  }
+  while (per_stripe * stripe_count < capacity) {
+    per_stripe <<= 1;
+  }
+
+  index = calloc(1, sizeof(trx_index));
+  if (index == NULL) {
+    return NULL;
+  }
+  index->slots = calloc(stripe_count * per_stripe, sizeof(entry));
+  if (posix_memalign((void **)&index->stripes, CACHE_LINE, stripe_count * sizeof(stripe)) != 0) {
+    index->stripes = NULL;
+  }
+  if (index->slots == NULL || index->stripes == NULL) {
+    free(index->slots);
+    free(index->stripes);
+    free(index);
+    return NULL;
+  }
+  memset(index->stripes, 0, stripe_count * sizeof(stripe));
+  for (i = 0; i < stripe_count; i++) {
+    pthread_mutex_init(&index->stripes[i].lock, NULL);
+    index->stripes[i].slots = index->slots + i * per_stripe;
+  }
+  index->stripe_mask = (uint32_t)(stripe_count - 1);
+  index->slot_mask = (uint32_t)(per_stripe - 1);
+  return index;
+}
+
+void trx_index_free(trx_index *index)
+{
+  uint32_t i;
+
+  if (index == NULL) {
+    return;
+  }
+  for (i = 0; i <= index->stripe_mask; i++) {
+    pthread_mutex_destroy(&index->stripes[i].lock);
+  }
+  free(index->stripes);
+  free(index->slots);
+  free(index);
+}
+
+int trx_index_contains(trx_index *index, const uint8_t id[32], uint32_t now)
+{
+  uint64_t h = id_hash(id);
+  stripe *s = &index->stripes[h & index->stripe_mask];
+  uint32_t pos = (uint32_t)(h >> 32), i;
+  entry *e;
+  int found = 0;
+
+  pthread_mutex_lock(&s->lock);
+  for (i = 0; i < TRX_INDEX_PROBE; i++) {
+    e = &s->slots[(pos + i) & index->slot_mask];
+    if (e->expiration == 0) {
+      break;
+    }
+    if (memcmp(e->id, id, 32) == 0) {
+      found = e->expiration > now;
+      break;
+    }
+  }
+  s->stats.lookups++;
+  s->stats.hits += found;
+  pthread_mutex_unlock(&s->lock);
+  return found;
+}
+
+int trx_index_insert(trx_index *index, const uint8_t id[32], uint32_t expiration, uint32_t now)
+{
+  uint64_t h = id_hash(id);
+  stripe *s = &index->stripes[h & index->stripe_mask];
+  uint32_t pos = (uint32_t)(h >> 32), i;
+  entry *e, *free_slot = NULL, *victim = NULL;
+
+  if (expiration == 0) {
+    expiration = 1;
+  }
+
+  pthread_mutex_lock(&s->lock);
+  s->stats.lookups++;
+  for (i = 0; i < TRX_INDEX_PROBE; i++) {
+    e = &s->slots[(pos + i) & index->slot_mask];
+    if (e->expiration == 0) {
+      // the id is not further along the probe sequence
+      if (free_slot == NULL) {
+        free_slot = e;
+      }
+      break;
+    }
+    if (memcmp(e->id, id, 32) == 0) {
+      if (e->expiration > now) {
+        s->stats.hits++;
+        pthread_mutex_unlock(&s->lock);
+        return 1;
+      }
+      free_slot = e;
+      break;
+    }
+    if (e->expiration <= now) {
+      if (free_slot == NULL) {
+        free_slot = e;
+      }
+    } else if (victim == NULL || e->expiration < victim->expiration) {
+      victim = e;
+    }
+  }
+  if (free_slot == NULL) {
+    free_slot = victim;
+    s->stats.evictions++;
+  } else if (free_slot->expiration != 0) {
+    s->stats.reused++;
+  }
+  memcpy(free_slot->id, id, 32);
+  free_slot->expiration = expiration;
+  s->stats.inserts++;
+  pthread_mutex_unlock(&s->lock);
+  return 0;
+}
+
+void trx_index_stats_get(trx_index *index, trx_index_stats *stats)
+{
+  stripe *s;
+  uint32_t i;
+
+  memset(stats, 0, sizeof(*stats));
+  for (i = 0; i <= index->stripe_mask; i++) {
+    s = &index->stripes[i];
+    pthread_mutex_lock(&s->lock);
+    stats->lookups += s->stats.lookups;
+    stats->hits += s->stats.hits;
+    stats->inserts += s->stats.inserts;
+    stats->reused += s->stats.reused;
+    stats->evictions += s->stats.evictions;
+    pthread_mutex_unlock(&s->lock);
+  }
+}
@@ -0,0 +1,52 @@
+//
+//  trx_index.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Fixed size index of recently seen transaction ids for dropping
+//  duplicates.
+//
+//  An id stays in the index until its transaction expires; expired entries
+//  are overwritten by new ids.  When every slot an id may go to is live, the
+//  entry that expires first is evicted, so memory never grows.  The table
+//  is split into stripes with a lock each, so threads inserting different
+//  ids rarely wait for each other.
+//
+
+#ifndef trx_index_h
+#define trx_index_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// slots probed per id
+#define TRX_INDEX_PROBE 16
+
+typedef struct {
+  uint64_t lookups;     // contains and insert calls
+  uint64_t hits;        // calls that found a live id
+  uint64_t inserts;
+  uint64_t reused;      // inserts into the slot of an expired id
+  uint64_t evictions;   // inserts that evicted a live id
+} trx_index_stats;
+
+typedef struct trx_index trx_index;
+
+// capacity is the number of ids held, spread over stripes locks; both are
+// rounded up to powers of two
+trx_index *trx_index_new(size_t capacity, unsigned int stripes);
+void trx_index_free(trx_index *index);
+
+// returns 1 if id is in the index and expires after now
+int trx_index_contains(trx_index *index, const uint8_t id[32], uint32_t now);
+
+// Adds id, expiring at expiration (seconds, like now), unless it is
+// already present and live.
+// returns 0 if id was added, 1 if it is a duplicate
+int trx_index_insert(trx_index *index, const uint8_t id[32], uint32_t expiration, uint32_t now);
+
+void trx_index_stats_get(trx_index *index, trx_index_stats *stats);
+
+#endif /* trx_index_h */
@@ -0,0 +1,397 @@
+//
+//  tune.c
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+
+#include "tune.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sha2.h"
+
+#define FIXTURE_MIN      128   // signatures probed, at least
+#define THREAD_MARGIN    1.05  // more threads must be 5% faster to be chosen
+
+static const unsigned int batch_candidates[] = { 4, 8, 16, 32 };
+
+// keys, digests and signatures the probes work on
+typedef struct {
+  const ecdsa_curve *curve;
+  size_t n;
+  uint8_t *keys;       // n * 32
+  uint8_t *digests;    // n * 32
+  uint8_t *sigs;       // n * 64
+  int *recids;
+  uint8_t *out;        // n * 65 bytes of output
+  int *results;        // n results
+} tune_fixture;
+
+// processes count items of the fixture starting at first
+typedef void (*probe_fn)(const tune_fixture *fx, size_t first, size_t count);
+
+typedef struct {
+  const tune_fixture *fx;
+  probe_fn fn;
+  size_t first, count;
+  uint64_t deadline;
+  uint64_t ops;
+  pthread_t thread;
+} probe_worker;
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static unsigned int online_cpus(void)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return cpus > 1 ? (unsigned int)cpus : 1;
+}
+
+static void probe_recover(const tune_fixture *fx, size_t first, size_t count)
+{
+  ecdsa_recover_pub_from_sig_batch(fx->curve, fx->out + 65 * first, fx->sigs + 64 * first,
+                                   fx->digests + 32 * first, fx->recids + first, fx->results + first, count);
+}
+
+static void probe_sign(const tune_fixture *fx, size_t first, size_t count)
+{
+  ecdsa_sign_batch(fx->curve, fx->keys + 32 * first, fx->digests + 32 * first, count,
+                   fx->out + 64 * first, fx->results + first, NULL);
+}
+
+static void *probe_main(void *arg)
+{
+  probe_worker *w = arg;
+
+  do {
+    w->fn(w->fx, w->first, w->count);
+    w->ops += w->count;
+  } while (now_ns() < w->deadline);
+  return NULL;
+}
+
+// Runs fn over the fixture on threads threads, each on its own slice, for
+// about ns nanoseconds.  returns operations per second
+static double probe(const tune_fixture *fx, probe_fn fn, unsigned int threads, uint64_t ns)
+{
+  probe_worker workers[ECDSA_SIGN_THREADS];
+  uint64_t start, ops = 0;
+  unsigned int i;
+
+  if (threads > ECDSA_SIGN_THREADS) {
+    threads = ECDSA_SIGN_THREADS;
+  }
+  if (threads > fx->n) {
+    threads = (unsigned int)fx->n;
+  }
+  start = now_ns();
+  for (i = 0; i < threads; i++) {
+    workers[i].fx = fx;
+    workers[i].fn = fn;
+    workers[i].first = fx->n * i / threads;
+    workers[i].count = fx->n * (i + 1) / threads - workers[i].first;
+    workers[i].deadline = start + ns;
+    workers[i].ops = 0;
+  }
+  // the calling thread runs the first slice
+  for (i = 1; i < threads; i++) {
+    if (pthread_create(&workers[i].thread, NULL, probe_main, &workers[i]) != 0) {
+      break;
+    }
+  }
+  threads = i;
+  probe_main(&workers[0]);
+  ops = workers[0].ops;
+  for (i = 1; i < threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    ops += workers[i].ops;
+  }
+  return ops * 1e9 / (double)(now_ns() - start);
+}
+
+// thread counts probed: powers of two up to cpus, and cpus itself
+static unsigned int next_threads(unsigned int t, unsigned int cpus)
+{
+  return t < cpus && t * 2 > cpus ? cpus : t * 2;
+}
+
+// Probes every thread count from 1 to the number of processors.  Larger
+// counts have to beat the best so far by THREAD_MARGIN, so noise does not
+// oversubscribe.
+// set_threads, if not NULL, applies the count to the library instead of
+// running the probe on that many threads.
+static unsigned int tune_threads(const tune_fixture *fx, probe_fn fn, unsigned int cpus, uint64_t ns,
+                                 void (*set_threads)(unsigned int), double *best_rate)
+{
+  unsigned int t, best = 1;
+  double rate;
+
+  *best_rate = 0;
+  for (t = 1; t <= cpus; t = next_threads(t, cpus)) {
+    if (set_threads != NULL) {
+      set_threads(t);
+      rate = probe(fx, fn, 1, ns);
+    } else {
+      rate = probe(fx, fn, t, ns);
+    }
+    if (t == 1 || rate > *best_rate * THREAD_MARGIN) {
+      best = t;
+      *best_rate = rate;
+    }
+  }
+  return best;
+}
+
+static void set_recover_batch(unsigned int batch)
+{
+  ecdsa_batch_params params;
+
+  ecdsa_get_batch_params(&params);
+  params.recover_batch = batch;
+  ecdsa_set_batch_params(&params);
+}
+
+static void set_sign_batch(unsigned int batch)
+{
+  ecdsa_batch_params params;
+
+  ecdsa_get_batch_params(&params);
+  params.sign_batch = batch;
+  ecdsa_set_batch_params(&params);
+}
+
+static void set_sign_threads(unsigned int threads)
+{
+  ecdsa_batch_params params;
+
+  ecdsa_get_batch_params(&params);
+  params.sign_threads = threads;
+  ecdsa_set_batch_params(&params);
+}
+
+static unsigned int tune_batch(const tune_fixture *fx, probe_fn fn, void (*set_batch)(unsigned int), uint64_t ns, double *best_rate)
+{
+  unsigned int i, best = batch_candidates[0];
+  double rate;
+
+  *best_rate = 0;
+  for (i = 0; i < sizeof(batch_candidates) / sizeof(batch_candidates[0]); i++) {
+    set_batch(batch_candidates[i]);
+    rate = probe(fx, fn, 1, ns);
+    if (rate > *best_rate) {
+      best = batch_candidates[i];
+      *best_rate = rate;
+    }
+  }
+  set_batch(best);
+  return best;
+}
+
+static void fixture_free(tune_fixture *fx)
+{
+  free(fx->keys);
+  free(fx->digests);
+  free(fx->sigs);
+  free(fx->recids);
+  free(fx->out);
+  free(fx->results);
+}
+
+// Deterministic keys and digests and their signatures.
+static int fixture_init(tune_fixture *fx, const ecdsa_curve *curve, size_t n)
+{
+  uint8_t seed[9];
+  size_t i;
+
+  memset(fx, 0, sizeof(*fx));
+  fx->curve = curve;
+  fx->n = n;
+  fx->keys = malloc(n * 32);
+  fx->digests = malloc(n * 32);
+  fx->sigs = malloc(n * 64);
+  fx->recids = malloc(n * sizeof(int));
+  fx->out = malloc(n * 65);
+  fx->results = malloc(n * sizeof(int));
+  if (fx->keys == NULL || fx->digests == NULL || fx->sigs == NULL || fx->recids == NULL ||
+      fx->out == NULL || fx->results == NULL) {
+    fixture_free(fx);
+    return 1;
+  }
+
+  for (i = 0; i < n; i++) {
+    memcpy(seed, "yostune", 7);
+    seed[7] = (uint8_t)i;
+    seed[8] = (uint8_t)(i >> 8);
+    sha256_Raw(seed, sizeof(seed), fx->keys + 32 * i);
+    // keep every key below the order of both curves
+    fx->keys[32 * i] &= 0x7f;
+    sha256_Raw(fx->keys + 32 * i, 32, fx->digests + 32 * i);
+  }
+  ecdsa_sign_batch(curve, fx->keys, fx->digests, n, fx->sigs, fx->recids, NULL);
+  return 0;
+}
+
+void tune_defaults(tune_profile *profile)
+{
+  unsigned int cpus = online_cpus();
+
+  memset(profile, 0, sizeof(*profile));
+  profile->version = TUNE_PROFILE_VERSION;
+  profile->cpus = cpus;
+  profile->recover_batch = ECDSA_RECOVER_BATCH;
+  profile->recover_threads = cpus;
+  profile->sign_batch = ECDSA_SIGN_BATCH;
+  profile->sign_threads = cpus < ECDSA_SIGN_THREADS ? cpus : ECDSA_SIGN_THREADS;
+}
+
+int tune_run(const ecdsa_curve *curve, unsigned int budget_ms, tune_profile *profile)
+{
+  ecdsa_batch_params saved;
+  tune_fixture fx;
+  unsigned int cpus, thread_probes = 0, probes, t;
+  uint64_t ns;
+  double rate;
+
+  tune_defaults(profile);
+  cpus = profile->sign_threads;
+  if (fixture_init(&fx, curve, cpus * ECDSA_SIGN_BATCH > FIXTURE_MIN ? cpus * ECDSA_SIGN_BATCH : FIXTURE_MIN) != 0) {
+    return 1;
+  }
+  ecdsa_get_batch_params(&saved);
+
+  // split the budget evenly over all probes
+  for (t = 1; t <= cpus; t = next_threads(t, cpus)) {
+    thread_probes++;
+  }
+  probes = 2 * (sizeof(batch_candidates) / sizeof(batch_candidates[0])) + 2 * thread_probes;
+  ns = (uint64_t)(budget_ms ? budget_ms : TUNE_BUDGET_MS) * 1000000u / probes;
+
+  // recovery: chunk size, then the threads of the recover stage
+  profile->recover_batch = tune_batch(&fx, probe_recover, set_recover_batch, ns, &rate);
+  profile->recover_threads = tune_threads(&fx, probe_recover, cpus, ns, NULL, &profile->recover_rate);
+
+  // signing: chunk size on one thread, then the threads ecdsa_sign_batch uses
+  set_sign_threads(1);
+  profile->sign_batch = tune_batch(&fx, probe_sign, set_sign_batch, ns, &rate);
+  profile->sign_threads = tune_threads(&fx, probe_sign, cpus, ns, set_sign_threads, &profile->sign_rate);
+
+  ecdsa_set_batch_params(&saved);
+  fixture_free(&fx);
+  return 0;
+}
+
+int tune_save(const char *path, const tune_profile *profile)
+{
+  char tmp_path[1024];
+  FILE *f;
+  int res;
+
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp_path)) {
+    return 1;
+  }
+  f = fopen(tmp_path, "w");
+  if (f == NULL) {
+    return 1;
+  }
+  fprintf(f, "# yostune profile\n");
+  fprintf(f, "version %u\n", profile->version);
+  fprintf(f, "cpus %u\n", profile->cpus);
+  fprintf(f, "recover_batch %u\n", profile->recover_batch);
+  fprintf(f, "recover_threads %u\n", profile->recover_threads);
+  fprintf(f, "sign_batch %u\n", profile->sign_batch);
+  fprintf(f, "sign_threads %u\n", profile->sign_threads);
+  fprintf(f, "recover_rate %.1f\n", profile->recover_rate);
+  fprintf(f, "sign_rate %.1f\n", profile->sign_rate);
+  res = ferror(f);
+  if (fclose(f) != 0 || res != 0 || rename(tmp_path, path) != 0) {
+    unlink(tmp_path);
+    return 1;
+  }
+  return 0;
+}
+
+int tune_load(const char *path, tune_profile *profile)
+{
+  char line[128], key[64];
+  double value;
+  FILE *f;
+  tune_profile loaded;
+
+  f = fopen(path, "r");
+  if (f == NULL) {
+    return 1;
+  }
+  tune_defaults(&loaded);
+  loaded.version = 0;
+  loaded.cpus = 0;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (line[0] == '#' || sscanf(line, "%63s %lf", key, &value) != 2 || value < 0) {
+      continue;
+    }
+    if (strcmp(key, "version") == 0) {
+      loaded.version = (unsigned int)value;
+    } else if (strcmp(key, "cpus") == 0) {
+      loaded.cpus = (unsigned int)value;
+    } else if (strcmp(key, "recover_batch") == 0) {
+      loaded.recover_batch = (unsigned int)value;
+    } else if (strcmp(key, "recover_threads") == 0) {
+      loaded.recover_threads = (unsigned int)value;
+    } else if (strcmp(key, "sign_batch") == 0) {
+      loaded.sign_batch = (unsigned int)value;
+    } else if (strcmp(key, "sign_threads") == 0) {
+      loaded.sign_threads = (unsigned int)value;
+    } else if (strcmp(key, "recover_rate") == 0) {
+      loaded.recover_rate = value;
+    } else if (strcmp(key, "sign_rate") == 0) {
+      loaded.sign_rate = value;
+    }
+  }
+  fclose(f);
+
+  if (loaded.version != TUNE_PROFILE_VERSION || loaded.cpus != online_cpus()) {
+    return 1;
+  }
+  *profile = loaded;
+  return 0;
+}
+
+int tune_load_or_run(const char *path, const ecdsa_curve *curve, unsigned int budget_ms, tune_profile *profile)
+{
+  if (tune_load(path, profile) == 0) {
+    return 0;
+  }
+  if (tune_run(curve, budget_ms, profile) != 0) {
+    tune_defaults(profile);
+  } else {
+    tune_save(path, profile);
+  }
+  return 1;
+}
+
+void tune_apply(const tune_profile *profile)
+{
+  ecdsa_batch_params params;
+
+  params.recover_batch = profile->recover_batch;
+  params.sign_batch = profile->sign_batch;
+  params.sign_threads = profile->sign_threads;
+  ecdsa_set_batch_params(&params);
+}
+
+void tune_ingest_config(const tune_profile *profile, ingest_config *config)
+{
+  config->threads[INGEST_STAGE_RECOVER] = profile->recover_threads;
+  config->batch[INGEST_STAGE_RECOVER] = profile->recover_batch;
+}
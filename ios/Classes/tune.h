@@ -0,0 +1,72 @@
+//
+//  tune.h
+//  YosWalletTest
+//
+//  Created by Joe Park on 17/10/2026.
+//  Copyright © 2026 Joe Park. All rights reserved.
+//
+//  Calibration of the batch sizes and thread counts for the host.  Short
+//  timed probes of recovery and signing pick the parameters with the
+//  highest throughput, and the result is kept in a small text profile so
+//  later starts only load it:
+//
+//    tune_profile profile;
+//    tune_load_or_run(path, &secp256k1, 0, &profile);
+//    tune_apply(&profile);
+//
+//  tools/yostune.c runs the same calibration on demand.
+//
+
+#ifndef tune_h
+#define tune_h
+
+#include "ecdsa.h"
+#include "ingest.h"
+
+#define TUNE_PROFILE_VERSION  2
+#define TUNE_BUDGET_MS        2000   // default time for all probes together
+
+typedef struct {
+  unsigned int version;          // TUNE_PROFILE_VERSION
+  unsigned int cpus;             // online processors of the tuned host
+  unsigned int recover_batch;    // see ecdsa_batch_params
+  unsigned int recover_threads;  // threads of the ingest recover stage
+  unsigned int sign_batch;       // see ecdsa_batch_params
+  unsigned int sign_threads;     // see ecdsa_batch_params
+  // throughput measured with the chosen parameters, operations per second
+  double recover_rate;
+  double sign_rate;
+} tune_profile;
+
+// The untuned parameters: the largest batches and one thread per online
+// processor.
+void tune_defaults(tune_profile *profile);
+
+// Probes the primitives on curve for about budget_ms milliseconds (0 for
+// TUNE_BUDGET_MS) and stores the best parameters in profile.  Batch sizes
+// are chosen on one thread first, then the thread counts with those batch
+// sizes.  The batch parameters in effect before the call are restored.
+// returns 0 on success and 1 if the probe data could not be allocated
+int tune_run(const ecdsa_curve *curve, unsigned int budget_ms, tune_profile *profile);
+
+// Writes profile to path, under a temporary name that is then renamed.
+// returns 0 on success
+int tune_save(const char *path, const tune_profile *profile);
+
+// Reads the profile at path.  Profiles of another version or from a host
+// with a different number of processors are rejected.
+// returns 0 on success
+int tune_load(const char *path, tune_profile *profile);
+
+// Loads the profile at path, or tunes and saves it if there is no usable
+// profile.  A profile that cannot be saved is still returned.
+// returns 0 if the profile was loaded, 1 if it was tuned
+int tune_load_or_run(const char *path, const ecdsa_curve *curve, unsigned int budget_ms, tune_profile *profile);
+
+// Sets the batch parameters of the ecdsa batch functions from profile.
+void tune_apply(const tune_profile *profile);
+
+// Sets the recover stage of an ingest configuration from profile.
+void tune_ingest_config(const tune_profile *profile, ingest_config *config);
+
+#endif /* tune_h */
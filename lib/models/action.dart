@@ -6,17 +6,23 @@ import 'package:yosemite_wallet/models/authorization.dart';
 import 'package:yosemite_wallet/models/typeName.dart';
 import 'package:yosemite_wallet/pack/packer.dart';
 import 'package:yosemite_wallet/pack/byteWriter.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
 
 @immutable
 class Action implements Packer {
   final TypeName account;
   final TypeName name;
   final List<Authorization> authorization;
-  final String data;
+  final Uint8List dataBytes;
 
-  Action({String account, String name, this.authorization, this.data})
+  /// The action data is given either as hex in data or as dataBytes and is
+  /// kept as bytes.
+  Action({String account, String name, this.authorization, String data, Uint8List dataBytes})
       : this.account = TypeName(account),
-        this.name = TypeName(name);
+        this.name = TypeName(name),
+        this.dataBytes = dataBytes ?? (data != null ? Uint8List.fromList(hex.decode(data)) : null);
+
+  String get data => dataBytes != null ? encodeHex(dataBytes) : null;
 
   Map<String, dynamic> toJson() => {
         'account': account.toString(),
@@ -32,12 +38,21 @@ class Action implements Packer {
 
     byteWriter.putPackerList(authorization);
 
-    if (data != null) {
-      var dataAsBytes = hex.decode(data);
-      byteWriter.putVariableUint(dataAsBytes.length);
-      byteWriter.putUint8List(Uint8List.fromList(dataAsBytes));
+    if (dataBytes != null) {
+      byteWriter.putVariableUint(dataBytes.length);
+      byteWriter.putUint8List(dataBytes);
     } else {
       byteWriter.putVariableUint(0);
     }
   }
+
+  @override
+  int packedSize() {
+    final dataSize = dataBytes != null ? dataBytes.length : 0;
+
+    return 16 +
+        ByteWriter.packerListSize(authorization) +
+        ByteWriter.variableUintSize(dataSize) +
+        dataSize;
+  }
 }
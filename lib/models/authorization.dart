@@ -19,4 +19,7 @@ class Authorization implements Packer {
     actor.pack(byteWriter);
     permission.pack(byteWriter);
   }
+
+  @override
+  int packedSize() => 16;
 }
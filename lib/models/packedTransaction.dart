@@ -1,32 +1,60 @@
 import 'dart:typed_data';
 
+import 'package:crypto/crypto.dart';
 import 'package:yosemite_wallet/models/signedTransaction.dart';
-import 'package:yosemite_wallet/models/transaction.dart';
 import 'package:yosemite_wallet/pack/byteWriter.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
+import 'package:yosemite_wallet/pack/zlibEncoder.dart';
 
 class PackedTransaction {
+  static const String CompressionNone = 'none';
+  static const String CompressionZlib = 'zlib';
+
   final SignedTransaction signedTransaction;
 
   final String compression;
   final String packed_trx;
   final String packed_context_free_data;
 
-  PackedTransaction(this.signedTransaction)
-      : this.compression = 'none',
-        this.packed_context_free_data = '',
-        this.packed_trx = packTransaction(signedTransaction);
+  /// The transaction id, sha256 of the uncompressed packed transaction.
+  final String id;
+
+  /// A packed transaction from fields computed elsewhere, e.g. by a
+  /// TransactionWorkerPool.
+  PackedTransaction.fromParts(this.signedTransaction, this.compression, this.packed_trx,
+      this.packed_context_free_data, this.id);
+
+  factory PackedTransaction(SignedTransaction signedTransaction,
+      {String compression = CompressionNone}) {
+    // the packed bytes only live until they are hashed and hex encoded
+    ByteWriter byteWriter = ByteWriterPool.shared
+        .acquire(endian: Endian.little, capacity: signedTransaction.packedTransactionSize());
 
-  static String packTransaction(SignedTransaction transaction) {
-    ByteWriter byteWriter = ByteWriter(endian: Endian.little);
+    signedTransaction.packOnlyTransaction(byteWriter);
+    final bytes = byteWriter.doneAsBytes();
+    final id = encodeHex(sha256.convert(bytes).bytes);
+    final packedTrx = encodeHex(compress(bytes, compression));
 
-    transaction.packOnlyTransaction(byteWriter);
-    ByteData byteData = byteWriter.done();
-    Uint8List bytes = Uint8List.view(byteData.buffer, 0, byteData.lengthInBytes);
+    ByteWriterPool.shared.release(byteWriter);
 
-    final dataInHexStr =
-        bytes.fold('', (prev, elem) => '$prev${elem.toRadixString(16).padLeft(2, '0')}');
+    return PackedTransaction.fromParts(signedTransaction, compression, packedTrx,
+        encodeHex(compress(signedTransaction.packContextFreeData(), compression)), id);
+  }
+
+  static String packTransaction(SignedTransaction transaction, {String compression = CompressionNone}) {
+    return PackedTransaction(transaction, compression: compression).packed_trx;
+  }
 
-    return dataInHexStr;
+  /// Compresses packed bytes for the given compression.  Empty data stays
+  /// empty, as the node expects for missing context free data.
+  static List<int> compress(Uint8List bytes, String compression) {
+    if (compression == CompressionNone || bytes.isEmpty) {
+      return bytes;
+    }
+    if (compression == CompressionZlib) {
+      return zlibEncode(bytes);
+    }
+    throw ArgumentError.value(compression, 'compression');
   }
 
   Map<String, dynamic> toJson() {
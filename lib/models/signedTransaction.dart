@@ -1,6 +1,7 @@
 import 'dart:typed_data';
 
 import 'package:convert/convert.dart';
+import 'package:crypto/crypto.dart';
 import 'package:yosemite_wallet/models/transaction.dart';
 import 'package:yosemite_wallet/pack/byteWriter.dart';
 
@@ -24,22 +25,87 @@ class SignedTransaction extends Transaction {
     this.signatures.add(signature);
   }
 
+  /// The bytes of chainId.  The last chain id is kept decoded, as every
+  /// transaction is signed for the same chain.
+  static Uint8List chainIdBytes(String chainId) {
+    if (chainId != _lastChainId) {
+      _lastChainIdBytes = Uint8List.fromList(hex.decode(chainId));
+      _lastChainId = chainId;
+    }
+    return _lastChainIdBytes;
+  }
+
+  static String _lastChainId;
+  static Uint8List _lastChainIdBytes;
+
   Uint8List getDigestForSignature(String chainId) {
-    ByteWriter byteWriter = ByteWriter(endian: Endian.little);
+    return getDigestForSignatureBytes(chainIdBytes(chainId));
+  }
+
+  Uint8List getDigestForSignatureBytes(Uint8List chainId) {
+    ByteWriter byteWriter =
+        ByteWriter(endian: Endian.little, capacity: chainId.length + packedSize());
 
-    var chainIdBytes = hex.decode(chainId);
-    byteWriter.putUint8List(Uint8List.fromList(chainIdBytes));
+    byteWriter.putUint8List(chainId);
     pack(byteWriter);
 
-    ByteData byteData = byteWriter.done();
-    Uint8List bytes = Uint8List.view(byteData.buffer, 0, byteData.lengthInBytes);
-    return bytes;
+    return byteWriter.doneAsBytes();
   }
 
   void packOnlyTransaction(ByteWriter byteWriter) {
     super.pack(byteWriter);
   }
 
+  /// Size of the packed transaction without signatures and context free
+  /// data.
+  int packedTransactionSize() => super.packedSize();
+
+  /// The packed transaction without signatures and context free data.
+  Uint8List packTransactionBytes() {
+    ByteWriter byteWriter = ByteWriter(endian: Endian.little, capacity: packedTransactionSize());
+
+    packOnlyTransaction(byteWriter);
+
+    return byteWriter.doneAsBytes();
+  }
+
+  /// Size of the packed context free data, 0 if there is none.
+  int contextFreeDataSize() {
+    if (this.contextFreeData.length <= 0) {
+      return 0;
+    }
+
+    var size = ByteWriter.variableUintSize(this.contextFreeData.length);
+    for (String data in this.contextFreeData) {
+      size += ByteWriter.variableUintSize(data.length ~/ 2) + data.length ~/ 2;
+    }
+    return size;
+  }
+
+  void packContextFreeDataTo(ByteWriter byteWriter) {
+    byteWriter.putVariableUint(this.contextFreeData.length);
+    for (String data in this.contextFreeData) {
+      var dataAsBytes = hex.decode(data);
+      byteWriter.putVariableUint(dataAsBytes.length);
+      byteWriter.putUint8List(Uint8List.fromList(dataAsBytes));
+    }
+  }
+
+  /// The packed context free data, empty if there is none.
+  Uint8List packContextFreeData() {
+    if (this.contextFreeData.length <= 0) {
+      return Uint8List(0);
+    }
+
+    ByteWriter byteWriter = ByteWriter(endian: Endian.little, capacity: contextFreeDataSize());
+
+    packContextFreeDataTo(byteWriter);
+
+    return byteWriter.doneAsBytes();
+  }
+
+  /// The packed transaction followed by the sha256 digest of the context free
+  /// data, or 32 zero bytes if there is none.
   @override
   void pack(ByteWriter byteWriter) {
     super.pack(byteWriter);
@@ -47,11 +113,17 @@ class SignedTransaction extends Transaction {
     if (this.contextFreeData.length <= 0) {
       byteWriter.putUint8List(Uint8List(32));
     } else {
-      for (String data in this.contextFreeData) {
-        var dataAsBytes = hex.decode(data);
-        byteWriter.putVariableUint(dataAsBytes.length);
-        byteWriter.putUint8List(Uint8List.fromList(dataAsBytes));
-      }
+      // only hashed, so packed into a pooled writer
+      ByteWriter cfdWriter = ByteWriterPool.shared
+          .acquire(endian: Endian.little, capacity: contextFreeDataSize());
+
+      packContextFreeDataTo(cfdWriter);
+      byteWriter.putUint8List(Uint8List.fromList(sha256.convert(cfdWriter.doneAsBytes()).bytes));
+
+      ByteWriterPool.shared.release(cfdWriter);
     }
   }
+
+  @override
+  int packedSize() => super.packedSize() + 32;
 }
@@ -0,0 +1,30 @@
+import 'dart:typed_data';
+
+import 'package:convert/convert.dart';
+import 'package:meta/meta.dart';
+
+/// Transaction as proof of stake: the reference block and the expiration
+/// of a transaction.
+@immutable
+class Tapos {
+  final int refBlockNum; // uint16_t, lower 16 bits of the block number
+  final int refBlockPrefix; // uint32_t, bytes 8 to 12 of the block id
+  final String expiration;
+
+  Tapos(this.refBlockNum, this.refBlockPrefix, this.expiration);
+
+  factory Tapos.fromBlockId(String blockId, String expiration) {
+    return Tapos(refBlockNumOf(blockId), refBlockPrefixOf(blockId), expiration);
+  }
+
+  static int refBlockNumOf(String blockId) {
+    return int.parse(blockId.substring(0, 8), radix: 16) & 0xffff;
+  }
+
+  static int refBlockPrefixOf(String blockId) {
+    var blockPrefixBytes = hex.decode(blockId.substring(16, 24));
+    ByteData blockPrefixByteData = Uint8List.fromList(blockPrefixBytes).buffer.asByteData();
+
+    return blockPrefixByteData.getUint32(0, Endian.little);
+  }
+}
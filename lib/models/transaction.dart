@@ -47,4 +47,12 @@ class Transaction extends TransactionHeader {
     byteWriter.putPackerList(actions);
     byteWriter.putPackerList(transactionExtensions);
   }
+
+  @override
+  int packedSize() {
+    return super.packedSize() +
+        ByteWriter.packerListSize(contextFreeActions) +
+        ByteWriter.packerListSize(actions) +
+        ByteWriter.packerListSize(transactionExtensions);
+  }
 }
@@ -3,6 +3,7 @@ import 'dart:typed_data';
 import 'package:meta/meta.dart';
 import 'package:yosemite_wallet/pack/packer.dart';
 import 'package:yosemite_wallet/pack/byteWriter.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
 
 @immutable
 class TransactionExtension implements Packer {
@@ -15,9 +16,7 @@ class TransactionExtension implements Packer {
   TransactionExtension(this.field, this.data);
 
   List toJson() {
-    final dataInHexStr =
-        data.fold('', (prev, elem) => '$prev${elem.toRadixString(16).padLeft(2, '0')}');
-    return [field, dataInHexStr];
+    return [field, encodeHex(data)];
   }
 
   @override
@@ -26,4 +25,7 @@ class TransactionExtension implements Packer {
     byteWriter.putVariableUint(data.lengthInBytes);
     byteWriter.putUint8List(data);
   }
+
+  @override
+  int packedSize() => 2 + ByteWriter.variableUintSize(data.lengthInBytes) + data.lengthInBytes;
 }
@@ -1,6 +1,4 @@
-import 'dart:typed_data';
-
-import 'package:convert/convert.dart';
+import 'package:yosemite_wallet/models/tapos.dart';
 import 'package:yosemite_wallet/pack/byteWriter.dart';
 import 'package:yosemite_wallet/pack/packer.dart';
 
@@ -44,12 +42,14 @@ class TransactionHeader implements Packer {
   }
 
   set referenceBlock(String referenceBlockId) {
-    _refBlockNum = int.tryParse(referenceBlockId.substring(0, 8), radix: 16);
-
-    var blockPrefixBytes = hex.decode(referenceBlockId.substring(16, 24));
-    ByteData blockPrefixByteData = Uint8List.fromList(blockPrefixBytes).buffer.asByteData();
+    _refBlockNum = Tapos.refBlockNumOf(referenceBlockId);
+    _refBlockPrefix = Tapos.refBlockPrefixOf(referenceBlockId);
+  }
 
-    _refBlockPrefix = blockPrefixByteData.getUint32(0, Endian.little);
+  set tapos(Tapos tapos) {
+    _refBlockNum = tapos.refBlockNum;
+    _refBlockPrefix = tapos.refBlockPrefix;
+    _expiration = tapos.expiration;
   }
 
   @override
@@ -77,4 +77,12 @@ class TransactionHeader implements Packer {
     byteWriter.putVariableUint(_maxCpuUsageMs);
     byteWriter.putVariableUint(_delaySec);
   }
+
+  @override
+  int packedSize() {
+    return 10 +
+        ByteWriter.variableUintSize(_maxNetUsageWord) +
+        ByteWriter.variableUintSize(_maxCpuUsageMs) +
+        ByteWriter.variableUintSize(_delaySec);
+  }
 }
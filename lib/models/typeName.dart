@@ -71,6 +71,9 @@ class TypeName implements Packer {
     byteWriter.putUint8List(_value);
   }
 
+  @override
+  int packedSize() => 8;
+
   @override
   toString() {
     return _name;
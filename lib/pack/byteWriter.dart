@@ -1,83 +1,99 @@
 import 'dart:typed_data';
 
-import 'package:typed_data/typed_buffers.dart' show Uint8Buffer;
 import 'package:yosemite_wallet/pack/packer.dart';
 
 /// Write-only buffer for incrementally building a [ByteData] instance.
 ///
-/// A WriteBuffer instance can be used only once. Attempts to reuse will result
-/// in [NoSuchMethodError]s being thrown.
+/// The bytes are written into a [Uint8List] of the given [capacity], which
+/// doubles when it runs out.  Packers report their size through
+/// [Packer.packedSize], so a writer created with the exact size never grows.
+///
+/// After [done] the writer cannot be written to until it is [reset], which
+/// reuses its buffer; see [ByteWriterPool].
 ///
 class ByteWriter {
   /// Creates an interface for incrementally building a [ByteData] instance.
-  ByteWriter({Endian endian}) : _endian = endian ?? Endian.host {
-    _buffer = Uint8Buffer();
-    _eightBytes = ByteData(8);
-    _eightBytesAsList = _eightBytes.buffer.asUint8List();
+  ByteWriter({Endian endian, int capacity = 64}) : _endian = endian ?? Endian.host {
+    _bytes = Uint8List(capacity > 8 ? capacity : 8);
+    _data = _bytes.buffer.asByteData();
+    _capacity = _bytes.length;
   }
 
-  Uint8Buffer _buffer;
-  ByteData _eightBytes;
-  Uint8List _eightBytesAsList;
-  final Endian _endian;
+  Uint8List _bytes;
+  ByteData _data;
+  int _length = 0;
+  int _capacity; // -1 once done, so every write takes the _grow path
+  Endian _endian;
+
+  /// Number of bytes written so far.
+  int get length => _length;
+
+  /// Size of the buffer.
+  int get capacity => _bytes.length;
 
   /// Write a Uint8 into the buffer.
   void putUint8(int byte) {
-    _buffer.add(byte);
+    if (_length + 1 > _capacity) _grow(1);
+    _bytes[_length++] = byte;
   }
 
   /// Write a Uint16 into the buffer.
   void putUint16(int value) {
-    _eightBytes.setUint16(0, value, _endian);
-    _buffer.addAll(_eightBytesAsList, 0, 2);
+    if (_length + 2 > _capacity) _grow(2);
+    _data.setUint16(_length, value, _endian);
+    _length += 2;
   }
 
   /// Write a Uint32 into the buffer.
   void putUint32(int value) {
-    _eightBytes.setUint32(0, value, _endian);
-    _buffer.addAll(_eightBytesAsList, 0, 4);
+    if (_length + 4 > _capacity) _grow(4);
+    _data.setUint32(_length, value, _endian);
+    _length += 4;
   }
 
   /// Write an Int32 into the buffer.
   void putInt32(int value) {
-    _eightBytes.setInt32(0, value, _endian);
-    _buffer.addAll(_eightBytesAsList, 0, 4);
+    if (_length + 4 > _capacity) _grow(4);
+    _data.setInt32(_length, value, _endian);
+    _length += 4;
   }
 
   /// Write an Int64 into the buffer.
   void putInt64(int value) {
-    _eightBytes.setInt64(0, value, _endian);
-    _buffer.addAll(_eightBytesAsList, 0, 8);
+    if (_length + 8 > _capacity) _grow(8);
+    _data.setInt64(_length, value, _endian);
+    _length += 8;
   }
 
   /// Write an Float64 into the buffer.
   void putFloat64(double value) {
     _alignTo(8);
-    _eightBytes.setFloat64(0, value, _endian);
-    _buffer.addAll(_eightBytesAsList);
+    if (_length + 8 > _capacity) _grow(8);
+    _data.setFloat64(_length, value, _endian);
+    _length += 8;
   }
 
   /// Write all the values from a [Uint8List] into the buffer.
   void putUint8List(Uint8List list) {
-    _buffer.addAll(list);
+    _putBytes(list);
   }
 
   /// Write all the values from an [Int32List] into the buffer.
   void putInt32List(Int32List list) {
     _alignTo(4);
-    _buffer.addAll(list.buffer.asUint8List(list.offsetInBytes, 4 * list.length));
+    _putBytes(list.buffer.asUint8List(list.offsetInBytes, 4 * list.length));
   }
 
   /// Write all the values from an [Int64List] into the buffer.
   void putInt64List(Int64List list) {
     _alignTo(8);
-    _buffer.addAll(list.buffer.asUint8List(list.offsetInBytes, 8 * list.length));
+    _putBytes(list.buffer.asUint8List(list.offsetInBytes, 8 * list.length));
   }
 
   /// Write all the values from a [Float64List] into the buffer.
   void putFloat64List(Float64List list) {
     _alignTo(8);
-    _buffer.addAll(list.buffer.asUint8List(list.offsetInBytes, 8 * list.length));
+    _putBytes(list.buffer.asUint8List(list.offsetInBytes, 8 * list.length));
   }
 
   void putPackerList<T extends Packer>(List<T> packers) {
@@ -104,18 +120,107 @@ class ByteWriter {
     } while (val != 0);
   }
 
+  /// Number of bytes [putVariableUint] writes for value.
+  static int variableUintSize(int value) {
+    var size = 1;
+
+    while ((value >>= 7) != 0) {
+      size++;
+    }
+    return size;
+  }
+
+  /// Number of bytes [putPackerList] writes for packers.
+  static int packerListSize<T extends Packer>(List<T> packers) {
+    if (packers == null || packers.isEmpty) {
+      return 1;
+    }
+
+    var size = variableUintSize(packers.length);
+    for (Packer packer in packers) {
+      size += packer.packedSize();
+    }
+    return size;
+  }
+
+  void _putBytes(Uint8List list) {
+    if (_length + list.length > _capacity) _grow(list.length);
+    _bytes.setRange(_length, _length + list.length, list);
+    _length += list.length;
+  }
+
+  void _grow(int needed) {
+    if (_capacity < 0) {
+      throw StateError('ByteWriter used after done()');
+    }
+
+    var capacity = _bytes.length * 2;
+    while (capacity < _length + needed) {
+      capacity *= 2;
+    }
+
+    final bytes = Uint8List(capacity);
+    bytes.setRange(0, _length, _bytes);
+    _bytes = bytes;
+    _data = bytes.buffer.asByteData();
+    _capacity = capacity;
+  }
+
   void _alignTo(int alignment) {
-    final int mod = _buffer.length % alignment;
+    final int mod = _length % alignment;
     if (mod != 0) {
-      for (int i = 0; i < alignment - mod; i++) _buffer.add(0);
+      for (int i = 0; i < alignment - mod; i++) putUint8(0);
     }
   }
 
   /// Finalize and return the written [ByteData].
+  ///
+  /// The result is a view of the writer's buffer, valid until [reset].
   ByteData done() {
-    final ByteData result = _buffer.buffer.asByteData(0, _buffer.lengthInBytes);
-    _buffer = null;
-    return result;
+    _capacity = -1;
+    return _data.buffer.asByteData(0, _length);
+  }
+
+  /// Finalize and return the written bytes, see [done].
+  Uint8List doneAsBytes() {
+    _capacity = -1;
+    return Uint8List.view(_bytes.buffer, 0, _length);
+  }
+
+  /// Empties the writer for reuse, keeping its buffer.
+  void reset({Endian endian}) {
+    _length = 0;
+    _capacity = _bytes.length;
+    _endian = endian ?? _endian;
+  }
+}
+
+/// Pool of writers whose buffers are reused across packs.
+///
+/// A writer must only be released once nothing refers to the bytes it
+/// returned from [ByteWriter.done].
+class ByteWriterPool {
+  static final ByteWriterPool shared = ByteWriterPool();
+
+  final int maxPooled;
+  final List<ByteWriter> _free = [];
+
+  ByteWriterPool({this.maxPooled = 8});
+
+  /// A writer with room for at least capacity bytes.
+  ByteWriter acquire({Endian endian, int capacity = 64}) {
+    for (int i = _free.length - 1; i >= 0; i--) {
+      if (_free[i].capacity >= capacity) {
+        return _free.removeAt(i)..reset(endian: endian ?? Endian.host);
+      }
+    }
+    return ByteWriter(endian: endian, capacity: capacity);
+  }
+
+  void release(ByteWriter writer) {
+    if (_free.length < maxPooled) {
+      _free.add(writer);
+    }
   }
 }
 
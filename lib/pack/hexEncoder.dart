@@ -0,0 +1,29 @@
+import 'dart:typed_data';
+
+const _digits = '0123456789abcdef';
+
+/// Both hex digits of every byte value as one 16-bit unit in host byte
+/// order, so a byte is encoded with a single lookup and store.
+final Uint16List _pairs = _buildPairs();
+
+Uint16List _buildPairs() {
+  final pairs = Uint16List(256);
+  final little = Endian.host == Endian.little;
+
+  for (int i = 0; i < 256; i++) {
+    final hi = _digits.codeUnitAt(i >> 4);
+    final lo = _digits.codeUnitAt(i & 0xf);
+    pairs[i] = little ? hi | (lo << 8) : (hi << 8) | lo;
+  }
+  return pairs;
+}
+
+/// Encodes bytes as lowercase hex in linear time.
+String encodeHex(List<int> bytes) {
+  final out = Uint16List(bytes.length);
+
+  for (int i = 0; i < bytes.length; i++) {
+    out[i] = _pairs[bytes[i] & 0xff];
+  }
+  return String.fromCharCodes(out.buffer.asUint8List());
+}
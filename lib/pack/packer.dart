@@ -2,4 +2,19 @@ import 'package:yosemite_wallet/pack/byteWriter.dart';
 
 abstract class Packer {
   void pack(ByteWriter byteWriter);
+
+  /// Number of bytes [pack] writes.
+  ///
+  /// By default the packer is packed into a pooled scratch writer and the
+  /// bytes are counted.  Packers that know their size without packing
+  /// override this, as all packers of this package do.
+  int packedSize() {
+    final byteWriter = ByteWriterPool.shared.acquire();
+
+    pack(byteWriter);
+    final size = byteWriter.length;
+    ByteWriterPool.shared.release(byteWriter);
+
+    return size;
+  }
 }
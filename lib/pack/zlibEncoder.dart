@@ -0,0 +1,5 @@
+/// zlib compression of packed data: dart:io's native encoder where dart:io
+/// exists, and the pure Dart one of package:archive elsewhere, e.g. on the
+/// web.
+export 'package:yosemite_wallet/pack/zlibEncoderArchive.dart'
+    if (dart.library.io) 'package:yosemite_wallet/pack/zlibEncoderIo.dart';
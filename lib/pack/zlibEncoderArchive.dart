@@ -0,0 +1,5 @@
+import 'package:archive/archive.dart' show ZLibEncoder;
+
+/// Compresses bytes with the zlib of package:archive, for platforms without
+/// dart:io.
+List<int> zlibEncode(List<int> bytes) => ZLibEncoder().encode(bytes);
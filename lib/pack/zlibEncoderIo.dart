@@ -0,0 +1,4 @@
+import 'dart:io' show ZLibEncoder;
+
+/// Compresses bytes with dart:io's native zlib.
+List<int> zlibEncode(List<int> bytes) => ZLibEncoder().convert(bytes);
@@ -0,0 +1,82 @@
+import 'dart:async';
+
+import 'package:yosemite_wallet/models/info.dart';
+import 'package:yosemite_wallet/models/tapos.dart';
+
+typedef Future<Info> ChainInfoFetcher();
+
+/// Caches the chain info for [ttl] so building a transaction does not need
+/// a get_info round trip.
+///
+/// Once the cached info is older than [refreshAfter] it is still returned,
+/// but a refresh is started in the background, so steady callers never wait
+/// for the network.  Concurrent callers share a single request.
+class ChainInfoCache {
+  final ChainInfoFetcher _fetch;
+  final Duration ttl;
+  final Duration refreshAfter;
+
+  Info _info;
+  final Stopwatch _age = Stopwatch();
+  Future<Info> _inFlight;
+
+  ChainInfoCache(this._fetch, {this.ttl = const Duration(seconds: 30), Duration refreshAfter})
+      : this.refreshAfter = refreshAfter ?? ttl * 2 ~/ 3;
+
+  /// The cached info, or null if there is none or it expired.
+  Info get cached => _info != null && _age.elapsed < ttl ? _info : null;
+
+  Future<Info> getChainInfo() {
+    if (_info != null) {
+      final age = _age.elapsed;
+      if (age < ttl) {
+        if (age >= refreshAfter) {
+          // keep serving the cached info if the refresh fails
+          refresh().catchError((_) => null);
+        }
+        return Future.value(_info);
+      }
+    }
+    return refresh();
+  }
+
+  /// Fetches the chain info now, or joins the request already in flight.
+  Future<Info> refresh() {
+    if (_inFlight == null) {
+      _inFlight = _fetch().then((Info info) {
+        _info = info;
+        _age
+          ..reset()
+          ..start();
+        return info;
+      }).whenComplete(() {
+        _inFlight = null;
+      });
+    }
+    return _inFlight;
+  }
+
+  /// TAPOS values referencing the cached head block.  The expiration is
+  /// counted from the current head block time, estimated from the cached
+  /// head block time and the age of the cache.
+  Future<Tapos> getTapos({Duration expiresIn = const Duration(minutes: 10)}) async {
+    await getChainInfo();
+
+    final info = _info;
+    final headBlockTime = DateTime.parse(info.headBlockTime).toUtc();
+    final expiresAt = headBlockTime.add(_age.elapsed + expiresIn);
+    // whole seconds, as the transaction header stores them
+    final expiration = DateTime.fromMillisecondsSinceEpoch(
+        expiresAt.millisecondsSinceEpoch ~/ 1000 * 1000,
+        isUtc: true);
+
+    return Tapos.fromBlockId(info.headBlockId, expiration.toIso8601String());
+  }
+
+  void invalidate() {
+    _info = null;
+    _age
+      ..stop()
+      ..reset();
+  }
+}
@@ -3,6 +3,8 @@ import 'dart:convert';
 
 import 'package:http/http.dart' as http;
 import 'package:yosemite_wallet/models/info.dart';
+import 'package:yosemite_wallet/models/tapos.dart';
+import 'package:yosemite_wallet/services/chainInfoCache.dart';
 
 class ChainApiServerException implements Exception {
   final message;
@@ -18,8 +20,14 @@ class ChainApiServerException implements Exception {
 class ChainService {
   final http.Client httpClient;
   final String baseUrl;
+  ChainInfoCache _chainInfoCache;
 
-  ChainService(this.baseUrl) : this.httpClient = new http.Client();
+  ChainService(this.baseUrl, {Duration chainInfoTtl = const Duration(seconds: 30)})
+      : this.httpClient = new http.Client() {
+    _chainInfoCache = ChainInfoCache(getChainInfo, ttl: chainInfoTtl);
+  }
+
+  ChainInfoCache get chainInfoCache => _chainInfoCache;
 
   Future<String> getAbi(String code, String action, Map data) async {
     final path = '/v1/chain/abi_json_to_bin';
@@ -54,6 +62,17 @@ class ChainService {
     }
   }
 
+  /// The chain info, from the cache while it is fresh.
+  Future<Info> getCachedChainInfo() {
+    return _chainInfoCache.getChainInfo();
+  }
+
+  /// Reference block and expiration for a new transaction, derived from
+  /// the cached chain info.
+  Future<Tapos> getTapos({Duration expiresIn = const Duration(minutes: 10)}) {
+    return _chainInfoCache.getTapos(expiresIn: expiresIn);
+  }
+
   dispose() {
     this.httpClient.close();
   }
@@ -0,0 +1,191 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/services/chainService.dart';
+
+class PushStats {
+  int pushed = 0; // transactions answered by the node
+  int failed = 0; // transactions failed after all retries
+  int batches = 0; // push_transactions requests sent, retries included
+  int retries = 0;
+}
+
+class _Pending {
+  final PackedTransaction transaction;
+  final Completer<Map<String, dynamic>> completer = Completer();
+
+  _Pending(this.transaction);
+}
+
+/// Pushes signed transactions to a node in bursts.
+///
+/// Transactions are queued and sent as push_transactions batches of up to
+/// [batchSize], with at most [maxConnections] batches in flight over a pool
+/// of keep-alive connections.  A batch that fails on the network or with a
+/// server error is retried up to [maxRetries] times after an exponential
+/// backoff with full jitter, capped at [maxRetryDelay].
+class PushClient {
+  final String baseUrl;
+  final int maxConnections;
+  final int batchSize;
+  final Duration batchDelay;
+  final int maxRetries;
+  final Duration retryDelay;
+  final Duration maxRetryDelay;
+  final PushStats stats = PushStats();
+
+  final HttpClient _httpClient;
+  final Random _random;
+  final Queue<_Pending> _queue = Queue();
+  int _inFlight = 0;
+  Timer _flushTimer;
+
+  PushClient(this.baseUrl,
+      {this.maxConnections = 8,
+      this.batchSize = 100,
+      this.batchDelay = const Duration(milliseconds: 2),
+      this.maxRetries = 3,
+      this.retryDelay = const Duration(milliseconds: 100),
+      this.maxRetryDelay = const Duration(seconds: 10),
+      Random random})
+      : this._httpClient = HttpClient()
+          ..maxConnectionsPerHost = maxConnections
+          ..idleTimeout = const Duration(seconds: 30),
+        this._random = random ?? Random();
+
+  /// Queues transaction for the next batch.  Completes with the result the
+  /// node returned for it.
+  Future<Map<String, dynamic>> push(PackedTransaction transaction) {
+    final pending = _Pending(transaction);
+    _queue.add(pending);
+
+    if (_queue.length >= batchSize) {
+      _flush();
+    } else if (_flushTimer == null) {
+      _flushTimer = Timer(batchDelay, _flush);
+    }
+    return pending.completer.future;
+  }
+
+  Future<List<Map<String, dynamic>>> pushAll(Iterable<PackedTransaction> transactions) {
+    return Future.wait(transactions.map(push));
+  }
+
+  void _flush() {
+    _flushTimer?.cancel();
+    _flushTimer = null;
+
+    while (_queue.isNotEmpty && _inFlight < maxConnections) {
+      final batch = <_Pending>[];
+      while (_queue.isNotEmpty && batch.length < batchSize) {
+        batch.add(_queue.removeFirst());
+      }
+      _inFlight++;
+      _send(batch).whenComplete(() {
+        _inFlight--;
+        _flush();
+      });
+    }
+  }
+
+  Future<void> _send(List<_Pending> batch) async {
+    final body = _encode(batch);
+
+    for (int attempt = 0;; attempt++) {
+      try {
+        stats.batches++;
+        final results = await _post(body);
+        if (results.length != batch.length) {
+          throw ChainApiServerException('push_transactions returned ${results.length} results '
+              'for ${batch.length} transactions');
+        }
+        for (int i = 0; i < batch.length; i++) {
+          batch[i].completer.complete(results[i]);
+        }
+        stats.pushed += batch.length;
+        return;
+      } catch (e) {
+        if (!_isRetriable(e) || attempt >= maxRetries) {
+          for (final pending in batch) {
+            pending.completer.completeError(e);
+          }
+          stats.failed += batch.length;
+          return;
+        }
+      }
+      stats.retries++;
+      await Future.delayed(_backoff(attempt));
+    }
+  }
+
+  // The transactions are encoded one by one straight into the body bytes,
+  // without building a JSON document of the whole batch first.
+  Uint8List _encode(List<_Pending> batch) {
+    final encoder = JsonUtf8Encoder();
+    final builder = BytesBuilder(copy: false);
+
+    builder.addByte(0x5b); // [
+    for (int i = 0; i < batch.length; i++) {
+      if (i > 0) {
+        builder.addByte(0x2c); // ,
+      }
+      builder.add(encoder.convert(batch[i].transaction.toJson()));
+    }
+    builder.addByte(0x5d); // ]
+    return builder.takeBytes();
+  }
+
+  Future<List<dynamic>> _post(Uint8List body) async {
+    final request = await _httpClient.postUrl(Uri.parse(baseUrl + '/v1/chain/push_transactions'));
+    request.headers.contentType = ContentType.json;
+    request.contentLength = body.length;
+    request.add(body);
+
+    final response = await request.close();
+    final responseBody = await response.transform(utf8.decoder).join();
+
+    if (response.statusCode != 200) {
+      throw _PushHttpException(response.statusCode, responseBody);
+    }
+    return json.decode(responseBody);
+  }
+
+  bool _isRetriable(Object e) {
+    if (e is _PushHttpException) {
+      return e.statusCode >= 500;
+    }
+    return e is SocketException || e is HttpException || e is TimeoutException;
+  }
+
+  // Random.nextInt takes bounds up to 2^32
+  static const int _maxRandomBound = 0x100000000;
+
+  // full jitter: a random delay up to retryDelay * 2^attempt, doubled only
+  // while below maxRetryDelay so it cannot overflow on late attempts
+  Duration _backoff(int attempt) {
+    final limit = min(maxRetryDelay.inMicroseconds, _maxRandomBound);
+    int cap = retryDelay.inMicroseconds;
+
+    for (int i = 0; i < attempt && cap < limit; i++) {
+      cap *= 2;
+    }
+    return Duration(microseconds: _random.nextInt(max(min(cap, limit), 1)));
+  }
+
+  void dispose() {
+    _flushTimer?.cancel();
+    _httpClient.close(force: true);
+  }
+}
+
+class _PushHttpException extends ChainApiServerException {
+  final int statusCode;
+
+  _PushHttpException(this.statusCode, String body)
+      : super('Failed to push: code: ' + statusCode.toString() + ' ' + body);
+}
@@ -0,0 +1,176 @@
+import 'dart:async';
+import 'dart:io' show Platform;
+import 'dart:isolate';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:crypto/crypto.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/pack/byteWriter.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
+
+/// The packed bytes, signing digest and push encoding of a transaction,
+/// computed by a [TransactionWorkerPool].
+class PreparedTransaction {
+  /// The packed transaction without signatures and context free data.
+  final Uint8List packedTrx;
+
+  /// The packed context free data, empty if there is none.
+  final Uint8List packedContextFreeData;
+
+  /// sha256(chain id | packed transaction | context free data digest), the
+  /// digest a signature is made over.
+  final Uint8List digest;
+
+  final String id;
+  final String compression;
+
+  /// packedTrx and packedContextFreeData compressed and hex encoded, as
+  /// push_transaction expects them.
+  final String packedTrxHex;
+  final String packedContextFreeDataHex;
+
+  PreparedTransaction(this.packedTrx, this.packedContextFreeData, this.digest, this.id,
+      this.compression, this.packedTrxHex, this.packedContextFreeDataHex);
+
+  PackedTransaction toPackedTransaction(SignedTransaction transaction) {
+    return PackedTransaction.fromParts(
+        transaction, compression, packedTrxHex, packedContextFreeDataHex, id);
+  }
+}
+
+class _Job {
+  final List<SignedTransaction> transactions;
+  final Uint8List chainId;
+  final String compression;
+
+  _Job(this.transactions, this.chainId, this.compression);
+}
+
+class _JobError {
+  final String error;
+  final String stackTrace;
+
+  _JobError(this.error, this.stackTrace);
+}
+
+/// Packs, hashes and hex encodes transactions on background isolates.
+///
+/// A batch passed to [prepare] is split evenly over the workers, so the
+/// calling isolate only copies the transactions out and the results back
+/// and stays responsive during a burst.  Workers are spawned with
+/// Isolate.spawn and share the code of the caller, so transactions are
+/// sent as they are.
+class TransactionWorkerPool {
+  final List<Isolate> _isolates;
+  final List<SendPort> _workers;
+  int _next = 0;
+
+  TransactionWorkerPool._(this._isolates, this._workers);
+
+  /// Starts a pool of [size] workers, by default one less than the number
+  /// of processors, leaving one for the calling isolate.
+  static Future<TransactionWorkerPool> spawn({int size}) async {
+    size ??= max(1, Platform.numberOfProcessors - 1);
+
+    final isolates = <Isolate>[];
+    final workers = <SendPort>[];
+    for (int i = 0; i < size; i++) {
+      final ready = ReceivePort();
+      isolates.add(await Isolate.spawn(_workerMain, ready.sendPort));
+      workers.add(await ready.first);
+    }
+    return TransactionWorkerPool._(isolates, workers);
+  }
+
+  int get size => _workers.length;
+
+  /// Prepares transactions for signing with the chain id and for push with
+  /// the given compression.  The results are in the order of transactions.
+  Future<List<PreparedTransaction>> prepare(List<SignedTransaction> transactions, String chainId,
+      {String compression = PackedTransaction.CompressionNone}) async {
+    if (_workers.isEmpty) {
+      throw StateError('TransactionWorkerPool is closed');
+    }
+    if (transactions.isEmpty) {
+      return [];
+    }
+
+    final chainIdBytes = SignedTransaction.chainIdBytes(chainId);
+    final chunkSize = (transactions.length + size - 1) ~/ size;
+    final chunks = <Future<List<PreparedTransaction>>>[];
+    for (int i = 0; i < transactions.length; i += chunkSize) {
+      final end = min(i + chunkSize, transactions.length);
+      chunks.add(_run(_Job(transactions.sublist(i, end), chainIdBytes, compression)));
+    }
+
+    final results = await Future.wait(chunks);
+    return results.expand((chunk) => chunk).toList();
+  }
+
+  Future<List<PreparedTransaction>> _run(_Job job) async {
+    final response = ReceivePort();
+
+    _workers[_next++ % _workers.length].send([response.sendPort, job]);
+
+    final reply = await response.first;
+    if (reply is _JobError) {
+      throw RemoteError(reply.error, reply.stackTrace);
+    }
+    return (reply as List).cast<PreparedTransaction>();
+  }
+
+  /// Stops the workers.  Batches still in flight never complete.
+  void close() {
+    for (final isolate in _isolates) {
+      isolate.kill(priority: Isolate.immediate);
+    }
+    _isolates.clear();
+    _workers.clear();
+  }
+
+  static void _workerMain(SendPort ready) {
+    final requests = ReceivePort();
+
+    ready.send(requests.sendPort);
+    requests.listen((message) {
+      final SendPort reply = message[0];
+      final _Job job = message[1];
+
+      try {
+        reply.send(job.transactions
+            .map((transaction) => prepareTransaction(transaction, job.chainId, job.compression))
+            .toList());
+      } catch (e, stackTrace) {
+        reply.send(_JobError(e.toString(), stackTrace.toString()));
+      }
+    });
+  }
+
+  /// What a worker computes for one transaction, on the calling isolate.
+  static PreparedTransaction prepareTransaction(
+      SignedTransaction transaction, Uint8List chainId, String compression) {
+    final packedTrx = transaction.packTransactionBytes();
+    final packedContextFreeData = transaction.packContextFreeData();
+
+    ByteWriter preimage = ByteWriterPool.shared
+        .acquire(endian: Endian.little, capacity: chainId.length + packedTrx.length + 32);
+    preimage.putUint8List(chainId);
+    preimage.putUint8List(packedTrx);
+    preimage.putUint8List(packedContextFreeData.isEmpty
+        ? Uint8List(32)
+        : Uint8List.fromList(sha256.convert(packedContextFreeData).bytes));
+    final digest = Uint8List.fromList(sha256.convert(preimage.doneAsBytes()).bytes);
+    ByteWriterPool.shared.release(preimage);
+
+    return PreparedTransaction(
+        packedTrx,
+        packedContextFreeData,
+        digest,
+        encodeHex(sha256.convert(packedTrx).bytes),
+        compression,
+        encodeHex(PackedTransaction.compress(packedTrx, compression)),
+        encodeHex(PackedTransaction.compress(packedContextFreeData, compression)));
+  }
+}
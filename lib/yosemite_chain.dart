@@ -3,8 +3,12 @@ export 'models/authorization.dart';
 export 'models/info.dart';
 export 'models/signedTransaction.dart';
 export 'models/packedTransaction.dart';
+export 'models/tapos.dart';
 export 'models/transaction.dart';
 export 'models/transactionExtension.dart';
 export 'models/transactionHeader.dart';
+export 'services/chainInfoCache.dart';
 export 'services/chainService.dart';
+export 'services/pushClient.dart';
+export 'services/transactionWorkerPool.dart';
 export 'yosemite_wallet.dart';
\ No newline at end of file
@@ -2,6 +2,9 @@ import 'dart:async';
 import 'dart:typed_data';
 
 import 'package:flutter/services.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/services/transactionWorkerPool.dart';
 
 class YosemiteWallet {
   static const MethodChannel _channel = const MethodChannel('com.yosemitex.yosemite_wallet');
@@ -30,6 +33,62 @@ class YosemiteWallet {
     return await _channel.invokeMethod('signMessageData', {'data': data});
   }
 
+  /// Signs the transaction for the chain with the given id.
+  ///
+  /// Only the packed transaction and context free data are sent; the digest
+  /// is computed natively while streaming over them.
+  static Future<String> signTransaction(SignedTransaction transaction, String chainId) async {
+    return await _channel.invokeMethod('signTransaction', {
+      'chainId': SignedTransaction.chainIdBytes(chainId),
+      'packedTrx': transaction.packTransactionBytes(),
+      'packedContextFreeData': transaction.packContextFreeData()
+    });
+  }
+
+  /// Signs a batch of prepared transactions with a single platform call.
+  ///
+  /// Only the digests computed by the pool are sent and signed as they are,
+  /// natively and off the platform thread.  The result holds a signature,
+  /// or null if signing failed, for every transaction.
+  static Future<List<String>> signTransactions(List<PreparedTransaction> transactions) async {
+    final List<dynamic> signatures = await _channel.invokeMethod('signDigests', {
+      'digests': transactions.map((transaction) => transaction.digest).toList()
+    });
+    return signatures?.cast<String>();
+  }
+
+  /// Packs and signs transactions for push.  Packing, hashing and hex
+  /// encoding run on pool, signing natively in one batch, so the calling
+  /// isolate does none of the heavy work.  The signatures are also added to
+  /// transactions.
+  ///
+  /// Throws a [StateError] if any transaction could not be signed, before
+  /// a signature is added to any of them.
+  static Future<List<PackedTransaction>> signAndPackTransactions(
+      TransactionWorkerPool pool, List<SignedTransaction> transactions, String chainId,
+      {String compression = PackedTransaction.CompressionNone}) async {
+    final prepared = await pool.prepare(transactions, chainId, compression: compression);
+    final signatures = await signTransactions(prepared);
+
+    if (signatures == null || signatures.length != transactions.length) {
+      throw StateError('Failed to sign transactions');
+    }
+    final failed = <int>[];
+    for (int i = 0; i < signatures.length; i++) {
+      if (signatures[i] == null) {
+        failed.add(i);
+      }
+    }
+    if (failed.isNotEmpty) {
+      throw StateError('Failed to sign transactions at $failed');
+    }
+    for (int i = 0; i < transactions.length; i++) {
+      transactions[i].addSignature(signatures[i]);
+    }
+    return List.generate(
+        transactions.length, (i) => prepared[i].toPackedTransaction(transactions[i]));
+  }
+
   static Future<String> getPublicKey() async {
     return await _channel.invokeMethod('getPublicKey');
   }
@@ -5,6 +5,8 @@ import 'package:yosemite_wallet/models/action.dart';
 import 'package:yosemite_wallet/models/authorization.dart';
 import 'package:yosemite_wallet/models/signedTransaction.dart';
 import 'package:yosemite_wallet/models/transactionExtension.dart';
+import 'package:yosemite_wallet/pack/byteWriter.dart';
+import 'package:yosemite_wallet/pack/packer.dart';
 
 void main() {
   test('Byte writer test', () {
@@ -38,4 +40,61 @@ void main() {
     
     expect(dataInHexStr, expectedByteData);
   });
+
+  test('Packed size matches the packed bytes', () {
+    SignedTransaction signedTx = SignedTransaction();
+
+    signedTx.expiration = '2019-01-09T05:18:34';
+    signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+    signedTx.maxNetUsageWord = 300;
+    signedTx.addAction(Action(
+        account: 'systoken.a',
+        name: 'issue',
+        authorization: [Authorization('systoken.a', 'active')],
+        dataBytes: Uint8List(200)));
+    signedTx.contextFreeData.add('0102');
+
+    ByteWriter byteWriter = ByteWriter(endian: Endian.little, capacity: signedTx.packedSize());
+    signedTx.pack(byteWriter);
+
+    expect(byteWriter.length, signedTx.packedSize());
+    expect(byteWriter.capacity, signedTx.packedSize());
+    expect(signedTx.packTransactionBytes().length, signedTx.packedTransactionSize());
+    expect(signedTx.packContextFreeData().length, signedTx.contextFreeDataSize());
+  });
+
+  test('Packers without their own size are measured by packing', () {
+    _VariablePacker packer = _VariablePacker([1, 300, 70000]);
+    ByteWriter byteWriter = ByteWriter(endian: Endian.little);
+
+    packer.pack(byteWriter);
+
+    expect(packer.packedSize(), byteWriter.length);
+    expect(ByteWriter.packerListSize([packer, packer]), 1 + 2 * byteWriter.length);
+  });
+
+  test('Pooled writers are reused', () {
+    ByteWriterPool pool = ByteWriterPool();
+
+    ByteWriter first = pool.acquire(capacity: 100);
+    first.putUint32(1);
+    first.done();
+    expect(() => first.putUint8(0), throwsStateError);
+    pool.release(first);
+
+    ByteWriter second = pool.acquire(capacity: 50);
+    expect(identical(first, second), true);
+    expect(second.length, 0);
+  });
+}
+
+class _VariablePacker extends Packer {
+  final List<int> values;
+
+  _VariablePacker(this.values);
+
+  @override
+  void pack(ByteWriter byteWriter) {
+    values.forEach(byteWriter.putVariableUint);
+  }
 }
@@ -0,0 +1,85 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:yosemite_wallet/models/info.dart';
+import 'package:yosemite_wallet/services/chainInfoCache.dart';
+import 'package:yosemite_wallet/services/chainService.dart';
+
+void main() {
+  HttpServer server;
+  int requests;
+
+  setUp(() async {
+    requests = 0;
+    server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+    server.listen((HttpRequest request) async {
+      requests++;
+      // a slow node, so concurrent callers overlap
+      await Future.delayed(Duration(milliseconds: 20));
+      request.response
+        ..headers.contentType = ContentType.json
+        ..write(json.encode({
+          'chain_id': '047316f411b2db9ba0f600fdbca8e3bbd224d82a367ff02fbd355bb0675288e3',
+          'head_block_id': '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858',
+          'head_block_time': '2019-01-09T05:08:34'
+        }))
+        ..close();
+    });
+  });
+
+  tearDown(() async {
+    await server.close(force: true);
+  });
+
+  test('Concurrent callers share one get_info request', () async {
+    ChainService chainService = ChainService('http://127.0.0.1:${server.port}');
+
+    List<Info> infos =
+        await Future.wait(List.generate(10, (_) => chainService.getCachedChainInfo()));
+
+    expect(requests, 1);
+    expect(infos.every((info) => identical(info, infos[0])), true);
+
+    await chainService.getCachedChainInfo();
+    expect(requests, 1);
+
+    chainService.dispose();
+  });
+
+  test('Cached chain info expires and refreshes ahead of expiry', () async {
+    ChainService chainService = ChainService('http://127.0.0.1:${server.port}');
+    ChainInfoCache cache = ChainInfoCache(chainService.getChainInfo,
+        ttl: Duration(milliseconds: 300), refreshAfter: Duration(milliseconds: 100));
+
+    await cache.getChainInfo();
+    expect(requests, 1);
+
+    // stale but not expired: answered from the cache, refreshed behind it
+    await Future.delayed(Duration(milliseconds: 150));
+    expect(cache.cached, isNotNull);
+    await cache.getChainInfo();
+    await Future.delayed(Duration(milliseconds: 50));
+    expect(requests, 2);
+
+    await Future.delayed(Duration(milliseconds: 400));
+    expect(cache.cached, isNull);
+    await cache.getChainInfo();
+    expect(requests, 3);
+
+    chainService.dispose();
+  });
+
+  test('TAPOS is derived from the cached head block', () async {
+    ChainService chainService = ChainService('http://127.0.0.1:${server.port}');
+
+    var tapos = await chainService.getTapos(expiresIn: Duration(minutes: 10));
+
+    expect(tapos.refBlockNum, 0xeaf0);
+    expect(tapos.refBlockPrefix, 0x87ddafff);
+    expect(tapos.expiration, '2019-01-09T05:18:34.000Z');
+
+    chainService.dispose();
+  });
+}
@@ -0,0 +1,54 @@
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:convert/convert.dart';
+import 'package:crypto/crypto.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
+import 'package:yosemite_wallet/pack/zlibEncoderArchive.dart' as archive;
+import 'package:yosemite_wallet/pack/zlibEncoderIo.dart' as io;
+
+void main() {
+  test('Hex encoder', () {
+    Uint8List bytes = Uint8List.fromList(List.generate(512, (i) => (i * 7) & 0xff));
+
+    expect(encodeHex(bytes), hex.encode(bytes));
+    expect(encodeHex(Uint8List(0)), '');
+  });
+
+  test('zlib encoders with and without dart:io', () {
+    Uint8List bytes = Uint8List.fromList(List.generate(4096, (i) => (i ~/ 16) & 0xff));
+
+    expect(zlib.decode(io.zlibEncode(bytes)), bytes);
+    expect(zlib.decode(archive.zlibEncode(bytes)), bytes);
+    expect(archive.zlibEncode(bytes).length, lessThan(bytes.length));
+  });
+
+  test('Packed transaction with zlib compression', () {
+    SignedTransaction signedTx = SignedTransaction();
+
+    signedTx.expiration = '2019-01-09T05:18:34';
+    signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+    signedTx.addAction(Action(
+        account: 'systoken.a',
+        name: 'issue',
+        authorization: [Authorization('systoken.a', 'active')],
+        data: '00' * 1000));
+
+    PackedTransaction plain = PackedTransaction(signedTx);
+    PackedTransaction compressed =
+        PackedTransaction(signedTx, compression: PackedTransaction.CompressionZlib);
+
+    expect(plain.packed_trx, encodeHex(signedTx.packTransactionBytes()));
+    expect(compressed.compression, 'zlib');
+    expect(compressed.packed_trx.length, lessThan(plain.packed_trx.length));
+    expect(hex.encode(zlib.decode(hex.decode(compressed.packed_trx))), plain.packed_trx);
+    expect(compressed.packed_context_free_data, '');
+    expect(plain.id, compressed.id);
+    expect(plain.id, hex.encode(sha256.convert(signedTx.packTransactionBytes()).bytes));
+  });
+}
@@ -0,0 +1,124 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/services/pushClient.dart';
+
+PackedTransaction makeTransaction(int n) {
+  SignedTransaction signedTx = SignedTransaction();
+
+  signedTx.expiration = '2019-01-09T05:18:34';
+  signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+  signedTx.addAction(Action(
+      account: 'systoken.a',
+      name: 'issue',
+      authorization: [Authorization('systoken.a', 'active')],
+      data: n.toRadixString(16).padLeft(8, '0')));
+  signedTx.addSignature('SIG_K1_$n');
+
+  return PackedTransaction(signedTx);
+}
+
+void main() {
+  HttpServer server;
+  List<int> batchSizes;
+  int failuresLeft;
+
+  setUp(() async {
+    batchSizes = [];
+    failuresLeft = 0;
+    server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+    server.listen((HttpRequest request) async {
+      final List body = json.decode(await request.transform(utf8.decoder).join());
+
+      if (failuresLeft > 0) {
+        failuresLeft--;
+        request.response
+          ..statusCode = 503
+          ..close();
+        return;
+      }
+      batchSizes.add(body.length);
+      request.response
+        ..headers.contentType = ContentType.json
+        ..write(json.encode(body.map((trx) => {'transaction_id': trx['signatures'][0]}).toList()))
+        ..close();
+    });
+  });
+
+  tearDown(() async {
+    await server.close(force: true);
+  });
+
+  test('Transactions are pushed in batches and answered in order', () async {
+    PushClient client = PushClient('http://127.0.0.1:${server.port}', batchSize: 100);
+
+    final results = await client.pushAll(List.generate(250, makeTransaction));
+
+    expect(batchSizes.fold(0, (a, b) => a + b), 250);
+    expect(batchSizes.every((size) => size <= 100), true);
+    for (int i = 0; i < 250; i++) {
+      expect(results[i]['transaction_id'], 'SIG_K1_$i');
+    }
+    expect(client.stats.pushed, 250);
+
+    client.dispose();
+  });
+
+  test('Server errors are retried', () async {
+    PushClient client = PushClient('http://127.0.0.1:${server.port}',
+        retryDelay: Duration(milliseconds: 5), random: Random(1));
+
+    failuresLeft = 2;
+    final result = await client.push(makeTransaction(7));
+
+    expect(result['transaction_id'], 'SIG_K1_7');
+    expect(client.stats.retries, 2);
+
+    failuresLeft = 10;
+    await expectLater(client.push(makeTransaction(8)), throwsA(isInstanceOf<Exception>()));
+    expect(client.stats.failed, 1);
+
+    client.dispose();
+  });
+
+  test('Backoff stays below maxRetryDelay', () async {
+    _RecordingRandom random = _RecordingRandom();
+    PushClient client = PushClient('http://127.0.0.1:${server.port}',
+        maxRetries: 4,
+        retryDelay: Duration(seconds: 3),
+        maxRetryDelay: Duration(seconds: 10),
+        random: random);
+
+    failuresLeft = 4;
+    final result = await client.push(makeTransaction(9));
+
+    expect(result['transaction_id'], 'SIG_K1_9');
+    expect(random.bounds, [3000000, 6000000, 10000000, 10000000]);
+
+    client.dispose();
+  });
+}
+
+// no delay at all, but remembers the bounds it was asked for
+class _RecordingRandom implements Random {
+  final List<int> bounds = [];
+
+  @override
+  int nextInt(int max) {
+    bounds.add(max);
+    return 0;
+  }
+
+  @override
+  double nextDouble() => 0;
+
+  @override
+  bool nextBool() => false;
+}
@@ -0,0 +1,106 @@
+import 'dart:async';
+
+import 'package:crypto/crypto.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/services/transactionWorkerPool.dart';
+
+const chainId = '047316f411b2db9ba0f600fdbca8e3bbd224d82a367ff02fbd355bb0675288e3';
+
+SignedTransaction transfer(int i) {
+  SignedTransaction signedTx = SignedTransaction();
+
+  signedTx.expiration = '2019-01-09T05:18:34';
+  signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+  signedTx.addAction(Action(
+      account: 'systoken.a',
+      name: 'issue',
+      authorization: [Authorization('systoken.a', 'active')],
+      data: (i & 0xff).toRadixString(16).padLeft(2, '0') * 200));
+  if (i % 3 == 0) {
+    signedTx.contextFreeData.add('0102030405');
+  }
+  return signedTx;
+}
+
+/// Largest delay of a 1 ms periodic timer while work runs, a measure of
+/// how long the event loop of the calling isolate was blocked.
+Future<Duration> maxEventLoopLag(Future<void> work()) async {
+  final stopwatch = Stopwatch()..start();
+  var last = Duration.zero;
+  var maxLag = Duration.zero;
+  final timer = Timer.periodic(Duration(milliseconds: 1), (_) {
+    final now = stopwatch.elapsed;
+    if (now - last > maxLag) {
+      maxLag = now - last;
+    }
+    last = now;
+  });
+
+  await work();
+  timer.cancel();
+  return maxLag;
+}
+
+void main() {
+  TransactionWorkerPool pool;
+
+  setUp(() async {
+    pool = await TransactionWorkerPool.spawn(size: 2);
+  });
+
+  tearDown(() {
+    pool.close();
+  });
+
+  test('Prepared transactions match packing on the calling isolate', () async {
+    final transactions = List.generate(10, transfer);
+
+    final prepared = await pool.prepare(transactions, chainId);
+
+    expect(prepared.length, transactions.length);
+    for (int i = 0; i < transactions.length; i++) {
+      final packed = PackedTransaction(transactions[i]);
+      expect(prepared[i].digest,
+          sha256.convert(transactions[i].getDigestForSignature(chainId)).bytes);
+      expect(prepared[i].packedTrx, transactions[i].packTransactionBytes());
+      expect(prepared[i].id, packed.id);
+      expect(prepared[i].packedTrxHex, packed.packed_trx);
+      expect(prepared[i].packedContextFreeDataHex, packed.packed_context_free_data);
+      expect(prepared[i].toPackedTransaction(transactions[i]).toJson(), packed.toJson());
+    }
+  });
+
+  test('Zlib compression is applied on the workers', () async {
+    final transactions = List.generate(3, transfer);
+
+    final prepared = await pool.prepare(transactions, chainId,
+        compression: PackedTransaction.CompressionZlib);
+
+    for (int i = 0; i < transactions.length; i++) {
+      expect(prepared[i].packedTrxHex,
+          PackedTransaction(transactions[i], compression: PackedTransaction.CompressionZlib)
+              .packed_trx);
+    }
+  });
+
+  test('Packing on the pool blocks the event loop less than packing inline', () async {
+    final transactions = List.generate(2000, transfer);
+    final chainIdBytes = SignedTransaction.chainIdBytes(chainId);
+
+    final inline = await maxEventLoopLag(() async {
+      for (final transaction in transactions) {
+        TransactionWorkerPool.prepareTransaction(
+            transaction, chainIdBytes, PackedTransaction.CompressionNone);
+      }
+    });
+    final pooled = await maxEventLoopLag(() => pool.prepare(transactions, chainId));
+
+    expect(pooled, lessThan(inline),
+        reason: 'max event loop lag for ${transactions.length} transactions: '
+            'calling isolate ${inline.inMilliseconds} ms, worker pool ${pooled.inMilliseconds} ms');
+  });
+}
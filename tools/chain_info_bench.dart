@@ -0,0 +1,98 @@
+// Transactions built per second against a local stub node, with the
+// reference block and expiration of every transaction taken from its own
+// get_info request, as before ChainInfoCache, and from the cached chain
+// info, e.g.
+//
+//   dart tools/chain_info_bench.dart 2000 2
+//
+// builds 2000 transactions per run with a node answering get_info after
+// 2 ms.  Every run is repeated with 16 concurrent builders to show that
+// they share the requests of the cache.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/info.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/models/tapos.dart';
+import 'package:yosemite_wallet/services/chainService.dart';
+
+int requests = 0;
+
+Future<HttpServer> startStubNode(Duration latency) async {
+  HttpServer server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+
+  server.listen((HttpRequest request) async {
+    requests++;
+    await Future.delayed(latency);
+    request.response
+      ..headers.contentType = ContentType.json
+      ..write(json.encode({
+        'chain_id': '047316f411b2db9ba0f600fdbca8e3bbd224d82a367ff02fbd355bb0675288e3',
+        'head_block_id': '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858',
+        'head_block_time': '2019-01-09T05:08:34'
+      }))
+      ..close();
+  });
+  return server;
+}
+
+PackedTransaction buildTransaction(Tapos tapos, int n) {
+  SignedTransaction signedTx = SignedTransaction();
+
+  signedTx.tapos = tapos;
+  signedTx.addAction(Action(
+      account: 'systoken.a',
+      name: 'transfer',
+      authorization: [Authorization('yosemite', 'active')],
+      data: n.toRadixString(16).padLeft(16, '0') * 4));
+
+  return PackedTransaction(signedTx);
+}
+
+Future<void> run(String name, int count, int builders, Future<Tapos> tapos()) async {
+  Stopwatch watch = Stopwatch()..start();
+  int next = 0;
+
+  requests = 0;
+
+  Future<void> builder() async {
+    while (next < count) {
+      final n = next++;
+      buildTransaction(await tapos(), n);
+    }
+  }
+
+  await Future.wait(List.generate(builders, (_) => builder()));
+  watch.stop();
+
+  final rate = count * 1e6 / watch.elapsedMicroseconds;
+  print('${name.padRight(34)} ${builders.toString().padLeft(2)} builders '
+      '${rate.toStringAsFixed(0).padLeft(8)} trx/s  $requests get_info');
+}
+
+Future<void> main(List<String> args) async {
+  final count = args.length > 0 ? int.parse(args[0]) : 2000;
+  final latency = Duration(milliseconds: args.length > 1 ? int.parse(args[1]) : 2);
+  HttpServer node = await startStubNode(latency);
+  final baseUrl = 'http://127.0.0.1:${node.port}';
+
+  for (int builders in [1, 16]) {
+    ChainService uncached = ChainService(baseUrl);
+    await run('get_info per transaction', count, builders, () async {
+      Info info = await uncached.getChainInfo();
+      return Tapos.fromBlockId(info.headBlockId, info.addTimeAfterHeadBlockTimeByMin(10));
+    });
+    uncached.dispose();
+
+    ChainService cached = ChainService(baseUrl);
+    await run('cached chain info', count, builders, () => cached.getTapos());
+    cached.dispose();
+  }
+
+  await node.close(force: true);
+}
@@ -0,0 +1,18 @@
+# Regenerates a comb table with mktable and compares it with the checked-in copy.
+#
+#   cmake -DMKTABLE=<path to mktable> -DCURVE=secp256r1 -DWINDOW=4
+#         -DTABLE=ios/Classes/secp256r1.table -DOUTPUT=<scratch file>
+#         -P tools/check_table.cmake
+
+execute_process(COMMAND ${MKTABLE} ${CURVE} ${WINDOW}
+                OUTPUT_FILE ${OUTPUT}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "mktable ${CURVE} ${WINDOW} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${TABLE}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${TABLE} differs from the generated table ${OUTPUT}")
+endif()
@@ -0,0 +1,112 @@
+package com.yosemitex.yosemitewallet;
+
+import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * Signing, recovery and digests through YosEcNative against the same work done
+ * with BigIntegerEc and the JDK, per signature or digest.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+public class YosEcNativeBenchmark {
+
+    // the well known EOSIO development key
+    private static final String WIF = "5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3";
+    private static final int BATCH = 64;
+
+    @Param({"0", "1"})
+    int curve;
+
+    private BigIntegerEc ec;
+    private BigInteger d;
+    private byte[] digest, sig, trx;
+    private ByteBuffer key, digestBuffer, digests, sigBuffer, sigs, rs, pub, trxBuffer, chainId;
+
+    @Setup
+    public void setup() throws Exception {
+        ec = curve == YosEcNative.CURVE_K1 ? BigIntegerEc.K1 : BigIntegerEc.R1;
+        key = YosEcNative.allocate(YosEcNative.PRIVATE_KEY_SIZE);
+        YosEcNative.decodePrivateKey(WIF, key);
+        byte[] keyBytes = new byte[32];
+        key.duplicate().get(keyBytes);
+        d = new BigInteger(1, keyBytes);
+
+        digest = BigIntegerEc.sha256("yosemite".getBytes("UTF-8"));
+        digestBuffer = direct(digest);
+        digests = YosEcNative.allocate(YosEcNative.DIGEST_SIZE * BATCH);
+        for (int i = 0; i < BATCH; i++) {
+            digests.put(BigIntegerEc.sha256(new byte[]{(byte) i}));
+        }
+
+        sigBuffer = YosEcNative.allocate(YosEcNative.COMPACT_SIGNATURE_SIZE);
+        sigs = YosEcNative.allocate(YosEcNative.COMPACT_SIGNATURE_SIZE * BATCH);
+        sig = ec.sign(d, digest, curve == YosEcNative.CURVE_K1);
+        rs = YosEcNative.allocate(YosEcNative.SIGNATURE_SIZE);
+        rs.put(sig, 1, 64);
+        pub = YosEcNative.allocate(YosEcNative.PUBLIC_KEY_SIZE);
+
+        // a typical packed transfer is around 150 bytes
+        trx = new byte[150];
+        trxBuffer = direct(trx);
+        chainId = direct(digest);
+    }
+
+    private static ByteBuffer direct(byte[] bytes) {
+        ByteBuffer buffer = YosEcNative.allocate(bytes.length);
+        buffer.put(bytes);
+        return buffer;
+    }
+
+    @Benchmark
+    public ByteBuffer signNative() {
+        YosEcNative.signDigests(curve, key, digestBuffer, 1, sigBuffer, true);
+        return sigBuffer;
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(BATCH)
+    public ByteBuffer signBatchNative() {
+        YosEcNative.signDigests(curve, key, digests, BATCH, sigs, true);
+        return sigs;
+    }
+
+    @Benchmark
+    public byte[] signBigInteger() throws Exception {
+        return ec.sign(d, digest, curve == YosEcNative.CURVE_K1);
+    }
+
+    @Benchmark
+    public ByteBuffer recoverNative() {
+        YosEcNative.recoverPublicKey(curve, rs, digestBuffer, sig[0] - 31, pub);
+        return pub;
+    }
+
+    @Benchmark
+    public BigInteger[] recoverBigInteger() {
+        return ec.recover(sig, digest);
+    }
+
+    @Benchmark
+    public ByteBuffer transactionDigestNative() {
+        YosEcNative.transactionDigest(chainId, trxBuffer, trx.length, null, 0, digestBuffer);
+        return digestBuffer;
+    }
+
+    @Benchmark
+    public byte[] transactionDigestJdk() throws Exception {
+        return BigIntegerEc.sha256(digest, trx, new byte[32]);
+    }
+}
@@ -0,0 +1,121 @@
+//
+//  mktable.c
+//  YosWalletTest
+//
+//  Generates the precomputed comb tables (curve->cp) included by the curve
+//  definitions, e.g.
+//
+//    mktable secp256r1 4 > ios/Classes/secp256r1.table
+//
+//  Row i of a table with window w holds the odd multiples
+//  (2j+1) * 2^(w*i) * G for j = 0 .. 2^(w-1)-1, and there are
+//  ceil(256/w) rows.  The checked-in tables use w = 4 (64 rows of 8 points),
+//  which is the layout ecdsa_curve.cp and scalar_multiply expect.
+//
+//  With -o the table is written in the binary format of ectable.h instead,
+//  to be mapped at runtime with ectable_map, e.g.
+//
+//    mktable -o secp256k1-w8.ectable secp256k1 8
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ecdsa.h"
+#include "ectable.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+
+static const struct {
+  const char *name;
+  const ecdsa_curve *curve;
+} curves[] = {
+  { "secp256r1", &secp256r1 },
+  { "secp256k1", &secp256k1 },
+};
+
+static const ecdsa_curve *find_curve(const char *name)
+{
+  size_t i;
+  for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    if (strcmp(curves[i].name, name) == 0) {
+      return curves[i].curve;
+    }
+  }
+  return NULL;
+}
+
+static void print_bignum(const bignum256 *a)
+{
+  int i;
+  printf("{");
+  for (i = 0; i < 8; i++) {
+    printf("0x%08x, ", a->val[i]);
+  }
+  printf("0x%04x}", a->val[8]);
+}
+
+static void usage(const char *prog)
+{
+  size_t i;
+  fprintf(stderr, "usage: %s [-o table file] <curve> [window]\n", prog);
+  fprintf(stderr, "curves:");
+  for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    fprintf(stderr, " %s", curves[i].name);
+  }
+  fprintf(stderr, "\nwindow: 2 .. 8, default 4\n");
+}
+
+int main(int argc, char **argv)
+{
+  const ecdsa_curve *curve;
+  const char *prog = argv[0], *output = NULL;
+  curve_point *cp;
+  int window = 4, rows, cols, i, j;
+  
+  if (argc >= 3 && strcmp(argv[1], "-o") == 0) {
+    output = argv[2];
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc < 2 || argc > 3 || !(curve = find_curve(argv[1]))) {
+    usage(prog);
+    return 1;
+  }
+  if (argc == 3) {
+    window = atoi(argv[2]);
+    if (window < 2 || window > 8) {
+      usage(prog);
+      return 1;
+    }
+  }
+  if (output != NULL) {
+    if (ectable_write(output, curve, &curve->G, window) != 0) {
+      fprintf(stderr, "%s: cannot write %s\n", prog, output);
+      return 1;
+    }
+    return 0;
+  }
+  
+  rows = (256 + window - 1) / window;
+  cols = 1 << (window - 1);
+  cp = malloc(ectable_size(window));
+  if (cp == NULL) {
+    return 1;
+  }
+  ectable_build(curve, &curve->G, window, cp);
+  for (i = 0; i < rows; i++) {
+    printf("{\n");
+    for (j = 0; j < cols; j++) {
+      // (2j+1) * 2^(window*i) * G
+      printf("/* %2d*%d^%d*G: */\n{{", 2 * j + 1, 1 << window, i);
+      print_bignum(&cp[i * cols + j].x);
+      printf("},\n{");
+      print_bignum(&cp[i * cols + j].y);
+      printf("}}%s\n", j + 1 < cols ? "," : "");
+    }
+    printf("},\n");
+  }
+  free(cp);
+  return 0;
+}
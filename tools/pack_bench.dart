@@ -0,0 +1,107 @@
+// Time and writer buffer bytes allocated per packed transaction, the way
+// transactions were packed before action data and chain ids were kept as
+// bytes and writers were sized and pooled, and the way they are packed
+// now, e.g.
+//
+//   dart tools/pack_bench.dart 1024
+//
+// packs transactions with 1024 bytes of action data (default 256).  The
+// old way decodes the action data and the chain id from hex for every
+// transaction and packs into a fresh 8 byte writer that doubles as it
+// fills.  Buffer bytes are what the writers allocate, counted from their
+// capacity, not all allocations of the VM.
+
+import 'dart:typed_data';
+
+import 'package:convert/convert.dart';
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/pack/byteWriter.dart';
+
+const chainId = '047316f411b2db9ba0f600fdbca8e3bbd224d82a367ff02fbd355bb0675288e3';
+
+// fastest of 5 rounds of at least 100 ms, in microseconds per call
+double bestMicros(void fn()) {
+  double best;
+
+  for (int round = 0; round < 5; round++) {
+    Stopwatch watch = Stopwatch()..start();
+    int calls = 0;
+    do {
+      fn();
+      calls++;
+    } while (watch.elapsedMilliseconds < 100);
+    final micros = watch.elapsedMicroseconds / calls;
+    if (best == null || micros < best) {
+      best = micros;
+    }
+  }
+  return best;
+}
+
+// bytes a writer of initial capacity allocates while doubling to capacity
+int grownBytes(int initial, int capacity) {
+  int total = 0;
+
+  for (int c = initial; c <= capacity; c *= 2) {
+    total += c;
+  }
+  return total;
+}
+
+SignedTransaction makeTransaction(Action action) {
+  SignedTransaction signedTx = SignedTransaction();
+
+  signedTx.expiration = '2019-01-09T05:18:34';
+  signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+  signedTx.addAction(action);
+  return signedTx;
+}
+
+void report(String what, double micros, int bufferBytes) {
+  print('${what.padRight(40)} ${micros.toStringAsFixed(2).padLeft(9)} us  ${bufferBytes.toString().padLeft(7)} buffer bytes');
+}
+
+void main(List<String> args) {
+  final size = args.length > 0 ? int.parse(args[0]) : 256;
+  final data = Uint8List.fromList(List.generate(size, (i) => (i * 131) & 0xff));
+  final dataHex = hex.encode(data);
+  final authorization = [Authorization('yosemite', 'active')];
+  ByteWriter unsized;
+
+  // every run builds its transaction, as a wallet does for each transfer
+  SignedTransaction hexTransaction() => makeTransaction(
+      Action(account: 'systoken.a', name: 'transfer', authorization: authorization, data: dataHex));
+  SignedTransaction bytesTransaction() => makeTransaction(
+      Action(account: 'systoken.a', name: 'transfer', authorization: authorization, dataBytes: data));
+
+  // digest for signing: chain id and transaction
+  final unsizedDigest = () {
+    unsized = ByteWriter(endian: Endian.little, capacity: 8);
+    unsized.putUint8List(Uint8List.fromList(hex.decode(chainId)));
+    hexTransaction().pack(unsized);
+    unsized.doneAsBytes();
+  };
+  unsizedDigest();
+  report('digest, hex data, unsized writer', bestMicros(unsizedDigest), grownBytes(8, unsized.capacity));
+  report('digest, byte data, sized writer', bestMicros(() => bytesTransaction().getDigestForSignature(chainId)),
+      32 + bytesTransaction().packedSize());
+
+  // packed_trx: the transaction alone
+  final unsizedPack = () {
+    unsized = ByteWriter(endian: Endian.little, capacity: 8);
+    hexTransaction().packOnlyTransaction(unsized);
+    unsized.doneAsBytes();
+  };
+  unsizedPack();
+  report('packed_trx, hex data, unsized writer', bestMicros(unsizedPack), grownBytes(8, unsized.capacity));
+  report('packed_trx, byte data, pooled writer', bestMicros(() {
+    final signedTx = bytesTransaction();
+    final byteWriter =
+        ByteWriterPool.shared.acquire(endian: Endian.little, capacity: signedTx.packedTransactionSize());
+    signedTx.packOnlyTransaction(byteWriter);
+    byteWriter.doneAsBytes();
+    ByteWriterPool.shared.release(byteWriter);
+  }), 0);
+}
@@ -0,0 +1,84 @@
+// Encode time and wire size of packed transactions against the size of
+// their action data, e.g.
+//
+//   dart tools/packed_trx_bench.dart
+//
+// For each payload size it times the hex encoding of the packed bytes with
+// the string fold PackedTransaction used before encodeHex (only up to
+// 16 KB, it is quadratic), with encodeHex and with package:convert, and
+// then whole PackedTransactions without and with zlib, printing the
+// length of packed_trx each produces.
+
+import 'dart:typed_data';
+
+import 'package:convert/convert.dart';
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/pack/hexEncoder.dart';
+
+const payloadSizes = [64, 1024, 16384, 131072];
+const foldLimit = 16384;
+
+// fastest of 5 rounds of at least 100 ms, in microseconds per call
+double bestMicros(void fn()) {
+  double best;
+
+  for (int round = 0; round < 5; round++) {
+    Stopwatch watch = Stopwatch()..start();
+    int calls = 0;
+    do {
+      fn();
+      calls++;
+    } while (watch.elapsedMilliseconds < 100);
+    final micros = watch.elapsedMicroseconds / calls;
+    if (best == null || micros < best) {
+      best = micros;
+    }
+  }
+  return best;
+}
+
+String foldHex(List<int> bytes) {
+  return bytes.fold('', (prev, elem) => '$prev${elem.toRadixString(16).padLeft(2, '0')}');
+}
+
+// action data shaped like token transfers with memos, so it compresses
+// about as well as real payloads
+Uint8List payload(int size) {
+  final text = 'transfer 1.0000 DUSD from yosemite to user.';
+  return Uint8List.fromList(List.generate(size, (i) => i % 64 < 48 ? text.codeUnitAt(i % text.length) : (i * 131) & 0xff));
+}
+
+void report(int size, String what, double micros, [int wireSize]) {
+  final wire = wireSize != null ? '${wireSize.toString().padLeft(9)} hex chars' : '';
+  print('${size.toString().padLeft(7)} B  ${what.padRight(22)} ${micros.toStringAsFixed(1).padLeft(10)} us  $wire');
+}
+
+void main() {
+  for (int size in payloadSizes) {
+    SignedTransaction signedTx = SignedTransaction();
+
+    signedTx.expiration = '2019-01-09T05:18:34';
+    signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+    signedTx.addAction(Action(
+        account: 'systoken.a',
+        name: 'transfer',
+        authorization: [Authorization('yosemite', 'active')],
+        dataBytes: payload(size)));
+    final bytes = signedTx.packTransactionBytes();
+
+    if (size <= foldLimit) {
+      report(size, 'hex, string fold', bestMicros(() => foldHex(bytes)));
+    }
+    report(size, 'hex, encodeHex', bestMicros(() => encodeHex(bytes)));
+    report(size, 'hex, package:convert', bestMicros(() => hex.encode(bytes)));
+
+    for (final compression in [PackedTransaction.CompressionNone, PackedTransaction.CompressionZlib]) {
+      final wireSize = PackedTransaction(signedTx, compression: compression).packed_trx.length;
+      report(size, 'packed, $compression',
+          bestMicros(() => PackedTransaction(signedTx, compression: compression)), wireSize);
+    }
+  }
+}
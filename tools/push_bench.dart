@@ -0,0 +1,100 @@
+// Throughput and tail latency of pushing a burst of signed transactions to
+// a local stub node, with one push_transaction request per transaction, as
+// ChainService's http.Client could before PushClient, and with PushClient
+// at several batch sizes and connection counts, e.g.
+//
+//   dart tools/push_bench.dart 5000 1
+//
+// pushes 5000 transactions per run to a node that takes 1 ms per request.
+// Latency is counted from queuing a transaction to its result.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:http/http.dart' as http;
+import 'package:yosemite_wallet/models/action.dart';
+import 'package:yosemite_wallet/models/authorization.dart';
+import 'package:yosemite_wallet/models/packedTransaction.dart';
+import 'package:yosemite_wallet/models/signedTransaction.dart';
+import 'package:yosemite_wallet/services/pushClient.dart';
+
+int requests = 0;
+
+Future<HttpServer> startStubNode(Duration latency) async {
+  HttpServer server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+
+  server.listen((HttpRequest request) async {
+    final body = json.decode(await request.transform(utf8.decoder).join());
+    requests++;
+    await Future.delayed(latency);
+
+    final result = body is List
+        ? body.map((trx) => {'transaction_id': trx['signatures'][0]}).toList()
+        : {'transaction_id': body['signatures'][0]};
+    request.response
+      ..headers.contentType = ContentType.json
+      ..write(json.encode(result))
+      ..close();
+  });
+  return server;
+}
+
+PackedTransaction makeTransaction(int n) {
+  SignedTransaction signedTx = SignedTransaction();
+
+  signedTx.expiration = '2019-01-09T05:18:34';
+  signedTx.referenceBlock = '001feaf0f02495bcffafdd87bc4d03021e592d78bd94e111854832da377f1858';
+  signedTx.addAction(Action(
+      account: 'systoken.a',
+      name: 'transfer',
+      authorization: [Authorization('yosemite', 'active')],
+      data: n.toRadixString(16).padLeft(16, '0') * 4));
+  signedTx.addSignature('SIG_K1_$n');
+
+  return PackedTransaction(signedTx);
+}
+
+Future<void> run(String name, List<PackedTransaction> transactions,
+    Future<Map<String, dynamic>> push(PackedTransaction transaction)) async {
+  final latencies = <int>[];
+  Stopwatch watch = Stopwatch()..start();
+
+  requests = 0;
+  await Future.wait(transactions.map((transaction) {
+    final queued = watch.elapsedMicroseconds;
+    return push(transaction).then((_) => latencies.add(watch.elapsedMicroseconds - queued));
+  }));
+  watch.stop();
+
+  latencies.sort();
+  String ms(double q) => (latencies[((latencies.length - 1) * q).round()] / 1000).toStringAsFixed(1).padLeft(7);
+  final rate = transactions.length * 1e6 / watch.elapsedMicroseconds;
+
+  print('${name.padRight(34)} ${rate.toStringAsFixed(0).padLeft(7)} trx/s  '
+      'p50 ${ms(0.5)} ms  p99 ${ms(0.99)} ms  max ${ms(1.0)} ms  ${requests.toString().padLeft(5)} requests');
+}
+
+Future<void> main(List<String> args) async {
+  final count = args.length > 0 ? int.parse(args[0]) : 5000;
+  final latency = Duration(milliseconds: args.length > 1 ? int.parse(args[1]) : 1);
+  HttpServer node = await startStubNode(latency);
+  final baseUrl = 'http://127.0.0.1:${node.port}';
+  final transactions = List.generate(count, makeTransaction);
+
+  http.Client httpClient = http.Client();
+  await run('push_transaction per transaction', transactions, (transaction) async {
+    final response = await httpClient.post(baseUrl + '/v1/chain/push_transaction',
+        headers: {'Content-Type': 'application/json'}, body: json.encode(transaction));
+    return json.decode(response.body);
+  });
+  httpClient.close();
+
+  for (final config in [[1, 8], [100, 1], [100, 8], [500, 8]]) {
+    PushClient client = PushClient(baseUrl, batchSize: config[0], maxConnections: config[1]);
+    await run('PushClient batch ${config[0]}, ${config[1]} connections', transactions, client.push);
+    client.dispose();
+  }
+
+  await node.close(force: true);
+}
@@ -0,0 +1,106 @@
+//
+//  authority_test.c
+//  YosWalletTest
+//
+//  Checks of authority_check that depend on the order in which
+//  permissions are reached within one check.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "authority.h"
+
+#define ACTIVE 0x3232eda800000000ULL  // "active"
+
+static int failures = 0;
+
+static void expect(const char *name, const uint8_t *satisfied, const uint8_t *expected, size_t count)
+{
+  if (memcmp(satisfied, expected, count) != 0) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static authority_level level(uint64_t actor)
+{
+  authority_level level = { actor, ACTIVE };
+  return level;
+}
+
+static authority_key_weight key_weight(uint8_t seed)
+{
+  authority_key_weight kw;
+  memset(&kw, 0, sizeof(kw));
+  kw.key.type = AUTHORITY_KEY_R1;
+  kw.key.data[0] = 0x02;
+  memset(kw.key.data + 1, seed, 32);
+  kw.weight = 1;
+  return kw;
+}
+
+// L1 -> L2 -> ... -> L8 where only L8 holds the key.  L8 is beyond the
+// depth limit from L1 but not from L7.
+static void test_depth(void)
+{
+  authority_index *index = authority_index_new();
+  authority_key_weight kw = key_weight(1);
+  authority_level_weight next;
+  authority_level levels[2];
+  uint8_t satisfied[2];
+  const uint8_t expected_l7[1] = { 1 }, expected_both[2] = { 0, 1 };
+  uint64_t i;
+
+  for (i = 1; i <= 8; i++) {
+    authority_level l = level(i);
+    next.level = level(i + 1);
+    next.weight = 1;
+    if (i < 8) {
+      authority_set_permission(index, &l, 0, 1, NULL, 0, &next, 1);
+    } else {
+      authority_set_permission(index, &l, 0, 1, &kw, 1, NULL, 0);
+    }
+  }
+
+  levels[0] = level(7);
+  authority_check(index, &kw.key, 1, levels, 1, satisfied);
+  expect("depth: L7", satisfied, expected_l7, 1);
+
+  levels[0] = level(1);
+  levels[1] = level(7);
+  authority_check(index, &kw.key, 1, levels, 2, satisfied);
+  expect("depth: L1 then L7", satisfied, expected_both, 2);
+
+  authority_index_free(index);
+}
+
+// X needs Y or W, Y needs X and W holds the key.  Y is reached first while
+// X is still being evaluated.
+static void test_cycle(void)
+{
+  authority_index *index = authority_index_new();
+  authority_key_weight kw = key_weight(2);
+  authority_level_weight x_accounts[2] = { { { 2, ACTIVE }, 1 }, { { 3, ACTIVE }, 1 } };
+  authority_level_weight y_accounts[1] = { { { 1, ACTIVE }, 1 } };
+  authority_level x = level(1), y = level(2), w = level(3), levels[2];
+  uint8_t satisfied[2];
+  const uint8_t expected[2] = { 1, 1 };
+
+  authority_set_permission(index, &x, 0, 1, NULL, 0, x_accounts, 2);
+  authority_set_permission(index, &y, 0, 1, NULL, 0, y_accounts, 1);
+  authority_set_permission(index, &w, 0, 1, &kw, 1, NULL, 0);
+
+  levels[0] = x;
+  levels[1] = y;
+  authority_check(index, &kw.key, 1, levels, 2, satisfied);
+  expect("cycle: X then Y", satisfied, expected, 2);
+
+  authority_index_free(index);
+}
+
+int main(void)
+{
+  test_depth();
+  test_cycle();
+  return failures != 0;
+}
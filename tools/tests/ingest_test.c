@@ -0,0 +1,312 @@
+//
+//  ingest_test.c
+//  YosWalletTest
+//
+//  Pushes signed transactions through every stage of the ingest pipeline
+//  and checks each result, that every transaction is done exactly once and,
+//  with one thread per stage, that they are done in submission order.
+//  With an id index, checks that a forged copy submitted first does not
+//  keep the valid transaction out and that resubmissions are dropped.
+//
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ecdsa.h"
+#include "ingest.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "trx_digest.h"
+
+#define COUNT       240
+#define MAX_ACTIONS 2
+#define TRX_SIZE    (32 + MAX_ACTIONS * 48)
+
+typedef struct {
+  ingest_trx trx;
+  uint8_t packed[TRX_SIZE];
+  uint8_t signatures[MAX_ACTIONS * INGEST_SIGNATURE_SIZE];
+  authority_key keys[MAX_ACTIONS];
+  authority_key expected_keys[MAX_ACTIONS];
+  size_t action_count;
+  int expected;
+  atomic_int done;
+} test_trx;
+
+static int failures = 0;
+static uint8_t chain_id[32];
+static uint8_t priv_keys[2][32];
+static authority_key pub_keys[2];
+static test_trx trxs[COUNT];
+static atomic_int done_order;
+static int done_position[COUNT];
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static uint8_t *put_uint64(uint8_t *p, uint64_t value)
+{
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    *p++ = (uint8_t)(value >> (8 * i));
+  }
+  return p;
+}
+
+// one action of account 100 + key type, authorized by its active
+// permission, for every key type in types
+static size_t pack_trx(uint8_t *buf, uint32_t expiration, const uint8_t *types, size_t action_count, uint32_t nonce)
+{
+  uint8_t *p = buf;
+  size_t i;
+
+  memcpy(p, &expiration, 4);                  // little endian hosts only
+  memset(p + 4, 0, 6);                        // ref_block_num, ref_block_prefix
+  p += 10;
+  *p++ = 0;                                   // max_net_usage_words
+  *p++ = 0;                                   // max_cpu_usage_ms
+  *p++ = 0;                                   // delay_sec
+  *p++ = 0;                                   // context free actions
+  *p++ = (uint8_t)action_count;
+  for (i = 0; i < action_count; i++) {
+    p = put_uint64(p, 0x5530ea033482a600ull);  // account
+    p = put_uint64(p, 0xcdcd3c2d57000000ull);  // name
+    *p++ = 1;
+    p = put_uint64(p, 100 + types[i]);         // actor
+    p = put_uint64(p, 5);                      // permission
+    *p++ = 4;
+    memcpy(p, &nonce, 4);
+    p += 4;
+  }
+  *p++ = 0;                                   // transaction extensions
+  return p - buf;
+}
+
+static void sign(test_trx *t, size_t index, uint8_t type, int compressed_header)
+{
+  const ecdsa_curve *curve = type == AUTHORITY_KEY_K1 ? &secp256k1 : &secp256r1;
+  uint8_t *sig = t->signatures + index * INGEST_SIGNATURE_SIZE;
+  uint8_t digest[32], by;
+
+  trx_digest(chain_id, t->trx.packed_trx, t->trx.packed_trx_len, NULL, 0, digest);
+  ecdsa_sign_digest(curve, priv_keys[type], digest, sig + 2, &by, NULL);
+  sig[0] = type;
+  sig[1] = (compressed_header ? 31 : 27) + by;
+  t->expected_keys[index] = pub_keys[type];
+}
+
+// Builds the transactions of the test, a mix of valid ones signed with
+// one or both curves and ones every stage has to reject.
+static void build(uint32_t expiration)
+{
+  test_trx *t;
+  uint8_t types[MAX_ACTIONS];
+  size_t i, j;
+
+  for (i = 0; i < COUNT; i++) {
+    t = &trxs[i];
+    memset(t, 0, sizeof(test_trx));
+    t->action_count = i % 3 == 2 ? 2 : 1;
+    types[0] = i % 3 == 1 ? AUTHORITY_KEY_K1 : AUTHORITY_KEY_R1;
+    types[1] = AUTHORITY_KEY_K1;
+    t->trx.packed_trx = t->packed;
+    t->trx.packed_trx_len = pack_trx(t->packed, expiration, types, t->action_count, (uint32_t)i);
+    t->trx.signatures = t->signatures;
+    t->trx.sig_count = t->action_count;
+    t->trx.keys = t->keys;
+    t->trx.user = t;
+    t->expected = INGEST_OK;
+    for (j = 0; j < t->action_count; j++) {
+      sign(t, j, types[j], i % 2);
+    }
+
+    if (i % 17 == 3) {
+      // trailing byte after the extensions
+      t->packed[t->trx.packed_trx_len++] = 0;
+      t->expected = INGEST_ERR_PARSE;
+    } else if (i % 17 == 7) {
+      t->signatures[0] = 9;
+      t->expected = INGEST_ERR_SIGNATURE;
+    } else if (i % 17 == 11) {
+      t->signatures[1] = 35;
+      t->expected = INGEST_ERR_SIGNATURE;
+    } else if (i % 17 == 13) {
+      // still recovers, to some other key
+      t->signatures[INGEST_SIGNATURE_SIZE - 1] ^= 1;
+      t->expected = INGEST_ERR_UNAUTHORIZED;
+    } else if (i % 17 == 15 && t->action_count == 2) {
+      t->trx.sig_count = 1;
+      t->expected = INGEST_ERR_UNAUTHORIZED;
+    }
+  }
+}
+
+static void done(ingest_trx *trx, void *ctx)
+{
+  test_trx *t = trx->user;
+  size_t i = t - trxs, j;
+  uint8_t digest[32], id[32];
+
+  done_position[i] = atomic_fetch_add(&done_order, 1);
+  check("done once", atomic_fetch_add(&t->done, 1) == 0);
+  check("status", trx->status == t->expected);
+  if (t->expected == INGEST_ERR_PARSE) {
+    return;
+  }
+
+  trx_digest_id(chain_id, trx->packed_trx, trx->packed_trx_len, NULL, 0, digest, id);
+  check("digest", memcmp(trx->digest, digest, 32) == 0);
+  check("id", memcmp(trx->id, id, 32) == 0);
+  check("levels", trx->level_count == t->action_count && trx->levels[0].permission == 5);
+  if (t->expected == INGEST_OK) {
+    for (j = 0; j < trx->sig_count; j++) {
+      check("recovered key", memcmp(&trx->keys[j], &t->expected_keys[j], sizeof(authority_key)) == 0);
+    }
+  }
+}
+
+static void run(const char *name, const authority_index *authority, trx_index *ids, unsigned int threads,
+                unsigned int batch, unsigned int capacity)
+{
+  ingest_config config;
+  ingest_engine *engine;
+  ingest_stage_stats stats[INGEST_STAGES];
+  size_t i;
+  int in_order = 1;
+
+  memset(&config, 0, sizeof(config));
+  memcpy(config.chain_id, chain_id, 32);
+  config.authority = authority;
+  config.ids = ids;
+  for (i = 0; i < INGEST_STAGES; i++) {
+    config.threads[i] = threads;
+    config.batch[i] = batch;
+  }
+  config.queue_capacity = capacity;
+  config.done = done;
+
+  for (i = 0; i < COUNT; i++) {
+    atomic_init(&trxs[i].done, 0);
+  }
+  atomic_init(&done_order, 0);
+
+  engine = ingest_start(&config);
+  check(name, engine != NULL);
+  if (engine == NULL) {
+    return;
+  }
+  for (i = 0; i < COUNT; i++) {
+    ingest_submit(engine, &trxs[i].trx);
+  }
+  ingest_wait(engine);
+  ingest_stats(engine, stats);
+  ingest_stop(engine);
+
+  for (i = 0; i < COUNT; i++) {
+    check(name, atomic_load(&trxs[i].done) == 1);
+    in_order &= done_position[i] == (int)i;
+  }
+  // one thread per stage and FIFO queues keep the submission order
+  if (threads == 1) {
+    check(name, in_order);
+  }
+  for (i = 0; i < INGEST_STAGES; i++) {
+    check(name, stats[i].items == COUNT);
+  }
+}
+
+// Submits every valid transaction with a tampered signature, then
+// unchanged, then again.  Only the unchanged ones register their ids.
+static void test_duplicates(const authority_index *authority, unsigned int threads)
+{
+  static int valid[COUNT];
+  trx_index *ids = trx_index_new(4 * COUNT, 4);
+  trx_index_stats stats;
+  size_t i, valid_count = 0;
+
+  for (i = 0; i < COUNT; i++) {
+    valid[i] = trxs[i].expected == INGEST_OK;
+    if (valid[i]) {
+      trxs[i].signatures[INGEST_SIGNATURE_SIZE - 1] ^= 1;
+      trxs[i].expected = INGEST_ERR_UNAUTHORIZED;
+      valid_count++;
+    }
+  }
+  run("forged copies", authority, ids, threads, 8, 4);
+
+  for (i = 0; i < COUNT; i++) {
+    if (valid[i]) {
+      trxs[i].signatures[INGEST_SIGNATURE_SIZE - 1] ^= 1;
+      trxs[i].expected = INGEST_OK;
+    }
+  }
+  run("after forged copies", authority, ids, threads, 8, 4);
+
+  for (i = 0; i < COUNT; i++) {
+    if (valid[i]) {
+      trxs[i].expected = INGEST_ERR_DUPLICATE;
+    }
+  }
+  run("resubmitted", authority, ids, threads, 8, 4);
+
+  trx_index_stats_get(ids, &stats);
+  check("registered", stats.inserts == valid_count);
+  check("dropped", stats.hits == valid_count);
+
+  for (i = 0; i < COUNT; i++) {
+    if (valid[i]) {
+      trxs[i].expected = INGEST_OK;
+    }
+  }
+  trx_index_free(ids);
+}
+
+int main(void)
+{
+  authority_index *authority = authority_index_new();
+  authority_key_weight key_weight;
+  authority_level level;
+  curve_point pub;
+  bignum256 d;
+  uint8_t uncompressed[65];
+  int i;
+
+  for (i = 0; i < 32; i++) {
+    chain_id[i] = (uint8_t)i;
+    priv_keys[AUTHORITY_KEY_R1][i] = (uint8_t)(7 * i + 3);
+    priv_keys[AUTHORITY_KEY_K1][i] = (uint8_t)(7 * i + 4);
+  }
+  for (i = 0; i < 2; i++) {
+    bn_read_be(priv_keys[i], &d);
+    scalar_multiply(i == AUTHORITY_KEY_K1 ? &secp256k1 : &secp256r1, &d, &pub);
+    uncompressed[0] = 0x04;
+    bn_write_be(&pub.x, uncompressed + 1);
+    bn_write_be(&pub.y, uncompressed + 33);
+    pub_keys[i].type = (uint8_t)i;
+    ecdsa_compress_pubkey(uncompressed, pub_keys[i].data);
+
+    key_weight.key = pub_keys[i];
+    key_weight.weight = 1;
+    level.actor = 100 + i;
+    level.permission = 5;
+    authority_set_permission(authority, &level, 0, 1, &key_weight, 1, NULL, 0);
+  }
+
+  build((uint32_t)time(NULL) + 3600);
+  run("one thread, batch 1", authority, NULL, 1, 1, 2);
+  run("one thread, batch 16", authority, NULL, 1, 16, 4);
+  run("three threads, full queues", authority, NULL, 3, 8, 4);
+  run("three threads, default queues", authority, NULL, 3, 0, 0);
+  test_duplicates(authority, 1);
+  test_duplicates(authority, 3);
+
+  authority_index_free(authority);
+  return failures != 0;
+}
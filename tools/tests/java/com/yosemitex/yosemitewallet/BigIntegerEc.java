@@ -0,0 +1,180 @@
+package com.yosemitex.yosemitewallet;
+
+import java.math.BigInteger;
+import java.security.GeneralSecurityException;
+import java.security.MessageDigest;
+
+import javax.crypto.Mac;
+import javax.crypto.spec.SecretKeySpec;
+
+/**
+ * Plain BigInteger secp256r1/secp256k1 in affine coordinates, the reference
+ * YosEcNativeTest checks the native core against and the baseline of
+ * YosEcNativeBenchmark.  Follows the textbook formulas and RFC 6979 without any
+ * of the native optimizations, and is neither fast nor constant time.
+ */
+final class BigIntegerEc {
+
+    static final BigIntegerEc R1 = new BigIntegerEc(
+            "ffffffff00000001000000000000000000000000ffffffffffffffffffffffff",
+            "ffffffff00000001000000000000000000000000fffffffffffffffffffffffc",
+            "5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b",
+            "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551",
+            "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+            "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5");
+
+    static final BigIntegerEc K1 = new BigIntegerEc(
+            "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f",
+            "0",
+            "7",
+            "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141",
+            "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798",
+            "483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8");
+
+    private static final BigInteger TWO = BigInteger.valueOf(2);
+    private static final BigInteger THREE = BigInteger.valueOf(3);
+
+    final BigInteger p, a, b, n;
+    final BigInteger[] g;
+
+    private BigIntegerEc(String p, String a, String b, String n, String gx, String gy) {
+        this.p = new BigInteger(p, 16);
+        this.a = new BigInteger(a, 16);
+        this.b = new BigInteger(b, 16);
+        this.n = new BigInteger(n, 16);
+        this.g = new BigInteger[]{new BigInteger(gx, 16), new BigInteger(gy, 16)};
+    }
+
+    // points are {x, y}, null is the point at infinity
+
+    BigInteger[] add(BigInteger[] P, BigInteger[] Q) {
+        if (P == null) {
+            return Q;
+        }
+        if (Q == null) {
+            return P;
+        }
+        BigInteger l;
+        if (P[0].equals(Q[0])) {
+            if (P[1].add(Q[1]).mod(p).signum() == 0) {
+                return null;
+            }
+            l = P[0].pow(2).multiply(THREE).add(a).multiply(P[1].multiply(TWO).modInverse(p)).mod(p);
+        } else {
+            l = Q[1].subtract(P[1]).multiply(Q[0].subtract(P[0]).modInverse(p)).mod(p);
+        }
+        BigInteger x = l.pow(2).subtract(P[0]).subtract(Q[0]).mod(p);
+        return new BigInteger[]{x, l.multiply(P[0].subtract(x)).subtract(P[1]).mod(p)};
+    }
+
+    BigInteger[] multiply(BigInteger k, BigInteger[] P) {
+        BigInteger[] R = null;
+        for (int i = k.bitLength() - 1; i >= 0; i--) {
+            R = add(R, R);
+            if (k.testBit(i)) {
+                R = add(R, P);
+            }
+        }
+        return R;
+    }
+
+    /**
+     * 33 byte compressed encoding of P.
+     */
+    static byte[] compress(BigInteger[] P) {
+        byte[] out = new byte[33];
+        out[0] = (byte) (P[1].testBit(0) ? 3 : 2);
+        System.arraycopy(bytes32(P[0]), 0, out, 1, 32);
+        return out;
+    }
+
+    /**
+     * Signs digest with d like ecdsa_sign_digest: RFC 6979 nonces, low-S and, if
+     * canonical, the EOSIO canonical form.  Returns the 65 byte compact signature
+     * with header 31 + recovery id.
+     */
+    byte[] sign(BigInteger d, byte[] digest, boolean canonical) throws GeneralSecurityException {
+        BigInteger e = new BigInteger(1, digest).mod(n);
+        byte[] x = bytes32(d), h1 = bytes32(e);
+        byte[] V = new byte[32], K = new byte[32];
+        java.util.Arrays.fill(V, (byte) 1);
+        K = hmac(K, V, new byte[]{0}, x, h1);
+        V = hmac(K, V);
+        K = hmac(K, V, new byte[]{1}, x, h1);
+        V = hmac(K, V);
+
+        while (true) {
+            V = hmac(K, V);
+            BigInteger k = new BigInteger(1, V);
+            if (k.signum() > 0 && k.compareTo(n) < 0) {
+                BigInteger[] R = multiply(k, g);
+                BigInteger r = R[0].mod(n);
+                BigInteger s = k.modInverse(n).multiply(e.add(r.multiply(d))).mod(n);
+                int recId = (R[1].testBit(0) ? 1 : 0) | (R[0].compareTo(n) >= 0 ? 2 : 0);
+                if (s.compareTo(n.shiftRight(1)) > 0) {
+                    s = n.subtract(s);
+                    recId ^= 1;
+                }
+                byte[] sig = new byte[65];
+                sig[0] = (byte) (31 + recId);
+                System.arraycopy(bytes32(r), 0, sig, 1, 32);
+                System.arraycopy(bytes32(s), 0, sig, 33, 32);
+                if (r.signum() != 0 && s.signum() != 0 && (!canonical || isCanonical(sig))) {
+                    return sig;
+                }
+            }
+            K = hmac(K, V, new byte[]{0});
+            V = hmac(K, V);
+        }
+    }
+
+    /**
+     * Recovers the public key of a 65 byte compact signature over digest.
+     */
+    BigInteger[] recover(byte[] sig, byte[] digest) {
+        int recId = (sig[0] & 0xff) - 31;
+        BigInteger r = new BigInteger(1, java.util.Arrays.copyOfRange(sig, 1, 33));
+        BigInteger s = new BigInteger(1, java.util.Arrays.copyOfRange(sig, 33, 65));
+        BigInteger x = (recId & 2) != 0 ? r.add(n) : r;
+        // p = 3 mod 4 on both curves
+        BigInteger y = x.pow(3).add(a.multiply(x)).add(b).mod(p).modPow(p.add(BigInteger.ONE).shiftRight(2), p);
+        if (y.testBit(0) != ((recId & 1) != 0)) {
+            y = p.subtract(y);
+        }
+        BigInteger e = new BigInteger(1, digest).mod(n);
+        BigInteger rInv = r.modInverse(n);
+        BigInteger[] sR = multiply(s.multiply(rInv).mod(n), new BigInteger[]{x, y});
+        BigInteger[] eG = multiply(n.subtract(e).multiply(rInv).mod(n), g);
+        return add(sR, eG);
+    }
+
+    static boolean isCanonical(byte[] sig) {
+        return (sig[1] & 0x80) == 0 && !(sig[1] == 0 && (sig[2] & 0x80) == 0) &&
+                (sig[33] & 0x80) == 0 && !(sig[33] == 0 && (sig[34] & 0x80) == 0);
+    }
+
+    static byte[] sha256(byte[]... parts) throws GeneralSecurityException {
+        MessageDigest md = MessageDigest.getInstance("SHA-256");
+        for (byte[] part : parts) {
+            md.update(part);
+        }
+        return md.digest();
+    }
+
+    static byte[] bytes32(BigInteger v) {
+        byte[] raw = v.toByteArray();
+        byte[] out = new byte[32];
+        int length = Math.min(raw.length, 32);
+        System.arraycopy(raw, raw.length - length, out, 32 - length, length);
+        return out;
+    }
+
+    private static byte[] hmac(byte[] key, byte[]... parts) throws GeneralSecurityException {
+        Mac mac = Mac.getInstance("HmacSHA256");
+        mac.init(new SecretKeySpec(key, "HmacSHA256"));
+        for (byte[] part : parts) {
+            mac.update(part);
+        }
+        return mac.doFinal();
+    }
+}
@@ -0,0 +1,129 @@
+package com.yosemitex.yosemitewallet;
+
+import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+
+/**
+ * Desktop JVM test of YosEcNative against BigIntegerEc and fixed EOSIO vectors.
+ *
+ * Run by ctest when the host has a JDK, with java.library.path pointing at the
+ * yosemite_wallet_jni library of the host build.
+ */
+public final class YosEcNativeTest {
+
+    // the well known EOSIO development key
+    private static final String WIF = "5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3";
+    private static final String PVT_K1 = "PVT_K1_2bfGi9rYsXQSXXTvJbDAPhHLQUojjaNLomdm3cEJ1XTzMqUt3V";
+    private static final String PUB = "6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV";
+    // canonical K1 signature of sha256({0}) with the development key
+    private static final String SIG_0 = "SIG_K1_K4dLBQMt6aCRXku5SkCCrdfqaTbLXhe1nsC9apc9HjAJwARKSNkN8sZ1KbZ2rs5BezdChZUu839CThqpqWLKMXHtymAZBm";
+
+    private static final int COUNT = 16;
+
+    private static int failures = 0;
+
+    private static void check(String name, boolean ok) {
+        if (!ok) {
+            System.err.println("FAIL " + name);
+            failures++;
+        }
+    }
+
+    private static ByteBuffer direct(byte[] bytes) {
+        ByteBuffer buffer = YosEcNative.allocate(bytes.length);
+        buffer.put(bytes);
+        return buffer;
+    }
+
+    private static byte[] bytes(ByteBuffer buffer, int offset, int length) {
+        byte[] out = new byte[length];
+        ByteBuffer view = buffer.duplicate();
+        view.position(offset);
+        view.get(out);
+        return out;
+    }
+
+    private static void checkKeys() {
+        ByteBuffer wifKey = YosEcNative.allocate(YosEcNative.PRIVATE_KEY_SIZE);
+        ByteBuffer pvtKey = YosEcNative.allocate(YosEcNative.PRIVATE_KEY_SIZE);
+
+        check("decode wif", YosEcNative.decodePrivateKey(WIF, wifKey) == YosEcNative.CURVE_K1);
+        check("decode pvt", YosEcNative.decodePrivateKey(PVT_K1, pvtKey) == YosEcNative.CURVE_K1);
+        check("decode same", wifKey.equals(pvtKey));
+        check("decode checksum", YosEcNative.decodePrivateKey(PVT_K1.replace('3', '4'), pvtKey) < 0);
+        check("decode suffix", YosEcNative.decodePrivateKey(PVT_K1.replace("K1", "R1"), pvtKey) < 0);
+
+        ByteBuffer secret = YosEcNative.allocateSecret(YosEcNative.PRIVATE_KEY_SIZE);
+        check("secret", secret != null && secret.isDirect() && secret.capacity() == YosEcNative.PRIVATE_KEY_SIZE);
+        check("decode secret", YosEcNative.decodePrivateKey(WIF, secret) == YosEcNative.CURVE_K1 && secret.equals(wifKey));
+        check("secret too large", YosEcNative.allocateSecret(65) == null);
+
+        byte[] pub = BigIntegerEc.compress(BigIntegerEc.K1.multiply(new BigInteger(1, bytes(wifKey, 0, 32)), BigIntegerEc.K1.g));
+        check("public key", PUB.equals(YosEcNative.encodeBase58Check(direct(pub), pub.length, null)));
+    }
+
+    private static void checkDigests() throws Exception {
+        byte[] data = "yosemite".getBytes("UTF-8");
+        ByteBuffer digest = YosEcNative.allocate(YosEcNative.DIGEST_SIZE);
+
+        check("sha256", YosEcNative.sha256(direct(data), data.length, digest) == 0 &&
+                Arrays.equals(bytes(digest, 0, 32), BigIntegerEc.sha256(data)));
+
+        byte[] chainId = BigIntegerEc.sha256("chain".getBytes("UTF-8"));
+        byte[] trx = "packed transaction".getBytes("UTF-8");
+        byte[] cfd = "context free data".getBytes("UTF-8");
+        check("transaction digest", YosEcNative.transactionDigest(direct(chainId), direct(trx), trx.length,
+                direct(cfd), cfd.length, digest) == 0 &&
+                Arrays.equals(bytes(digest, 0, 32), BigIntegerEc.sha256(chainId, trx, BigIntegerEc.sha256(cfd))));
+        check("transaction digest without cfd", YosEcNative.transactionDigest(direct(chainId), direct(trx), trx.length,
+                null, 0, digest) == 0 &&
+                Arrays.equals(bytes(digest, 0, 32), BigIntegerEc.sha256(chainId, trx, new byte[32])));
+    }
+
+    private static void checkSign(String name, int curve, BigIntegerEc ec) throws Exception {
+        ByteBuffer key = YosEcNative.allocate(YosEcNative.PRIVATE_KEY_SIZE);
+        YosEcNative.decodePrivateKey(WIF, key);
+        BigInteger d = new BigInteger(1, bytes(key, 0, 32));
+        byte[] pub = BigIntegerEc.compress(ec.multiply(d, ec.g));
+
+        ByteBuffer digests = YosEcNative.allocate(YosEcNative.DIGEST_SIZE * COUNT);
+        for (int i = 0; i < COUNT; i++) {
+            digests.put(BigIntegerEc.sha256(new byte[]{(byte) i}));
+        }
+        ByteBuffer sigs = YosEcNative.allocate(YosEcNative.COMPACT_SIGNATURE_SIZE * COUNT);
+        check(name + " sign", YosEcNative.signDigests(curve, key, digests, COUNT, sigs, true) == 0);
+
+        ByteBuffer recovered = YosEcNative.allocate(YosEcNative.PUBLIC_KEY_SIZE);
+        ByteBuffer compressed = YosEcNative.allocate(YosEcNative.COMPRESSED_PUBLIC_KEY_SIZE);
+        for (int i = 0; i < COUNT; i++) {
+            byte[] digest = bytes(digests, 32 * i, 32);
+            byte[] sig = bytes(sigs, 65 * i, 65);
+            String label = name + " " + i;
+
+            check(label + " reference", Arrays.equals(sig, ec.sign(d, digest, curve == YosEcNative.CURVE_K1)));
+            check(label + " reference recover", Arrays.equals(pub, BigIntegerEc.compress(ec.recover(sig, digest))));
+            check(label + " recover", YosEcNative.recoverPublicKey(curve, direct(Arrays.copyOfRange(sig, 1, 65)),
+                    direct(digest), sig[0] - 31, recovered) == 0 &&
+                    YosEcNative.compressPublicKey(recovered, compressed) == 0 &&
+                    Arrays.equals(pub, bytes(compressed, 0, 33)));
+            check(label + " verify", YosEcNative.verifySignature(curve, direct(pub),
+                    direct(Arrays.copyOfRange(sig, 1, 65)), direct(digest)) == 0);
+            if (curve == YosEcNative.CURVE_K1) {
+                check(label + " canonical", BigIntegerEc.isCanonical(sig));
+            }
+        }
+
+        if (curve == YosEcNative.CURVE_K1) {
+            check(name + " vector", SIG_0.equals("SIG_K1_" + YosEcNative.encodeBase58Check(sigs, 65, "K1")));
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        checkKeys();
+        checkDigests();
+        checkSign("r1", YosEcNative.CURVE_R1, BigIntegerEc.R1);
+        checkSign("k1", YosEcNative.CURVE_K1, BigIntegerEc.K1);
+        System.exit(failures != 0 ? 1 : 0);
+    }
+}
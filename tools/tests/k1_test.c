@@ -0,0 +1,192 @@
+//
+//  k1_test.c
+//  YosWalletTest
+//
+//  Checks the secp256k1 fast paths against the generic ones: the folding
+//  reduction against bn_multiply_reduce, and multiplication, verification
+//  and recovery with the endomorphism (GLV) against a copy of the curve
+//  that has neither.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "bignum.h"
+#include "ecdsa.h"
+#include "secp256k1.h"
+
+static int failures = 0;
+static uint32_t seed = 0x9e3779b9;
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static uint32_t next_random(void)
+{
+  // xorshift32, the same numbers on every run
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+// a normalized number below 2^256
+static void random_bn(bignum256 *x)
+{
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    x->val[i] = next_random() & 0x3FFFFFFF;
+  }
+  x->val[8] = next_random() & 0xFFFF;
+}
+
+static void check_reduce(const char *name, const bignum256 *a, const bignum256 *b)
+{
+  const bignum256 *prime = &secp256k1.prime;
+  bignum256 generic = *b, fast = *b;
+
+  bn_multiply_with(a, &generic, prime, bn_multiply_reduce);
+  bn_multiply_with(a, &fast, prime, bn_multiply_reduce_k1);
+  // the folding reduction leaves a normalized number below 2^256
+  check(name, fast.val[8] <= 0xFFFF);
+  bn_mod(&generic, prime);
+  bn_mod(&fast, prime);
+  check(name, bn_is_equal(&generic, &fast));
+}
+
+static void test_reduce(void)
+{
+  bignum256 edges[6], a, b;
+  size_t i, j;
+
+  bn_zero(&edges[0]);
+  bn_one(&edges[1]);
+  bn_subtract(&secp256k1.prime, &edges[1], &edges[2]);
+  edges[3] = secp256k1.prime;
+  edges[4] = secp256k1.prime;
+  bn_addi(&edges[4], 1);
+  for (i = 0; i < 8; i++) {
+    edges[5].val[i] = 0x3FFFFFFF;
+  }
+  edges[5].val[8] = 0xFFFF;  // 2^256 - 1
+
+  for (i = 0; i < 6; i++) {
+    for (j = 0; j < 6; j++) {
+      check_reduce("reduce edges", &edges[i], &edges[j]);
+    }
+  }
+  for (i = 0; i < 1000; i++) {
+    random_bn(&a);
+    random_bn(&b);
+    check_reduce("reduce random", &a, &b);
+  }
+}
+
+// k * p on the curve and on the generic copy
+static void check_multiply(const char *name, const ecdsa_curve *generic, const bignum256 *k, const curve_point *p)
+{
+  curve_point fast_res, generic_res;
+
+  point_multiply(&secp256k1, k, p, &fast_res);
+  point_multiply(generic, k, p, &generic_res);
+  check(name, point_is_equal(&fast_res, &generic_res));
+}
+
+static void test_multiply(const ecdsa_curve *generic)
+{
+  const bignum256 *order = &secp256k1.order;
+  const bignum256 *lambda = &secp256k1.endo->lambda;
+  bignum256 scalars[8], k;
+  curve_point p;
+  size_t i;
+
+  // scalars at the edges of the split k = k1 + k2 * lambda
+  bn_one(&scalars[0]);
+  bn_subtract(order, &scalars[0], &scalars[1]);    // n - 1
+  scalars[2] = *lambda;                            // k1 = 0
+  scalars[3] = *lambda;
+  bn_addi(&scalars[3], 1);                         // k1 = k2 = 1
+  bn_subtract(order, lambda, &scalars[4]);         // -lambda
+  bn_zero(&scalars[5]);
+  bn_setbit(&scalars[5], 128);                     // 2^128
+  scalars[6] = secp256k1.order_half;
+  bn_zero(&scalars[7]);
+  bn_setbit(&scalars[7], 255);
+  bn_mod(&scalars[7], order);
+
+  // a second point besides G
+  bn_read_uint32(7, &k);
+  scalar_multiply(&secp256k1, &k, &p);
+
+  for (i = 0; i < 8; i++) {
+    check_multiply("multiply edges G", generic, &scalars[i], &secp256k1.G);
+    check_multiply("multiply edges 7G", generic, &scalars[i], &p);
+  }
+  for (i = 0; i < 32; i++) {
+    random_bn(&k);
+    bn_mod(&k, order);
+    if (bn_is_zero(&k)) {
+      continue;
+    }
+    check_multiply("multiply random", generic, &k, i & 1 ? &p : &secp256k1.G);
+  }
+}
+
+static void test_verify_recover(const ecdsa_curve *generic)
+{
+  enum { COUNT = 16 };
+  uint8_t key[32], digests[COUNT * 32], sigs[COUNT * 64], pub[65], fast_pub[65], generic_pub[65];
+  uint8_t batch_pubs[COUNT * 65];
+  int recids[COUNT], results[COUNT], i;
+  bignum256 d;
+  curve_point q;
+
+  memset(key, 0x42, sizeof(key));
+  bn_read_be(key, &d);
+  scalar_multiply(&secp256k1, &d, &q);
+  pub[0] = 0x04;
+  bn_write_be(&q.x, pub + 1);
+  bn_write_be(&q.y, pub + 33);
+
+  for (i = 0; i < COUNT * 32; i++) {
+    digests[i] = (uint8_t)next_random();
+  }
+  check("sign", ecdsa_sign_batch_key(&secp256k1, key, digests, COUNT, sigs, recids, NULL) == 0);
+  check("recover batch", ecdsa_recover_pub_from_sig_batch(&secp256k1, batch_pubs, sigs, digests, recids, results, COUNT) == 0);
+
+  for (i = 0; i < COUNT; i++) {
+    const uint8_t *sig = sigs + 64 * i, *digest = digests + 32 * i;
+    uint8_t bad[64];
+
+    check("verify", ecdsa_verify_digest(&secp256k1, pub, sig, digest) == 0);
+    check("verify generic", ecdsa_verify_digest(generic, pub, sig, digest) == 0);
+    check("recover", ecdsa_recover_pub_from_sig(&secp256k1, fast_pub, sig, digest, recids[i]) == 0 &&
+          memcmp(fast_pub, pub, 65) == 0);
+    check("recover generic", ecdsa_recover_pub_from_sig(generic, generic_pub, sig, digest, recids[i]) == 0 &&
+          memcmp(generic_pub, pub, 65) == 0);
+    check("recover batch result", results[i] == 0 && memcmp(batch_pubs + 65 * i, pub, 65) == 0);
+
+    memcpy(bad, sig, 64);
+    bad[63] ^= 1;
+    check("verify bad", ecdsa_verify_digest(&secp256k1, pub, bad, digest) != 0);
+    check("verify bad generic", ecdsa_verify_digest(generic, pub, bad, digest) != 0);
+  }
+}
+
+int main(void)
+{
+  // secp256k1 without the endomorphism and with the generic reduction
+  ecdsa_curve generic = secp256k1;
+  generic.endo = NULL;
+  generic.reduce = bn_multiply_reduce;
+
+  test_reduce();
+  test_multiply(&generic);
+  test_verify_recover(&generic);
+  return failures != 0;
+}
@@ -0,0 +1,287 @@
+//
+//  keystore_test.c
+//  YosWalletTest
+//
+//  Imports text and binary snapshots into key stores on one and several
+//  threads and checks the stores against ecdsa_read_pubkey: the stored
+//  keys must be exactly the distinct keys it accepts, in ascending order,
+//  whatever the snapshot mixes in (bad checksums, non-residues, x >= p,
+//  keys of the other type, duplicates and malformed tokens).
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "authority.h"
+#include "base58.h"
+#include "ecdsa.h"
+#include "keystore.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "sha2.h"
+
+// large enough to be split into several chunks
+#define COUNT 6000
+
+typedef struct {
+  uint8_t key[KEYSTORE_KEY_SIZE];
+  uint8_t type;
+  int good_token;      // the token decodes with a matching checksum
+  int counted;         // the token is one the importer has to find
+} entry;
+
+static int failures = 0;
+static entry entries[COUNT];
+static char dir[] = "/tmp/keystore_test.XXXXXX";
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static const ecdsa_curve *type_curve(uint8_t type)
+{
+  return type == AUTHORITY_KEY_K1 ? &secp256k1 : &secp256r1;
+}
+
+// the reference: ecdsa_read_pubkey on the key, padded so that it never
+// reads past it for a 0x04 prefix
+static int reference_valid(uint8_t type, const uint8_t *key)
+{
+  uint8_t padded[65];
+  curve_point pub;
+
+  memset(padded, 0, sizeof(padded));
+  memcpy(padded, key, KEYSTORE_KEY_SIZE);
+  return ecdsa_read_pubkey(type_curve(type), padded, &pub);
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+  return memcmp(a, b, KEYSTORE_KEY_SIZE);
+}
+
+// Random x, about half of them on the curve, and every few entries one of
+// the cases the importer has to reject or skip.
+static void build(void)
+{
+  entry *e;
+  uint8_t seed[4];
+  int i;
+
+  for (i = 0; i < COUNT; i++) {
+    e = &entries[i];
+    memcpy(seed, &i, sizeof(seed));
+    sha256_Raw(seed, sizeof(seed), e->key + 1);
+    e->key[0] = 0x02 + (i & 1);
+    e->type = i % 4 == 3 ? AUTHORITY_KEY_K1 : AUTHORITY_KEY_R1;
+    e->good_token = 1;
+    e->counted = 1;
+
+    switch (i % 23) {
+    case 5:
+      memset(e->key + 1, 0xff, 32);     // x >= p on both curves
+      break;
+    case 9:
+      e->key[0] = 0x04;
+      break;
+    case 13:
+      *e = entries[i - 13];
+      break;
+    case 17:
+      e->good_token = 0;                // a digit changed
+      break;
+    case 19:
+      e->good_token = 0;                // cut short
+      break;
+    case 21:
+      e->counted = 0;                   // glued to the word before it
+      break;
+    }
+  }
+}
+
+static void write_text(const char *path)
+{
+  FILE *f = fopen(path, "w");
+  char b58[64];
+  size_t b58sz;
+  int i;
+
+  for (i = 0; i < COUNT; i++) {
+    b58sz = sizeof(b58);
+    b58encWithChecksum(b58, &b58sz, entries[i].key, KEYSTORE_KEY_SIZE, entries[i].type == AUTHORITY_KEY_K1 ? "K1" : "R1");
+    if (i % 23 == 17) {
+      b58[10] = b58[10] == '2' ? '3' : '2';
+    } else if (i % 23 == 19) {
+      b58[20] = 0;
+    }
+    fprintf(f, i % 2 ? "%sPUB_%s_%s\n" : "{\"key\":\"%sPUB_%s_%s\",\"weight\":1},\n",
+            entries[i].counted ? "" : "x", entries[i].type == AUTHORITY_KEY_K1 ? "K1" : "R1", b58);
+  }
+  // a prefix without digits and a prefix of another type
+  fprintf(f, "PUB_R1_\nPUB_K1_\nPUB_XX_abc\n");
+  fclose(f);
+}
+
+static void write_binary(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  int i;
+
+  for (i = 0; i < COUNT; i++) {
+    fwrite(entries[i].key, KEYSTORE_KEY_SIZE, 1, f);
+  }
+  fclose(f);
+}
+
+// The distinct keys the store has to hold, sorted, with the number of keys
+// the importer finds and how many of those it has to reject.  binary
+// snapshots hold every key and are read as keys of type.
+static size_t expected_keys(uint8_t type, int binary, uint8_t *keys, uint64_t *found, uint64_t *invalid)
+{
+  size_t count = 0, distinct = 0, i;
+  int valid;
+
+  *found = *invalid = 0;
+  for (i = 0; i < COUNT; i++) {
+    if (!binary && (entries[i].type != type || !entries[i].counted)) {
+      continue;
+    }
+    (*found)++;
+    valid = (binary || entries[i].good_token) && reference_valid(type, entries[i].key);
+    if (!valid) {
+      (*invalid)++;
+      continue;
+    }
+    memcpy(keys + KEYSTORE_KEY_SIZE * count++, entries[i].key, KEYSTORE_KEY_SIZE);
+  }
+  if (!binary) {
+    // the bare prefix of type
+    (*found)++;
+    (*invalid)++;
+  }
+
+  qsort(keys, count, KEYSTORE_KEY_SIZE, compare_keys);
+  for (i = 0; i < count; i++) {
+    if (distinct == 0 || memcmp(keys + KEYSTORE_KEY_SIZE * (distinct - 1), keys + KEYSTORE_KEY_SIZE * i, KEYSTORE_KEY_SIZE) != 0) {
+      memmove(keys + KEYSTORE_KEY_SIZE * distinct++, keys + KEYSTORE_KEY_SIZE * i, KEYSTORE_KEY_SIZE);
+    }
+  }
+  return distinct;
+}
+
+static void run(const char *name, const char *snapshot, uint8_t type, int binary, unsigned int threads)
+{
+  static uint8_t expected[COUNT * KEYSTORE_KEY_SIZE];
+  char path[64];
+  keystore_import_stats stats;
+  keystore store;
+  uint64_t found, invalid;
+  size_t count, i;
+  int rejected = 1;
+
+  snprintf(path, sizeof(path), "%s/store", dir);
+  count = expected_keys(type, binary, expected, &found, &invalid);
+
+  check(name, keystore_import(snapshot, path, type, threads, binary ? KEYSTORE_BINARY_SNAPSHOT : 0, &stats) == 0);
+  check("found", stats.found == found);
+  check("invalid", stats.invalid == invalid);
+  check("stored", stats.stored == count);
+  check("threads", stats.threads == threads);
+
+  if (keystore_map(path, type, KEYSTORE_VERIFY_CHECKSUM, &store) != 0) {
+    check("map", 0);
+    return;
+  }
+  check("count", store.count == count);
+  check("keys", store.count == count && memcmp(store.keys, expected, count * KEYSTORE_KEY_SIZE) == 0);
+  for (i = 0; i < count; i++) {
+    check("find", keystore_find(&store, expected + KEYSTORE_KEY_SIZE * i) == (int64_t)i);
+  }
+  for (i = 0; i < COUNT; i++) {
+    if (!reference_valid(type, entries[i].key)) {
+      rejected &= keystore_find(&store, entries[i].key) == -1;
+    }
+  }
+  check("find rejected", rejected);
+  keystore_unmap(&store);
+}
+
+// a store of another type or with a changed key must not be mapped
+static void test_corrupt(const char *snapshot)
+{
+  char path[64];
+  keystore store;
+  uint8_t byte;
+  int fd;
+
+  snprintf(path, sizeof(path), "%s/store", dir);
+  check("import", keystore_import(snapshot, path, AUTHORITY_KEY_R1, 1, 0, NULL) == 0);
+  check("other type", keystore_map(path, AUTHORITY_KEY_K1, 0, &store) != 0);
+
+  fd = open(path, O_RDWR);
+  check("open", fd >= 0 && pread(fd, &byte, 1, KEYSTORE_HEADER_SIZE + 5) == 1);
+  byte ^= 1;
+  check("write", pwrite(fd, &byte, 1, KEYSTORE_HEADER_SIZE + 5) == 1);
+  close(fd);
+  check("checksum", keystore_map(path, AUTHORITY_KEY_R1, KEYSTORE_VERIFY_CHECKSUM, &store) != 0);
+}
+
+static void test_empty(void)
+{
+  char snapshot[64], path[64];
+  keystore store;
+  FILE *f;
+
+  snprintf(snapshot, sizeof(snapshot), "%s/empty.txt", dir);
+  snprintf(path, sizeof(path), "%s/store", dir);
+  f = fopen(snapshot, "w");
+  fclose(f);
+  check("import empty", keystore_import(snapshot, path, AUTHORITY_KEY_R1, 4, 0, NULL) == 0);
+  if (keystore_map(path, AUTHORITY_KEY_R1, KEYSTORE_VERIFY_CHECKSUM, &store) != 0) {
+    check("map empty", 0);
+    return;
+  }
+  check("empty count", store.count == 0);
+  check("empty find", keystore_find(&store, entries[0].key) == -1);
+  keystore_unmap(&store);
+  unlink(snapshot);
+}
+
+int main(void)
+{
+  char text[64], binary[64], path[64];
+  unsigned int threads;
+
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return 1;
+  }
+  snprintf(text, sizeof(text), "%s/snapshot.txt", dir);
+  snprintf(binary, sizeof(binary), "%s/snapshot.bin", dir);
+  snprintf(path, sizeof(path), "%s/store", dir);
+
+  build();
+  write_text(text);
+  write_binary(binary);
+  for (threads = 1; threads <= 4; threads += threads == 1 ? 2 : 1) {
+    run("text r1", text, AUTHORITY_KEY_R1, 0, threads);
+    run("text k1", text, AUTHORITY_KEY_K1, 0, threads);
+    run("binary r1", binary, AUTHORITY_KEY_R1, 1, threads);
+    run("binary k1", binary, AUTHORITY_KEY_K1, 1, threads);
+  }
+  test_corrupt(text);
+  test_empty();
+
+  unlink(text);
+  unlink(binary);
+  unlink(path);
+  rmdir(dir);
+  return failures != 0;
+}
@@ -0,0 +1,106 @@
+//
+//  rfc6979_test.c
+//  YosWalletTest
+//
+//  Checks deterministic signatures against RFC 6979, including digests
+//  that are not below the curve order, and the canonical K1 signatures
+//  EOSIO accepts.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "ecdsa.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+
+static int failures = 0;
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static void from_hex(const char *hex, uint8_t *out, size_t len)
+{
+  size_t i;
+  unsigned int byte;
+
+  for (i = 0; i < len; i++) {
+    sscanf(hex + 2 * i, "%2x", &byte);
+    out[i] = (uint8_t)byte;
+  }
+}
+
+// signs digest alone and in a batch, both must give the expected r | s
+static void check_sign(const char *name, const ecdsa_curve *curve, const char *key_hex, const uint8_t *digest, const char *sig_hex)
+{
+  uint8_t key[32], expected[64], sig[64], keys[2 * 32], digests[2 * 32], sigs[2 * 64];
+  int recids[2];
+  char label[64];
+
+  from_hex(key_hex, key, 32);
+  from_hex(sig_hex, expected, 64);
+
+  snprintf(label, sizeof(label), "%s single", name);
+  check(label, ecdsa_sign_digest(curve, key, digest, sig, NULL, NULL) == 0 && memcmp(sig, expected, 64) == 0);
+
+  memcpy(keys, key, 32);
+  memcpy(keys + 32, key, 32);
+  memcpy(digests, digest, 32);
+  memcpy(digests + 32, digest, 32);
+  snprintf(label, sizeof(label), "%s batch", name);
+  check(label, ecdsa_sign_batch(curve, keys, digests, 2, sigs, recids, NULL) == 0 &&
+        memcmp(sigs, expected, 64) == 0 && memcmp(sigs + 64, expected, 64) == 0);
+}
+
+// signs digests 0, 1, ... with the canonical rule alone and with one key
+// in a batch, all must agree, verify and be canonical
+static void check_canonical(const char *key_hex)
+{
+  enum { COUNT = 32 };
+  uint8_t key[32], digests[COUNT * 32], sigs[COUNT * 64], sig[64], pub[65];
+  int recids[COUNT], i, ok = 1;
+  uint8_t by;
+
+  from_hex(key_hex, key, 32);
+  memset(digests, 0, sizeof(digests));
+  for (i = 0; i < COUNT; i++) {
+    digests[32 * i + 31] = (uint8_t)i;
+  }
+  check("k1 canonical batch", ecdsa_sign_batch_key(&secp256k1, key, digests, COUNT, sigs, recids, ecdsa_sig_is_canonical) == 0);
+  for (i = 0; i < COUNT; i++) {
+    ok &= ecdsa_sign_digest(&secp256k1, key, digests + 32 * i, sig, &by, ecdsa_sig_is_canonical) == 0;
+    ok &= memcmp(sig, sigs + 64 * i, 64) == 0 && by == recids[i];
+    ok &= ecdsa_sig_is_canonical(by, sig);
+    ok &= ecdsa_recover_pub_from_sig(&secp256k1, pub, sig, digests + 32 * i, by) == 0;
+    ok &= ecdsa_verify_digest(&secp256k1, pub, sig, digests + 32 * i) == 0;
+  }
+  check("k1 canonical", ok);
+}
+
+int main(void)
+{
+  static const char *key = "c9afa9d845ba75166b5c215767b1d6934e50c3db36e89b127b8a622b120f6721";
+  uint8_t digest[32];
+
+  // RFC 6979 A.2.5, P-256 with SHA-256 of "sample", s in the lower half
+  from_hex("af2bdbe1aa9b6ec1e2ade1d694f41fc71a831d0268e9891562113d8a62add1bf", digest, 32);
+  check_sign("r1 sample", &secp256r1, key, digest,
+             "efd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716"
+             "0834e36ad29a83bf2bc9385e491d6099c8fdf9d1ed67aa7ea5f51f93782857a9");
+
+  // digests above the order seed the nonce with h mod n (bits2octets)
+  memset(digest, 0xff, sizeof(digest));
+  check_sign("r1 above order", &secp256r1, key, digest,
+             "1f2adbc54b88764c279f689fc9505959fc9e73e80dc20889a4e0be91865de75b"
+             "62ef64991d0403f61bd45f4d1a0fc98eefa16dae5e94bf1d6fc5f1859be60dfc");
+  check_sign("k1 above order", &secp256k1, key, digest,
+             "0f3dc2db1f3cc8669775d00fbaef097fe5149a11223e1385b78014055a5bb564"
+             "31956be8f43c54eb558cf3f446c6be775cc7e631ba5b296ed4bc16c065df2976");
+
+  check_canonical(key);
+  return failures != 0;
+}
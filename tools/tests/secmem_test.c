@@ -0,0 +1,76 @@
+//
+//  secmem_test.c
+//  YosWalletTest
+//
+//  Checks that secret slots are never handed out twice.
+//
+
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "secmem.h"
+
+static int failures = 0;
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+// returns 1 if the child process aborted in action
+static int aborts(void (*action)(void))
+{
+  int status;
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    action();
+    _exit(0);
+  }
+  return pid > 0 && waitpid(pid, &status, 0) == pid && WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+static void double_free(void)
+{
+  secmem_arena *arena = secmem_arena_new(32, 4);
+  void *p = secmem_alloc(arena);
+
+  secmem_alloc(arena);
+  secmem_free(arena, p);
+  secmem_free(arena, p);
+}
+
+static void foreign_free(void)
+{
+  secmem_arena *arena = secmem_arena_new(32, 4);
+  char *p = secmem_alloc(arena);
+
+  secmem_free(arena, p + 1);
+}
+
+int main(void)
+{
+  secmem_arena *arena = secmem_arena_new(32, 4);
+  void *p, *q, *r, *s;
+
+  p = secmem_alloc(arena);
+  q = secmem_alloc(arena);
+  check("two slots", p != NULL && q != NULL && p != q);
+  secmem_free(arena, p);
+  r = secmem_alloc(arena);
+  s = secmem_alloc(arena);
+  check("reuse after free", r != NULL && s != NULL && r != s && r != q && s != q);
+  secmem_free(arena, q);
+  secmem_free(arena, r);
+  secmem_free(arena, s);
+  secmem_arena_free(arena);
+
+  // misuse aborts, so it runs in child processes
+  check("double free aborts", aborts(double_free));
+  check("foreign pointer aborts", aborts(foreign_free));
+  return failures != 0;
+}
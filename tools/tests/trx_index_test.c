@@ -0,0 +1,166 @@
+//
+//  trx_index_test.c
+//  YosWalletTest
+//
+//  Checks the transaction id index: duplicates, expiration, eviction of
+//  full probe windows, its counters, and that threads inserting the same
+//  ids concurrently accept every id exactly once.  Build with YOS_TSAN to
+//  run it under ThreadSanitizer.
+//
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "sha2.h"
+#include "trx_index.h"
+
+#define THREADS    4
+#define THREAD_IDS 4096
+
+static int failures = 0;
+
+static void check(const char *name, int ok)
+{
+  if (!ok) {
+    fprintf(stderr, "FAIL %s\n", name);
+    failures++;
+  }
+}
+
+static void make_id(uint32_t n, uint8_t id[32])
+{
+  sha256_Raw((const uint8_t *)&n, sizeof(n), id);
+}
+
+// an id probing from the first slot of a one stripe index
+static void make_colliding_id(uint32_t n, uint8_t id[32])
+{
+  make_id(n, id);
+  memset(id, 0, 8);
+}
+
+static void test_single(void)
+{
+  trx_index *index = trx_index_new(64, 1);
+  trx_index_stats stats;
+  uint8_t a[32], b[32];
+
+  make_id(1, a);
+  make_id(2, b);
+  check("new", index != NULL);
+  check("absent", trx_index_contains(index, a, 100) == 0);
+  check("insert", trx_index_insert(index, a, 200, 100) == 0);
+  check("contains", trx_index_contains(index, a, 100) == 1);
+  check("other absent", trx_index_contains(index, b, 100) == 0);
+  check("duplicate", trx_index_insert(index, a, 200, 150) == 1);
+  // an id is forgotten once its transaction expired
+  check("expired", trx_index_contains(index, a, 200) == 0);
+  check("insert again", trx_index_insert(index, a, 300, 200) == 0);
+  check("contains again", trx_index_contains(index, a, 250) == 1);
+
+  trx_index_stats_get(index, &stats);
+  check("lookups", stats.lookups == 8);
+  check("hits", stats.hits == 3);
+  check("inserts", stats.inserts == 2);
+  check("reused", stats.reused == 1);
+  check("evictions", stats.evictions == 0);
+  trx_index_free(index);
+}
+
+static void test_eviction(void)
+{
+  trx_index *index = trx_index_new(TRX_INDEX_PROBE, 1);
+  trx_index_stats stats;
+  uint8_t ids[TRX_INDEX_PROBE + 2][32];
+  uint32_t i;
+
+  for (i = 0; i < TRX_INDEX_PROBE + 2; i++) {
+    make_colliding_id(i, ids[i]);
+  }
+  for (i = 0; i < TRX_INDEX_PROBE; i++) {
+    check("fill", trx_index_insert(index, ids[i], 1000 - i, 10) == 0);
+  }
+  // every slot is live, the id expiring first makes room
+  check("evict", trx_index_insert(index, ids[TRX_INDEX_PROBE], 2000, 10) == 0);
+  check("evicted", trx_index_contains(index, ids[TRX_INDEX_PROBE - 1], 10) == 0);
+  check("kept", trx_index_contains(index, ids[0], 10) == 1);
+  check("added", trx_index_contains(index, ids[TRX_INDEX_PROBE], 10) == 1);
+  // an expired slot is taken before any live one is evicted
+  check("reuse", trx_index_insert(index, ids[TRX_INDEX_PROBE + 1], 3000, 995) == 0);
+  check("not evicted", trx_index_contains(index, ids[0], 995) == 1);
+
+  trx_index_stats_get(index, &stats);
+  check("evictions", stats.evictions == 1);
+  check("reused", stats.reused == 1);
+  trx_index_free(index);
+}
+
+typedef struct {
+  trx_index *index;
+  atomic_int *accepted;
+  unsigned int offset;
+  unsigned int missing;     // ids not found right after their insert
+} thread_ctx;
+
+// every thread inserts all ids, each starting at another one, and looks
+// them up again
+static void *insert_thread(void *arg)
+{
+  thread_ctx *ctx = arg;
+  uint8_t id[32];
+  uint32_t i, n;
+
+  for (i = 0; i < THREAD_IDS; i++) {
+    n = (i + ctx->offset) % THREAD_IDS;
+    make_id(n, id);
+    if (trx_index_insert(ctx->index, id, 1000, 10) == 0) {
+      atomic_fetch_add(&ctx->accepted[n], 1);
+    }
+    ctx->missing += trx_index_contains(ctx->index, id, 10) != 1;
+  }
+  return NULL;
+}
+
+static void test_threads(void)
+{
+  static atomic_int accepted[THREAD_IDS];
+  trx_index *index = trx_index_new(4 * THREAD_IDS, 8);
+  thread_ctx ctx[THREADS];
+  pthread_t threads[THREADS];
+  trx_index_stats stats;
+  int i;
+
+  for (i = 0; i < THREAD_IDS; i++) {
+    atomic_init(&accepted[i], 0);
+  }
+  for (i = 0; i < THREADS; i++) {
+    ctx[i].index = index;
+    ctx[i].accepted = accepted;
+    ctx[i].offset = i * THREAD_IDS / THREADS;
+    ctx[i].missing = 0;
+    check("thread", pthread_create(&threads[i], NULL, insert_thread, &ctx[i]) == 0);
+  }
+  for (i = 0; i < THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    check("contains after insert", ctx[i].missing == 0);
+  }
+  for (i = 0; i < THREAD_IDS; i++) {
+    check("accepted once", atomic_load(&accepted[i]) == 1);
+  }
+
+  trx_index_stats_get(index, &stats);
+  check("thread inserts", stats.inserts == THREAD_IDS);
+  check("thread lookups", stats.lookups == 2 * THREADS * THREAD_IDS);
+  check("thread hits", stats.hits == (2 * THREADS - 1) * THREAD_IDS);
+  check("thread evictions", stats.evictions == 0);
+  trx_index_free(index);
+}
+
+int main(void)
+{
+  test_single();
+  test_eviction();
+  test_threads();
+  return failures != 0;
+}
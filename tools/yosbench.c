@@ -0,0 +1,756 @@
+//
+//  yosbench.c
+//  YosWalletTest
+//
+//  Micro benchmarks of the native core, one per hot path, e.g.
+//
+//    yosbench jacobian secp256k1
+//
+//  Every benchmark runs its loop several rounds and prints the fastest
+//  round per operation, which is the most stable number on a busy host.
+//  Benchmarks of curve arithmetic run on both curves unless one is given.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "authority.h"
+#include "bignum.h"
+#include "ecdsa.h"
+#include "memzero.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "secmem.h"
+#include "sha2.h"
+
+#define BENCH_ROUNDS 7
+
+static const struct {
+  const char *name;
+  const ecdsa_curve *curve;
+} curves[] = {
+  { "secp256r1", &secp256r1 },
+  { "secp256k1", &secp256k1 },
+};
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// runs fn(arg, 0 .. iterations - 1) BENCH_ROUNDS times and returns the
+// fastest round in nanoseconds per iteration
+static double best_ns(void (*fn)(void *arg, int i), void *arg, int iterations)
+{
+  double best = 0, start, elapsed;
+  int round, i;
+
+  for (round = 0; round < BENCH_ROUNDS; round++) {
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+      fn(arg, i);
+    }
+    elapsed = now_ns() - start;
+    if (round == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best / iterations;
+}
+
+static void report(const char *curve, const char *what, double ns)
+{
+  if (ns >= 1e5) {
+    printf("%-10s %-28s %10.1f us\n", curve, what, ns / 1e3);
+  } else {
+    printf("%-10s %-28s %10.0f ns\n", curve, what, ns);
+  }
+}
+
+// a scalar that differs per iteration, so no two multiplications are alike
+static void bench_scalar(int i, bignum256 *k)
+{
+  uint8_t bytes[32];
+
+  memset(bytes, 0x5a, sizeof(bytes));
+  bytes[0] = 0x3c;
+  bytes[31] = (uint8_t)i;
+  bytes[30] = (uint8_t)(i >> 8);
+  bn_read_be(bytes, k);
+}
+
+typedef struct {
+  const ecdsa_curve *curve;
+  curve_point p;
+} multiply_ctx;
+
+static void run_point_multiply(void *arg, int i)
+{
+  multiply_ctx *ctx = arg;
+  bignum256 k;
+
+  bench_scalar(i, &k);
+  point_multiply(ctx->curve, &k, &ctx->curve->G, &ctx->p);
+}
+
+static void run_scalar_multiply(void *arg, int i)
+{
+  multiply_ctx *ctx = arg;
+  bignum256 k;
+
+  bench_scalar(i, &k);
+  scalar_multiply(ctx->curve, &k, &ctx->p);
+}
+
+// Jacobian doubling and addition, through the variable base (mostly
+// doublings) and the comb (only additions) multiplications
+static void bench_jacobian(const char *name, const ecdsa_curve *curve)
+{
+  multiply_ctx ctx = { curve };
+
+  report(name, "point_multiply", best_ns(run_point_multiply, &ctx, 200));
+  report(name, "scalar_multiply", best_ns(run_scalar_multiply, &ctx, 400));
+}
+
+typedef struct {
+  const ecdsa_curve *curve;
+  curve_point p;
+  jacobian_curve_point jp;
+} jacobian_ctx;
+
+static void run_jacobian_add(void *arg, int i)
+{
+  jacobian_ctx *ctx = arg;
+
+  point_jacobian_add(&ctx->p, &ctx->jp, ctx->curve);
+}
+
+static void run_jacobian_double(void *arg, int i)
+{
+  jacobian_ctx *ctx = arg;
+
+  point_jacobian_double(&ctx->jp, ctx->curve);
+}
+
+// One jacobian addition and doubling, the formulas whose reductions are
+// left to where the coordinate bounds need them
+static void bench_point(const char *name, const ecdsa_curve *curve)
+{
+  jacobian_ctx ctx = { curve, curve->G };
+
+  point_double(curve, &ctx.p);
+  curve_to_jacobian(&curve->G, &ctx.jp, curve);
+  report(name, "point_jacobian_add", best_ns(run_jacobian_add, &ctx, 200000));
+  report(name, "point_jacobian_double", best_ns(run_jacobian_double, &ctx, 200000));
+}
+
+typedef struct {
+  const ecdsa_curve *curve;
+  bignum256 x;
+} field_ctx;
+
+static void run_field_multiply(void *arg, int i)
+{
+  field_ctx *ctx = arg;
+
+  bn_multiply_with(&ctx->curve->G.x, &ctx->x, &ctx->curve->prime, ctx->curve->reduce);
+}
+
+static void run_field_multiply_generic(void *arg, int i)
+{
+  field_ctx *ctx = arg;
+
+  bn_multiply(&ctx->curve->G.x, &ctx->x, &ctx->curve->prime);
+}
+
+// one multiplication modulo the field prime, with the reduction the
+// curve chose and with the generic one
+static void bench_field(const char *name, const ecdsa_curve *curve)
+{
+  field_ctx ctx = { curve, curve->G.y };
+
+  report(name, "field multiply", best_ns(run_field_multiply, &ctx, 1000000));
+  report(name, "field multiply (generic)", best_ns(run_field_multiply_generic, &ctx, 1000000));
+}
+
+#define DECOMPRESS_COUNT 64
+
+typedef struct {
+  const ecdsa_curve *curve;
+  uint8_t keys[DECOMPRESS_COUNT][65];    // compressed, padded for 0x04 reads
+  uint8_t sigs[DECOMPRESS_COUNT][64];
+  uint8_t digest[32];
+  int valid;
+} decompress_ctx;
+
+// ecdsa_read_pubkey of a compressed key as it was before the Jacobi
+// symbol: always the square root, then the check that y^2 = x^3 + ax + b
+static int read_pubkey_sqrt_first(const ecdsa_curve *curve, const uint8_t *pub_key)
+{
+  curve_point pub;
+  bignum256 y2;
+
+  bn_read_be(pub_key + 1, &pub.x);
+  if (!bn_is_less(&pub.x, &curve->prime)) {
+    return 0;
+  }
+  y2 = pub.x;
+  bn_multiply_with(&pub.x, &y2, &curve->prime, curve->reduce);
+  bn_subi(&y2, -curve->a, &curve->prime);
+  bn_multiply_with(&pub.x, &y2, &curve->prime, curve->reduce);
+  bn_add(&y2, &curve->b);
+  bn_fast_mod(&y2, &curve->prime);
+  bn_mod(&y2, &curve->prime);
+  pub.y = y2;
+  bn_sqrt_with(&pub.y, &curve->prime, curve->reduce);
+  if ((pub_key[0] & 1) != (pub.y.val[0] & 1)) {
+    bn_subtract(&curve->prime, &pub.y, &pub.y);
+  }
+  return ecdsa_validate_pubkey(curve, &pub);
+}
+
+static void run_read_sqrt_first(void *arg, int i)
+{
+  decompress_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < DECOMPRESS_COUNT; j++) {
+    read_pubkey_sqrt_first(ctx->curve, ctx->keys[j]);
+  }
+}
+
+static void run_read_pubkey(void *arg, int i)
+{
+  decompress_ctx *ctx = arg;
+  curve_point pub;
+  int j;
+
+  for (j = 0; j < DECOMPRESS_COUNT; j++) {
+    ecdsa_read_pubkey(ctx->curve, ctx->keys[j], &pub);
+  }
+}
+
+static void run_validate_compressed(void *arg, int i)
+{
+  decompress_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < DECOMPRESS_COUNT; j++) {
+    ecdsa_validate_compressed_pubkey(ctx->curve, ctx->keys[j]);
+  }
+}
+
+static void run_recover_garbage(void *arg, int i)
+{
+  decompress_ctx *ctx = arg;
+  uint8_t pub_key[65];
+  int j;
+
+  for (j = 0; j < DECOMPRESS_COUNT; j++) {
+    ecdsa_recover_pub_from_sig(ctx->curve, pub_key, ctx->sigs[j], ctx->digest, j & 1);
+  }
+}
+
+// Compressed keys with random x, about half of them off the curve as in
+// untrusted input, read the old way, with ecdsa_read_pubkey and only
+// validated, and recovery from random signatures, whose R is just as
+// often off the curve.
+static void bench_decompress(const char *name, const ecdsa_curve *curve)
+{
+  decompress_ctx *ctx = calloc(1, sizeof(decompress_ctx));
+  curve_point pub;
+  uint8_t seed[4];
+  char what[40];
+  int j;
+
+  if (ctx == NULL) {
+    return;
+  }
+  ctx->curve = curve;
+  for (j = 0; j < DECOMPRESS_COUNT; j++) {
+    memcpy(seed, &j, sizeof(seed));
+    sha256_Raw(seed, sizeof(seed), ctx->keys[j] + 1);
+    ctx->keys[j][0] = 0x02 + (j & 1);
+    ctx->valid += ecdsa_read_pubkey(curve, ctx->keys[j], &pub);
+    sha256_Raw(ctx->keys[j] + 1, 32, ctx->sigs[j]);
+    sha256_Raw(ctx->sigs[j], 32, ctx->sigs[j] + 32);
+    ctx->sigs[j][0] &= 0x7f;
+    ctx->sigs[j][32] &= 0x7f;
+  }
+  snprintf(what, sizeof(what), "%d of %d keys on the curve", ctx->valid, DECOMPRESS_COUNT);
+  printf("%-10s %s\n", name, what);
+  report(name, "read key, sqrt first", best_ns(run_read_sqrt_first, ctx, 20) / DECOMPRESS_COUNT);
+  report(name, "ecdsa_read_pubkey", best_ns(run_read_pubkey, ctx, 20) / DECOMPRESS_COUNT);
+  report(name, "validate_compressed_pubkey", best_ns(run_validate_compressed, ctx, 20) / DECOMPRESS_COUNT);
+  report(name, "recover, random signatures", best_ns(run_recover_garbage, ctx, 2) / DECOMPRESS_COUNT);
+  free(ctx);
+}
+
+#define SIGN_COUNT 64
+
+typedef struct {
+  const ecdsa_curve *curve;
+  uint8_t keys[SIGN_COUNT * 32];
+  uint8_t digests[SIGN_COUNT * 32];
+  uint8_t sigs[SIGN_COUNT * 64];
+  int recids[SIGN_COUNT];
+} sign_ctx;
+
+static void run_sign_digest(void *arg, int i)
+{
+  sign_ctx *ctx = arg;
+  uint8_t by;
+  int j;
+
+  for (j = 0; j < SIGN_COUNT; j++) {
+    ecdsa_sign_digest(ctx->curve, ctx->keys, ctx->digests + 32 * j, ctx->sigs + 64 * j, &by, NULL);
+  }
+}
+
+static void run_sign_batch_key(void *arg, int i)
+{
+  sign_ctx *ctx = arg;
+
+  ecdsa_sign_batch_key(ctx->curve, ctx->keys, ctx->digests, SIGN_COUNT, ctx->sigs, ctx->recids, NULL);
+}
+
+static void run_sign_batch(void *arg, int i)
+{
+  sign_ctx *ctx = arg;
+
+  ecdsa_sign_batch(ctx->curve, ctx->keys, ctx->digests, SIGN_COUNT, ctx->sigs, ctx->recids, NULL);
+}
+
+// SIGN_COUNT digests signed one by one with ecdsa_sign_digest, as a batch
+// with one key and as a batch with a key each, on one thread so the
+// numbers are per core, then the batches with the default threads
+static void bench_sign(const char *name, const ecdsa_curve *curve)
+{
+  sign_ctx *ctx = malloc(sizeof(sign_ctx));
+  ecdsa_batch_params saved, params;
+  char what[32];
+  int i;
+
+  if (ctx == NULL) {
+    return;
+  }
+  ctx->curve = curve;
+  for (i = 0; i < SIGN_COUNT * 32; i++) {
+    ctx->keys[i] = (uint8_t)(i * 7 + 1);
+    ctx->digests[i] = (uint8_t)(i * 13 + 5);
+  }
+  for (i = 0; i < SIGN_COUNT; i++) {
+    // keep every key below the order of both curves
+    ctx->keys[32 * i] &= 0x7f;
+  }
+
+  ecdsa_get_batch_params(&saved);
+  params = saved;
+  params.sign_threads = 1;
+  ecdsa_set_batch_params(&params);
+  report(name, "ecdsa_sign_digest", best_ns(run_sign_digest, ctx, 2) / SIGN_COUNT);
+  report(name, "ecdsa_sign_batch_key", best_ns(run_sign_batch_key, ctx, 2) / SIGN_COUNT);
+  report(name, "ecdsa_sign_batch", best_ns(run_sign_batch, ctx, 2) / SIGN_COUNT);
+
+  ecdsa_set_batch_params(&saved);
+  if (saved.sign_threads > 1) {
+    snprintf(what, sizeof(what), "ecdsa_sign_batch_key, %u thr", saved.sign_threads);
+    report(name, what, best_ns(run_sign_batch_key, ctx, 2) / SIGN_COUNT);
+    snprintf(what, sizeof(what), "ecdsa_sign_batch, %u thr", saved.sign_threads);
+    report(name, what, best_ns(run_sign_batch, ctx, 2) / SIGN_COUNT);
+  }
+  free(ctx);
+}
+
+#define CONVERT_COUNT 64
+
+typedef struct {
+  const ecdsa_curve *curve;
+  uint8_t sigs[CONVERT_COUNT * 64];
+  uint8_t digests[CONVERT_COUNT * 32];
+  uint8_t pub_keys[CONVERT_COUNT * 65];
+  int recids[CONVERT_COUNT];
+  int results[CONVERT_COUNT];
+  bignum256 numbers[CONVERT_COUNT];
+} convert_ctx;
+
+// bn_read_be and bn_write_be as they were before the 64-bit words: one
+// 32-bit big endian load or store per limb
+static void read_be_by_limb(const uint8_t *in_number, bignum256 *out_number)
+{
+  uint32_t temp = 0, limb;
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    limb = (uint32_t)in_number[(7 - i) * 4] << 24 | (uint32_t)in_number[(7 - i) * 4 + 1] << 16 |
+           (uint32_t)in_number[(7 - i) * 4 + 2] << 8 | in_number[(7 - i) * 4 + 3];
+    temp |= limb << (2 * i);
+    out_number->val[i] = temp & 0x3FFFFFFF;
+    temp = limb >> (30 - 2 * i);
+  }
+  out_number->val[8] = temp;
+}
+
+static void write_be_by_limb(const bignum256 *in_number, uint8_t *out_number)
+{
+  uint32_t temp = in_number->val[8], limb;
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    limb = in_number->val[7 - i];
+    temp = (temp << (16 + 2 * i)) | (limb >> (14 - 2 * i));
+    out_number[i * 4] = temp >> 24;
+    out_number[i * 4 + 1] = temp >> 16;
+    out_number[i * 4 + 2] = temp >> 8;
+    out_number[i * 4 + 3] = temp;
+    temp = limb;
+  }
+}
+
+static void run_read_by_limb(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < CONVERT_COUNT; j++) {
+    read_be_by_limb(ctx->sigs + 64 * j, &ctx->numbers[j]);
+  }
+}
+
+static void run_read_be(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < CONVERT_COUNT; j++) {
+    bn_read_be(ctx->sigs + 64 * j, &ctx->numbers[j]);
+  }
+}
+
+static void run_read_be_batch(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+
+  bn_read_be_batch(ctx->sigs, 64, ctx->numbers, CONVERT_COUNT);
+}
+
+static void run_write_by_limb(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < CONVERT_COUNT; j++) {
+    write_be_by_limb(&ctx->numbers[j], ctx->pub_keys + 65 * j + 1);
+  }
+}
+
+static void run_write_be(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+  int j;
+
+  for (j = 0; j < CONVERT_COUNT; j++) {
+    bn_write_be(&ctx->numbers[j], ctx->pub_keys + 65 * j + 1);
+  }
+}
+
+static void run_write_be_batch(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+
+  bn_write_be_batch(ctx->numbers, ctx->pub_keys + 1, 65, CONVERT_COUNT);
+}
+
+static void run_recover_batch(void *arg, int i)
+{
+  convert_ctx *ctx = arg;
+
+  ecdsa_recover_pub_from_sig_batch(ctx->curve, ctx->pub_keys, ctx->sigs, ctx->digests, ctx->recids, ctx->results, CONVERT_COUNT);
+}
+
+// Conversions of CONVERT_COUNT numbers laid out as the r of signatures
+// and the x of public keys, one limb at a time as before, with bn_read_be
+// and bn_write_be and with the batch converters, against batch recovery
+// of as many signatures, which converts five numbers per signature (r, s,
+// the digest and the x and y of the key).
+static void bench_convert(const char *name, const ecdsa_curve *curve)
+{
+  convert_ctx *ctx = malloc(sizeof(convert_ctx));
+  uint8_t key[32];
+  double by_limb, current, recover;
+  char what[40];
+  int i;
+
+  if (ctx == NULL) {
+    return;
+  }
+  ctx->curve = curve;
+  for (i = 0; i < 32; i++) {
+    key[i] = (uint8_t)(i * 7 + 1);
+  }
+  for (i = 0; i < CONVERT_COUNT * 32; i++) {
+    ctx->digests[i] = (uint8_t)(i * 13 + 5);
+  }
+  ecdsa_sign_batch_key(curve, key, ctx->digests, CONVERT_COUNT, ctx->sigs, ctx->recids, NULL);
+  bn_read_be_batch(ctx->sigs, 64, ctx->numbers, CONVERT_COUNT);
+
+  by_limb = best_ns(run_read_by_limb, ctx, 10000) / CONVERT_COUNT;
+  report(name, "read, one limb at a time", by_limb);
+  report(name, "bn_read_be", best_ns(run_read_be, ctx, 10000) / CONVERT_COUNT);
+  report(name, "bn_read_be_batch", best_ns(run_read_be_batch, ctx, 10000) / CONVERT_COUNT);
+  current = best_ns(run_write_by_limb, ctx, 10000) / CONVERT_COUNT;
+  by_limb = (by_limb + current) / 2;
+  report(name, "write, one limb at a time", current);
+  report(name, "bn_write_be", best_ns(run_write_be, ctx, 10000) / CONVERT_COUNT);
+  current = best_ns(run_write_be_batch, ctx, 10000) / CONVERT_COUNT;
+  report(name, "bn_write_be_batch", current);
+  current = (current + best_ns(run_read_be_batch, ctx, 10000) / CONVERT_COUNT) / 2;
+
+  recover = best_ns(run_recover_batch, ctx, 2) / CONVERT_COUNT;
+  report(name, "recover_pub_from_sig_batch", recover);
+  snprintf(what, sizeof(what), "5 by limb, %.4f%% of it", 500 * by_limb / recover);
+  report(name, what, 5 * by_limb);
+  snprintf(what, sizeof(what), "5 batch, %.4f%% of it", 500 * current / recover);
+  report(name, what, 5 * current);
+  free(ctx);
+}
+
+#define SECRET_SIZE 64
+
+static void run_secmem_slot(void *arg, int i)
+{
+  uint8_t *secret = secmem_alloc(arg);
+
+  secret[0] = (uint8_t)i;
+  secmem_free(arg, secret);
+}
+
+static void run_mlock_heap(void *arg, int i)
+{
+  uint8_t *secret = malloc(SECRET_SIZE);
+
+  mlock(secret, SECRET_SIZE);
+  secret[0] = (uint8_t)i;
+  memzero(secret, SECRET_SIZE);
+  munlock(secret, SECRET_SIZE);
+  free(secret);
+}
+
+static void run_mlock_mapping(void *arg, int i)
+{
+  size_t page = (size_t)getpagesize();
+  uint8_t *secret = mmap(NULL, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+
+  mlock(secret, page);
+#ifdef MADV_DONTDUMP
+  madvise(secret, page, MADV_DONTDUMP);
+#endif
+  secret[0] = (uint8_t)i;
+  memzero(secret, SECRET_SIZE);
+  munlock(secret, page);
+  munmap(secret, page);
+}
+
+// taking and returning a locked slot for a 64 byte secret against locking
+// memory on every use, on the heap and in a mapping of its own as the
+// arena would without its pool
+static void bench_secmem(const char *name, const ecdsa_curve *curve)
+{
+  secmem_arena *arena = secmem_arena_new(SECRET_SIZE, 64);
+
+  if (arena == NULL) {
+    fprintf(stderr, "cannot map the arena\n");
+    return;
+  }
+  printf("arena %s locked\n", secmem_arena_locked(arena) ? "is" : "is not");
+  report("64 bytes", "arena slot", best_ns(run_secmem_slot, arena, 100000));
+  report("64 bytes", "malloc + mlock", best_ns(run_mlock_heap, NULL, 100000));
+  report("64 bytes", "mmap + mlock", best_ns(run_mlock_mapping, NULL, 20000));
+  secmem_arena_free(arena);
+}
+
+#define AUTHORITY_ACCOUNTS      10000
+#define AUTHORITY_TRANSACTIONS  64
+#define AUTHORITY_MAX_ACTIONS   256
+
+typedef struct {
+  authority_index *index;
+  authority_scratch *scratch;
+  authority_key keys[AUTHORITY_TRANSACTIONS][AUTHORITY_MAX_ACTIONS];
+  authority_level levels[AUTHORITY_TRANSACTIONS][AUTHORITY_MAX_ACTIONS];
+  size_t actions, signatures;
+} authority_ctx;
+
+// key n of account: only the index looks at it, so it need not be on a curve
+static void authority_bench_key(uint32_t account, uint32_t n, authority_key *key)
+{
+  key->type = AUTHORITY_KEY_R1;
+  memset(key->data, 0x5a, sizeof(key->data));
+  key->data[0] = 0x02;
+  memcpy(key->data + 1, &account, 4);
+  key->data[5] = (uint8_t)n;
+}
+
+// owner with one key, active with three keys and threshold 2
+static void authority_bench_account(authority_index *index, uint32_t account)
+{
+  authority_key_weight owner, active[3];
+  authority_level level = { account, 1 };
+  int i;
+
+  authority_bench_key(account, 0, &owner.key);
+  owner.weight = 1;
+  for (i = 0; i < 3; i++) {
+    authority_bench_key(account, i + 1, &active[i].key);
+    active[i].weight = 1;
+  }
+  authority_set_permission(index, &level, 0, 1, &owner, 1, NULL, 0);
+  level.permission = 2;
+  authority_set_permission(index, &level, 1, 2, active, 3, NULL, 0);
+}
+
+static void run_authority_check(void *arg, int i)
+{
+  authority_ctx *ctx = arg;
+  int t = i % AUTHORITY_TRANSACTIONS;
+
+  authority_check_scratch(ctx->index, ctx->scratch, ctx->keys[t], ctx->signatures, ctx->levels[t], ctx->actions, NULL);
+}
+
+static void run_authority_check_each(void *arg, int i)
+{
+  authority_ctx *ctx = arg;
+  int t = i % AUTHORITY_TRANSACTIONS;
+  size_t j;
+
+  for (j = 0; j < ctx->actions; j++) {
+    authority_check_scratch(ctx->index, ctx->scratch, ctx->keys[t], ctx->signatures, &ctx->levels[t][j], 1, NULL);
+  }
+}
+
+static void run_authority_update(void *arg, int i)
+{
+  authority_ctx *ctx = arg;
+
+  authority_bench_account(ctx->index, 1 + i % AUTHORITY_ACCOUNTS);
+}
+
+// Whole transactions of many actions by a few accounts, each account
+// signing with two of its three active keys, checked in one call and one
+// call per action, and replacing the permissions of an account.
+static void bench_authority(const char *name, const ecdsa_curve *curve)
+{
+  static const size_t shapes[][2] = { { 1, 1 }, { 16, 4 }, { 64, 16 }, { 256, 64 } };
+  authority_ctx *ctx = calloc(1, sizeof(authority_ctx));
+  char label[32];
+  size_t shape, actors, t, j;
+  uint32_t account;
+
+  if (ctx == NULL) {
+    return;
+  }
+  ctx->index = authority_index_new();
+  ctx->scratch = authority_scratch_new();
+  for (account = 1; account <= AUTHORITY_ACCOUNTS; account++) {
+    authority_bench_account(ctx->index, account);
+  }
+  printf("%d accounts, owner and active each\n", AUTHORITY_ACCOUNTS);
+
+  for (shape = 0; shape < sizeof(shapes) / sizeof(shapes[0]); shape++) {
+    ctx->actions = shapes[shape][0];
+    actors = shapes[shape][1];
+    ctx->signatures = 2 * actors;
+    for (t = 0; t < AUTHORITY_TRANSACTIONS; t++) {
+      for (j = 0; j < actors; j++) {
+        account = (uint32_t)(1 + (t * 97 + j * 31) % AUTHORITY_ACCOUNTS);
+        authority_bench_key(account, 2, &ctx->keys[t][2 * j]);
+        authority_bench_key(account, 3, &ctx->keys[t][2 * j + 1]);
+      }
+      for (j = 0; j < ctx->actions; j++) {
+        ctx->levels[t][j].actor = 1 + (t * 97 + (j % actors) * 31) % AUTHORITY_ACCOUNTS;
+        ctx->levels[t][j].permission = 2;
+      }
+    }
+    if (authority_check_scratch(ctx->index, ctx->scratch, ctx->keys[0], ctx->signatures, ctx->levels[0], ctx->actions, NULL) != 0) {
+      fprintf(stderr, "transactions are not authorized\n");
+    }
+    snprintf(label, sizeof(label), "%zux%zu", ctx->actions, ctx->signatures);
+    report(label, "check transaction", best_ns(run_authority_check, ctx, 20000 / (int)ctx->actions + 100));
+    report(label, "check each action", best_ns(run_authority_check_each, ctx, 20000 / (int)ctx->actions + 100));
+  }
+  report("account", "set owner and active", best_ns(run_authority_update, ctx, AUTHORITY_ACCOUNTS));
+
+  authority_scratch_free(ctx->scratch);
+  authority_index_free(ctx->index);
+  free(ctx);
+}
+
+// per_curve benchmarks get each curve to run on, the others NULL
+static const struct {
+  const char *name;
+  int per_curve;
+  void (*run)(const char *curve_name, const ecdsa_curve *curve);
+} benchmarks[] = {
+  { "authority", 0, bench_authority },
+  { "convert", 1, bench_convert },
+  { "decompress", 1, bench_decompress },
+  { "field", 1, bench_field },
+  { "jacobian", 1, bench_jacobian },
+  { "point", 1, bench_point },
+  { "secmem", 0, bench_secmem },
+  { "sign", 1, bench_sign },
+};
+
+static void usage(const char *prog)
+{
+  size_t i;
+  fprintf(stderr, "usage: %s <benchmark> [curve]\n", prog);
+  fprintf(stderr, "benchmarks:");
+  for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+    fprintf(stderr, " %s", benchmarks[i].name);
+  }
+  fprintf(stderr, "\ncurves:");
+  for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    fprintf(stderr, " %s", curves[i].name);
+  }
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+  size_t b, c;
+  int found = 0;
+
+  if (argc < 2 || argc > 3) {
+    usage(argv[0]);
+    return 1;
+  }
+  for (b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+    if (strcmp(benchmarks[b].name, argv[1]) != 0) {
+      continue;
+    }
+    if (!benchmarks[b].per_curve) {
+      if (argc == 2) {
+        benchmarks[b].run(NULL, NULL);
+        found = 1;
+      }
+      continue;
+    }
+    for (c = 0; c < sizeof(curves) / sizeof(curves[0]); c++) {
+      if (argc == 2 || strcmp(curves[c].name, argv[2]) == 0) {
+        benchmarks[b].run(curves[c].name, curves[c].curve);
+        found = 1;
+      }
+    }
+  }
+  if (!found) {
+    usage(argv[0]);
+    return 1;
+  }
+  return 0;
+}
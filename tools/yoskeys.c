@@ -0,0 +1,120 @@
+//
+//  yoskeys.c
+//  YosWalletTest
+//
+//  Imports the public keys of a permission snapshot into a key store (see
+//  keystore.h) and reports the import rate and memory use, e.g.
+//
+//    yoskeys -j 8 permissions.txt r1.keys
+//
+//  -b reads a binary snapshot of compressed keys and -k imports PUB_K1_
+//  instead of PUB_R1_ keys.  With -c the store is only mapped with its
+//  checksum verified, and every key is looked up once.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "authority.h"
+#include "keystore.h"
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-b] [-k] [-j threads] <snapshot> <store>\n", prog);
+  fprintf(stderr, "       %s -c [-k] <store>\n", prog);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double peak_rss_mb(void)
+{
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1048576.0;
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static int check(const char *prog, const char *path, uint8_t key_type)
+{
+  keystore store;
+  double start, mapped, end;
+  size_t i, misses = 0;
+
+  start = now();
+  if (keystore_map(path, key_type, KEYSTORE_VERIFY_CHECKSUM, &store) != 0) {
+    fprintf(stderr, "%s: cannot map %s\n", prog, path);
+    return 1;
+  }
+  mapped = now();
+  for (i = 0; i < store.count; i++) {
+    misses += keystore_find(&store, store.keys + KEYSTORE_KEY_SIZE * i) != (int64_t)i;
+  }
+  end = now();
+
+  printf("keys      %zu (%zu bytes mapped)\n", store.count, store.map_size);
+  printf("map       %.3f s with checksum\n", mapped - start);
+  printf("lookups   %.0f keys/s, %zu misses\n", store.count / (end - mapped > 0 ? end - mapped : 1e-9), misses);
+  printf("peak rss  %.1f MB\n", peak_rss_mb());
+  keystore_unmap(&store);
+  return misses != 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *prog = argv[0];
+  keystore_import_stats stats;
+  uint8_t key_type = AUTHORITY_KEY_R1;
+  int flags = 0, checking = 0, threads = 0, i;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "-b") == 0) {
+      flags |= KEYSTORE_BINARY_SNAPSHOT;
+    } else if (strcmp(argv[i], "-k") == 0) {
+      key_type = AUTHORITY_KEY_K1;
+    } else if (strcmp(argv[i], "-c") == 0) {
+      checking = 1;
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else {
+      usage(prog);
+      return 1;
+    }
+  }
+  if (checking) {
+    if (i != argc - 1) {
+      usage(prog);
+      return 1;
+    }
+    return check(prog, argv[i], key_type);
+  }
+  if (i != argc - 2 || threads < 0) {
+    usage(prog);
+    return 1;
+  }
+
+  if (keystore_import(argv[i], argv[i + 1], key_type, threads, flags, &stats) != 0) {
+    fprintf(stderr, "%s: cannot import %s into %s\n", prog, argv[i], argv[i + 1]);
+    return 1;
+  }
+  printf("found     %llu keys\n", (unsigned long long)stats.found);
+  printf("invalid   %llu\n", (unsigned long long)stats.invalid);
+  printf("stored    %llu distinct\n", (unsigned long long)stats.stored);
+  printf("threads   %u\n", stats.threads);
+  printf("import    %.3f s, %.0f keys/s\n", stats.seconds, stats.keys_per_second);
+  printf("peak rss  %.1f MB\n", stats.peak_rss / 1048576.0);
+  return 0;
+}
@@ -0,0 +1,525 @@
+//
+//  yosreplay.c
+//  YosWalletTest
+//
+//  Replays the blocks of a local file through the ingest pipeline (see
+//  ingest.h) and reports the validation rate and the counters of every
+//  stage, e.g.
+//
+//    yosreplay -g 100 200 blocks.bin
+//    yosreplay -t 1,1,4,1 -b 32 blocks.bin
+//
+//  -g writes a file of synthetic blocks, signed by accounts with R1 and K1
+//  keys, to replay when no recorded blocks are at hand.  A replay submits
+//  every block and waits for it before the next one, like a node applying
+//  blocks, and keeps the fastest of -r rounds.  -d adds an id index.
+//
+//  The file is little endian:
+//
+//    "YOSB" version:u32 chain_id[32]
+//    permission_count:u32 { actor:u64 permission:u64 key_type:u8 key[33] }
+//    until the end: trx_count:u32 { trx_len:u32 trx[trx_len]
+//                                   cfd_len:u32 cfd[cfd_len]
+//                                   sig_count:u32 sig[66]... }
+//
+//  with every signature a key type byte followed by a compact signature,
+//  as in ingest_trx.signatures.
+//
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ecdsa.h"
+#include "ingest.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "trx_digest.h"
+
+#define REPLAY_VERSION  1
+#define GEN_ACCOUNTS    64
+#define GEN_MAX_ACTIONS 3
+
+typedef struct {
+  uint8_t chain_id[32];
+  authority_index *authority;
+  ingest_trx *trxs;
+  authority_key *keys;
+  size_t trx_count;
+  size_t sig_count;
+  size_t *blocks;         // index of the first transaction of every block
+  size_t block_count;
+} replay;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-t threads[,threads...]] [-b batch] [-q queue] [-r rounds] [-d] <file>\n", prog);
+  fprintf(stderr, "       %s -g <blocks> <transactions per block> <file>\n", prog);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- generate -----------------------------------------------------------
+
+static void write_uint32(FILE *f, uint32_t value)
+{
+  uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+
+  fwrite(bytes, 1, 4, f);
+}
+
+static uint8_t *put_uint64(uint8_t *p, uint64_t value)
+{
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    *p++ = (uint8_t)(value >> (8 * i));
+  }
+  return p;
+}
+
+static void account_key(int account, uint8_t priv_key[32], authority_key *pub_key)
+{
+  const ecdsa_curve *curve = account & 1 ? &secp256k1 : &secp256r1;
+  uint8_t uncompressed[65];
+  curve_point pub;
+  bignum256 d;
+  int i;
+
+  for (i = 0; i < 32; i++) {
+    priv_key[i] = (uint8_t)(account * 31 + i * 7 + 1);
+  }
+  bn_read_be(priv_key, &d);
+  scalar_multiply(curve, &d, &pub);
+  uncompressed[0] = 0x04;
+  bn_write_be(&pub.x, uncompressed + 1);
+  bn_write_be(&pub.y, uncompressed + 33);
+  pub_key->type = account & 1 ? AUTHORITY_KEY_K1 : AUTHORITY_KEY_R1;
+  ecdsa_compress_pubkey(uncompressed, pub_key->data);
+}
+
+static int generate(const char *path, int blocks, int per_block)
+{
+  uint8_t priv_keys[GEN_ACCOUNTS][32], chain_id[32], trx[64 + GEN_MAX_ACTIONS * 48], digest[32], sig[64];
+  uint8_t *p, by;
+  authority_key pub_keys[GEN_ACCOUNTS];
+  uint32_t expiration = (uint32_t)time(NULL) + 365 * 24 * 3600, seed = 1;
+  int accounts[GEN_MAX_ACTIONS], action_count, b, t, a, i;
+  FILE *f = fopen(path, "wb");
+
+  if (f == NULL) {
+    return 1;
+  }
+  for (i = 0; i < 32; i++) {
+    chain_id[i] = (uint8_t)i;
+  }
+  fwrite("YOSB", 1, 4, f);
+  write_uint32(f, REPLAY_VERSION);
+  fwrite(chain_id, 1, 32, f);
+  write_uint32(f, GEN_ACCOUNTS);
+  for (i = 0; i < GEN_ACCOUNTS; i++) {
+    account_key(i, priv_keys[i], &pub_keys[i]);
+    p = put_uint64(trx, 1000 + i);
+    p = put_uint64(p, 5);
+    *p++ = pub_keys[i].type;
+    memcpy(p, pub_keys[i].data, 33);
+    fwrite(trx, 1, 16 + 1 + 33, f);
+  }
+
+  for (b = 0; b < blocks; b++) {
+    write_uint32(f, per_block);
+    for (t = 0; t < per_block; t++) {
+      // one to three actions of distinct accounts
+      seed = seed * 1103515245 + 12345;
+      action_count = 1 + (seed >> 16) % GEN_MAX_ACTIONS;
+      for (a = 0; a < action_count; a++) {
+        accounts[a] = ((seed >> 8) + a * 17) % GEN_ACCOUNTS;
+      }
+
+      p = trx;
+      memcpy(p, &expiration, 4);                  // little endian hosts only
+      p[4] = (uint8_t)b;                          // ref_block_num
+      p[5] = (uint8_t)(b >> 8);
+      memset(p + 6, 0, 4);                        // ref_block_prefix
+      p += 10;
+      *p++ = 0;                                   // max_net_usage_words
+      *p++ = 0;                                   // max_cpu_usage_ms
+      *p++ = 0;                                   // delay_sec
+      *p++ = 0;                                   // context free actions
+      *p++ = (uint8_t)action_count;
+      for (a = 0; a < action_count; a++) {
+        p = put_uint64(p, 0x5530ea033482a600ull);  // account
+        p = put_uint64(p, 0xcdcd3c2d57000000ull);  // name
+        *p++ = 1;
+        p = put_uint64(p, 1000 + accounts[a]);     // actor
+        p = put_uint64(p, 5);                      // permission
+        *p++ = 8;
+        p = put_uint64(p, (uint64_t)b * per_block + t);
+      }
+      *p++ = 0;                                   // transaction extensions
+
+      write_uint32(f, (uint32_t)(p - trx));
+      fwrite(trx, 1, p - trx, f);
+      write_uint32(f, 0);
+      write_uint32(f, action_count);
+      trx_digest(chain_id, trx, p - trx, NULL, 0, digest);
+      for (a = 0; a < action_count; a++) {
+        if (ecdsa_sign_digest(accounts[a] & 1 ? &secp256k1 : &secp256r1, priv_keys[accounts[a]], digest, sig, &by,
+                              NULL) != 0) {
+          fclose(f);
+          return 1;
+        }
+        fputc(pub_keys[accounts[a]].type, f);
+        fputc(31 + by, f);
+        fwrite(sig, 1, 64, f);
+      }
+    }
+  }
+  return fclose(f) != 0;
+}
+
+// -- load ---------------------------------------------------------------
+
+typedef struct {
+  const uint8_t *p;
+  const uint8_t *end;
+} reader;
+
+static int read_uint32(reader *r, uint32_t *value)
+{
+  if (r->end - r->p < 4) {
+    return 1;
+  }
+  *value = (uint32_t)r->p[0] | (uint32_t)r->p[1] << 8 | (uint32_t)r->p[2] << 16 | (uint32_t)r->p[3] << 24;
+  r->p += 4;
+  return 0;
+}
+
+static int read_uint64(reader *r, uint64_t *value)
+{
+  uint32_t low, high;
+
+  if (read_uint32(r, &low) || read_uint32(r, &high)) {
+    return 1;
+  }
+  *value = (uint64_t)high << 32 | low;
+  return 0;
+}
+
+// points *bytes at the next len bytes
+static int read_bytes(reader *r, size_t len, const uint8_t **bytes)
+{
+  if ((size_t)(r->end - r->p) < len) {
+    return 1;
+  }
+  *bytes = r->p;
+  r->p += len;
+  return 0;
+}
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+  FILE *f = fopen(path, "rb");
+  uint8_t *data = NULL;
+  long size;
+
+  if (f == NULL) {
+    return NULL;
+  }
+  if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+    data = malloc(size);
+    if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+      free(data);
+      data = NULL;
+    }
+    *len = size;
+  }
+  fclose(f);
+  return data;
+}
+
+// Indexes the blocks of data, which must outlive the replay.
+static int load(const uint8_t *data, size_t len, replay *rp)
+{
+  reader r = { data, data + len };
+  authority_key_weight key_weight;
+  authority_level level;
+  const uint8_t *bytes;
+  uint32_t version, count, trx_count, value, i;
+  size_t alloc = 0, block_alloc = 0, sig_alloc = 0, sig_index = 0, n;
+  ingest_trx *trx;
+  void *grown;
+
+  memset(rp, 0, sizeof(replay));
+  if (read_bytes(&r, 4, &bytes) || memcmp(bytes, "YOSB", 4) != 0 || read_uint32(&r, &version) ||
+      version != REPLAY_VERSION || read_bytes(&r, 32, &bytes)) {
+    return 1;
+  }
+  memcpy(rp->chain_id, bytes, 32);
+
+  rp->authority = authority_index_new();
+  if (rp->authority == NULL || read_uint32(&r, &count)) {
+    return 1;
+  }
+  for (i = 0; i < count; i++) {
+    if (read_uint64(&r, &level.actor) || read_uint64(&r, &level.permission) || read_bytes(&r, 34, &bytes)) {
+      return 1;
+    }
+    key_weight.key.type = bytes[0];
+    memcpy(key_weight.key.data, bytes + 1, 33);
+    key_weight.weight = 1;
+    if (authority_set_permission(rp->authority, &level, 0, 1, &key_weight, 1, NULL, 0) != 0) {
+      return 1;
+    }
+  }
+
+  while (r.p != r.end) {
+    if (read_uint32(&r, &trx_count)) {
+      return 1;
+    }
+    if (rp->block_count == block_alloc) {
+      block_alloc = block_alloc * 2 + 64;
+      grown = realloc(rp->blocks, (block_alloc + 1) * sizeof(size_t));
+      if (grown == NULL) {
+        return 1;
+      }
+      rp->blocks = grown;
+    }
+    rp->blocks[rp->block_count++] = rp->trx_count;
+
+    for (i = 0; i < trx_count; i++) {
+      if (rp->trx_count == alloc) {
+        alloc = alloc * 2 + 256;
+        grown = realloc(rp->trxs, alloc * sizeof(ingest_trx));
+        if (grown == NULL) {
+          return 1;
+        }
+        rp->trxs = grown;
+      }
+      trx = &rp->trxs[rp->trx_count];
+      memset(trx, 0, sizeof(ingest_trx));
+      if (read_uint32(&r, &value) || read_bytes(&r, value, &trx->packed_trx)) {
+        return 1;
+      }
+      trx->packed_trx_len = value;
+      if (read_uint32(&r, &value) || read_bytes(&r, value, &trx->packed_cfd)) {
+        return 1;
+      }
+      trx->packed_cfd_len = value;
+      if (value == 0) {
+        trx->packed_cfd = NULL;
+      }
+      if (read_uint32(&r, &value) || value > (size_t)(r.end - r.p) / INGEST_SIGNATURE_SIZE ||
+          read_bytes(&r, (size_t)value * INGEST_SIGNATURE_SIZE, &trx->signatures)) {
+        return 1;
+      }
+      trx->sig_count = value;
+      // the key arrays are assigned once every transaction is known
+      trx->user = (void *)sig_index;
+      sig_index += value;
+      rp->trx_count++;
+    }
+  }
+  if (rp->block_count == 0) {
+    return 1;
+  }
+  rp->blocks[rp->block_count] = rp->trx_count;
+  rp->sig_count = sig_index;
+
+  sig_alloc = rp->sig_count > 0 ? rp->sig_count : 1;
+  rp->keys = malloc(sig_alloc * sizeof(authority_key));
+  if (rp->keys == NULL) {
+    return 1;
+  }
+  for (n = 0; n < rp->trx_count; n++) {
+    rp->trxs[n].keys = rp->keys + (size_t)rp->trxs[n].user;
+    rp->trxs[n].user = NULL;
+  }
+  return 0;
+}
+
+static void free_replay(replay *rp)
+{
+  authority_index_free(rp->authority);
+  free(rp->trxs);
+  free(rp->keys);
+  free(rp->blocks);
+}
+
+// -- replay -------------------------------------------------------------
+
+// called on the authorize threads
+static void count_failure(ingest_trx *trx, void *ctx)
+{
+  if (trx->status != INGEST_OK) {
+    atomic_fetch_add_explicit((atomic_size_t *)ctx, 1, memory_order_relaxed);
+  }
+}
+
+// returns the seconds the replay took, or a negative number on failure
+static double run(replay *rp, ingest_config *config, int ids, atomic_size_t *failures,
+                  ingest_stage_stats stats[INGEST_STAGES])
+{
+  ingest_engine *engine;
+  double start, end;
+  size_t b, i;
+
+  atomic_store(failures, 0);
+  config->done = count_failure;
+  config->done_ctx = failures;
+  config->authority = rp->authority;
+  config->ids = ids ? trx_index_new(rp->trx_count * 2, 16) : NULL;
+  if (ids && config->ids == NULL) {
+    return -1;
+  }
+  memcpy(config->chain_id, rp->chain_id, 32);
+
+  engine = ingest_start(config);
+  if (engine == NULL) {
+    trx_index_free(config->ids);
+    return -1;
+  }
+  start = now();
+  for (b = 0; b < rp->block_count; b++) {
+    for (i = rp->blocks[b]; i < rp->blocks[b + 1]; i++) {
+      ingest_submit(engine, &rp->trxs[i]);
+    }
+    ingest_wait(engine);
+  }
+  end = now();
+  ingest_stats(engine, stats);
+  ingest_stop(engine);
+  trx_index_free(config->ids);
+  return end - start;
+}
+
+// "n" for n threads in every stage or "n,n,n,n" for one count per stage
+static int parse_threads(const char *arg, unsigned int threads[INGEST_STAGES])
+{
+  char *end;
+  long value;
+  int i;
+
+  for (i = 0; i < INGEST_STAGES; i++) {
+    value = strtol(arg, &end, 10);
+    if (end == arg || value < 1 || value > 256) {
+      return 1;
+    }
+    threads[i] = (unsigned int)value;
+    if (i == 0 && *end == '\0') {
+      for (i = 1; i < INGEST_STAGES; i++) {
+        threads[i] = threads[0];
+      }
+      return 0;
+    }
+    if (i + 1 < INGEST_STAGES && *end != ',') {
+      return 1;
+    }
+    arg = end + 1;
+  }
+  return *end != '\0';
+}
+
+int main(int argc, char **argv)
+{
+  static const char *stage_names[INGEST_STAGES] = { "parse", "digest", "recover", "authorize" };
+  const char *prog = argv[0];
+  ingest_config config;
+  ingest_stage_stats stats[INGEST_STAGES], best_stats[INGEST_STAGES];
+  replay rp;
+  uint8_t *data;
+  atomic_size_t failures;
+  size_t len;
+  double seconds, best = -1;
+  int rounds = 3, ids = 0, batch, round, stage, i;
+
+  memset(&config, 0, sizeof(config));
+  atomic_init(&failures, 0);
+  if (argc == 5 && strcmp(argv[1], "-g") == 0) {
+    if (atoi(argv[2]) < 1 || atoi(argv[3]) < 1) {
+      usage(prog);
+      return 1;
+    }
+    if (generate(argv[4], atoi(argv[2]), atoi(argv[3])) != 0) {
+      fprintf(stderr, "%s: cannot write %s\n", prog, argv[4]);
+      return 1;
+    }
+    return 0;
+  }
+  for (i = 1; i < argc - 1 && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc - 1) {
+      if (parse_threads(argv[++i], config.threads) != 0) {
+        usage(prog);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc - 1) {
+      batch = atoi(argv[++i]);
+      for (stage = 0; stage < INGEST_STAGES; stage++) {
+        config.batch[stage] = batch > 0 ? batch : 0;
+      }
+    } else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc - 1) {
+      batch = atoi(argv[++i]);
+      config.queue_capacity = batch > 0 ? batch : 0;
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc - 1) {
+      rounds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0) {
+      ids = 1;
+    } else {
+      usage(prog);
+      return 1;
+    }
+  }
+  if (i != argc - 1 || rounds < 1) {
+    usage(prog);
+    return 1;
+  }
+
+  data = read_file(argv[i], &len);
+  if (data == NULL) {
+    fprintf(stderr, "%s: cannot read %s\n", prog, argv[i]);
+    return 1;
+  }
+  if (load(data, len, &rp) != 0) {
+    fprintf(stderr, "%s: %s is not a block file\n", prog, argv[i]);
+    free_replay(&rp);
+    free(data);
+    return 1;
+  }
+
+  for (round = 0; round < rounds; round++) {
+    seconds = run(&rp, &config, ids, &failures, stats);
+    if (seconds < 0) {
+      fprintf(stderr, "%s: cannot start the pipeline\n", prog);
+      free_replay(&rp);
+      free(data);
+      return 1;
+    }
+    if (best < 0 || seconds < best) {
+      best = seconds;
+      memcpy(best_stats, stats, sizeof(stats));
+    }
+  }
+
+  printf("blocks        %zu\n", rp.block_count);
+  printf("transactions  %zu, %zu failed\n", rp.trx_count, (size_t)atomic_load(&failures));
+  printf("signatures    %zu\n", rp.sig_count);
+  printf("replay        %.3f s, %.0f trx/s, %.0f sigs/s (best of %d)\n", best,
+         rp.trx_count / (best > 0 ? best : 1e-9), rp.sig_count / (best > 0 ? best : 1e-9), rounds);
+  for (i = 0; i < INGEST_STAGES; i++) {
+    printf("%-10s %u threads, %llu items in %llu batches, %.3f s busy, %llu stalls, %llu idle\n", stage_names[i],
+           config.threads[i] != 0 ? config.threads[i] : 1, (unsigned long long)best_stats[i].items,
+           (unsigned long long)best_stats[i].batches, best_stats[i].busy_ns / 1e9,
+           (unsigned long long)best_stats[i].stalls, (unsigned long long)best_stats[i].idle);
+  }
+
+  free_replay(&rp);
+  free(data);
+  return atomic_load(&failures) != 0;
+}
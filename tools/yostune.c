@@ -0,0 +1,101 @@
+//
+//  yostune.c
+//  YosWalletTest
+//
+//  Calibrates the batch sizes and thread counts for this host (see tune.h)
+//  and writes the profile the apps load at startup, e.g.
+//
+//    yostune -o yosemite.tune secp256k1
+//
+//  Without -o the profile is only printed.  With -l the profile at the -o
+//  path is loaded and printed if it is usable, and tuned otherwise.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ecdsa.h"
+#include "secp256k1.h"
+#include "secp256r1.h"
+#include "tune.h"
+
+static const struct {
+  const char *name;
+  const ecdsa_curve *curve;
+} curves[] = {
+  { "secp256r1", &secp256r1 },
+  { "secp256k1", &secp256k1 },
+};
+
+static const ecdsa_curve *find_curve(const char *name)
+{
+  size_t i;
+  for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    if (strcmp(curves[i].name, name) == 0) {
+      return curves[i].curve;
+    }
+  }
+  return NULL;
+}
+
+static void usage(const char *prog)
+{
+  size_t i;
+  fprintf(stderr, "usage: %s [-o profile] [-l] [-t budget ms] <curve>\n", prog);
+  fprintf(stderr, "curves:");
+  for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    fprintf(stderr, " %s", curves[i].name);
+  }
+  fprintf(stderr, "\nbudget: default %d\n", TUNE_BUDGET_MS);
+}
+
+static void print_profile(const tune_profile *profile)
+{
+  printf("cpus             %u\n", profile->cpus);
+  printf("recover_batch    %u\n", profile->recover_batch);
+  printf("recover_threads  %u  (%.0f recoveries/s)\n", profile->recover_threads, profile->recover_rate);
+  printf("sign_batch       %u\n", profile->sign_batch);
+  printf("sign_threads     %u  (%.0f signatures/s)\n", profile->sign_threads, profile->sign_rate);
+}
+
+int main(int argc, char **argv)
+{
+  const char *prog = argv[0], *output = NULL;
+  const ecdsa_curve *curve;
+  tune_profile profile;
+  int budget = 0, load = 0, i;
+  
+  for (i = 1; i < argc - 1 && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc - 1) {
+      output = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc - 1) {
+      budget = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0) {
+      load = 1;
+    } else {
+      usage(prog);
+      return 1;
+    }
+  }
+  if (i != argc - 1 || budget < 0 || (load && output == NULL) || !(curve = find_curve(argv[i]))) {
+    usage(prog);
+    return 1;
+  }
+  
+  if (load) {
+    if (tune_load_or_run(output, curve, budget, &profile) == 0) {
+      printf("loaded %s\n", output);
+    }
+  } else {
+    if (tune_run(curve, budget, &profile) != 0) {
+      fprintf(stderr, "%s: out of memory\n", prog);
+      return 1;
+    }
+    if (output != NULL && tune_save(output, &profile) != 0) {
+      fprintf(stderr, "%s: cannot write %s\n", prog, output);
+      return 1;
+    }
+  }
+  print_profile(&profile);
+  return 0;
+}